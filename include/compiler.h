@@ -0,0 +1,73 @@
+﻿#pragma once
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include "error_handing.h"
+#include "frame_layout.h"
+#include "lexical_analyser.h"
+#include "midcode_image.h"
+#include "parse_analyser.h"
+#include "midcode.h"
+#include "optimizer.h"
+#include "table.h"
+
+// The front end (Analyze) or a saved MidcodeImage (Load) supplies the midcode and tables the
+// backends run on; Save writes them out so a later run can Load instead of parsing again.
+class Compiler {
+private:
+    std::string testfile_;
+    std::string midcode_file_;          // empty: no text dump of the midcode
+    ErrorHanding *error_handing_;
+    SourceBuffer *source_;              // lexemes view this buffer, so it lives as long as the compiler
+    Interner *interner_;
+    int lex_job_count_;                 // 0: parallel lexing only for large sources
+    int parse_job_count_;               // 0: parallel function parsing only for large sources
+    std::string syntax_file_;           // empty: no syntax dump, so no syntax tree is built
+    ParseAnalyser *parse_analyser_;
+    MidcodeImage *midcode_image_;       // set by Load
+    std::map<std::string, FrameLayout> frame_layout_map_;     // computed once the program is known to be valid
+    StringTable *string_table_;
+    CheckTable *check_table_;
+    std::map<std::string, SymbolTable *> symbol_table_map_;
+    std::list<Midcode *> midcode_list_;
+    std::vector<Optimizer *> optimizer_list_;   // each owns the midcode of one Optimize() result
+
+public:
+    Compiler(const std::string &testfile, const std::string &midcode_file, const std::string &error_file);
+
+    ~Compiler();
+
+    Compiler(const Compiler &) = delete;
+
+    Compiler &operator=(const Compiler &) = delete;
+
+    void set_lex_job_count(int lex_job_count);
+
+    void set_parse_job_count(int parse_job_count);
+
+    void set_syntax_file(const std::string &syntax_file);
+
+    // reads the source; false if it cannot be opened
+    bool Open();
+
+    // after Open: false if the program has errors, which go to the error file
+    bool Analyze();
+
+    // instead of Analyze: false if image_file is not a midcode image of this version
+    bool Load(const std::string &image_file);
+
+    bool Save(const std::string &image_file);
+
+    // the list stays valid as long as the compiler
+    std::list<Midcode *> Optimize(int optimize_level);
+
+    void GenerateMips(const std::string &mips_file, int optimize_level);
+
+    StringTable *string_table();
+
+    std::map<std::string, SymbolTable *> symbol_table_map();
+
+    std::map<std::string, FrameLayout> frame_layout_map();
+};
@@ -17,6 +17,12 @@ const char MISSING_WHILE_IN_DO_WHILE = 'n';
 const char DEFINE_CONST_OTHERS = 'o';
 const char NO_ERROR = 'p';
 
+// Which pass found an error; only the lexer reports ILLEGAL_SYMBOL_OR_LEXICAL_INCONFORMITY.
+enum class ErrorOrigin {
+    LEX,
+    PARSE
+};
+
 class Error {
 private:
     int line_number_;
@@ -35,5 +41,7 @@ public:
     int line_number() const;
 
     char error_type() const;
+
+    ErrorOrigin origin() const;
 };
 
@@ -9,9 +9,11 @@ private:
 	std::ofstream error_file_;
     std::list<Error> error_list_;
 public:
+	ErrorHanding();
 	explicit ErrorHanding(const std::string& file_name);
 	void AddError(Error error);
 	void AddError(int line_number, char error_type);
+	void Append(const ErrorHanding &other);
 	void PrintError();
 	void FileClose();
 	bool IsError();
@@ -0,0 +1,51 @@
+﻿#pragma once
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include "midcode.h"
+#include "table.h"
+
+#define LOOP_WEIGHT             8       // a use inside a loop counts this many times per loop level
+#define LOOP_WEIGHT_MAX_DEPTH   6
+
+// Where the variables of one function -- or the globals, under "global" -- live, in bytes from
+// the frame base, with the function's temporaries after them. Every variable takes whole words,
+// so alignment leaves the order free: scalars come first, most used first, then the arrays, also
+// by use, so the hot scalars sit together and well inside the 16-bit lw/sw offset range. A use
+// inside a loop weighs LOOP_WEIGHT times more per level. The layout is computed once, after
+// parsing; the offsets go to the symbols, which both backends read.
+class FrameLayout {
+private:
+    int variable_size_;     // bytes of variables
+    int temp_count_;        // temporaries are #1 .. #temp_count
+
+    static bool IsFunctionDeclare(MidcodeInstr instr);
+
+    static bool IsJump(MidcodeInstr instr);
+
+    // weight_list is indexed by Symbol::index()
+    static void CountUse(const std::vector<Midcode *> &body, CheckTable *check_table,
+                         std::vector<long long> &weight_list);
+
+    void Build(const SymbolTable *symbol_table, const std::vector<long long> &weight_list, int temp_count);
+
+public:
+    FrameLayout();
+
+    // a layout computed earlier, e.g. read back from a MidcodeImage
+    FrameLayout(int variable_size, int temp_count);
+
+    // temporary #n is at variable_size + 4 * n
+    int variable_size() const;
+
+    // variables and temporaries; a callee's frame starts here
+    int frame_size() const;
+
+    int temp_count() const;
+
+    static std::map<std::string, FrameLayout> LayoutProgram(const std::list<Midcode *> &midcode_list,
+                                                            CheckTable *check_table,
+                                                            const std::map<std::string, SymbolTable *> &symbol_table_map);
+};
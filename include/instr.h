@@ -86,16 +86,21 @@ enum class MidcodeInstr {
     CONST_CHAR,
 
     VAR_INT,
-    VAR_CHAR,
+    VAR_CHAR,       // the last: MidcodeImage::Load rejects anything past it
 };
 
 enum class OperaMember {
     REG_OP_NUMBER,
     REG_OP_REG,
     NUMBER_OP_REG,
-    NUMBER_OP_NUMBER
+    NUMBER_OP_NUMBER    // the last: MidcodeImage::Load rejects anything past it
 };
 
 namespace midcodeinstr {
     MidcodeInstr GetOperatorInstr(std::string op);
+
+    std::string GetOperatorString(MidcodeInstr instr);
+
+    // folds value1 op value2 with 32-bit wrap-around; division by 0 or -1 is left to run time
+    bool Calculate(MidcodeInstr instr, int value1, int value2, int &result);
 }
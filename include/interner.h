@@ -0,0 +1,32 @@
+﻿#pragma once
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include "string_ref.h"
+
+#define NO_IDENTIFIER   (-1)
+
+// Gives every distinct identifier spelling a dense id, assigned in first-seen order. The
+// spelling is stored once; a deque keeps it at a fixed address, so Name() references and
+// the map's StringRef keys stay valid as more names arrive.
+class Interner {
+private:
+    std::deque<std::string> name_list_;
+    std::unordered_map<StringRef, int, StringRefHash> id_map_;
+
+public:
+    Interner();
+
+    Interner(const Interner &) = delete;
+
+    Interner &operator=(const Interner &) = delete;
+
+    int Intern(const StringRef &name);
+
+    int Find(const StringRef &name) const;
+
+    const std::string &Name(int id) const;
+
+    int size() const;
+};
@@ -1,70 +1,68 @@
 ﻿#pragma once
 
-#include <fstream>
-#include <list>
-#include <map>
+#include <vector>
 #include <string>
 #include "error_handing.h"
+#include "interner.h"
+#include "source_buffer.h"
+#include "string_ref.h"
 
 
-const std::string IDENFR = "IDENFR";
-const std::string INTCON = "INTCON";
-const std::string CHARCON = "CHARCON";
-const std::string STRCON = "STRCON";
-const std::string CONSTTK = "CONSTTK";
-const std::string INTTK = "INTTK";
-const std::string CHARTK = "CHARTK";
-const std::string VOIDTK = "VOIDTK";
-const std::string MAINTK = "MAINTK";
-const std::string IFTK = "IFTK";
-const std::string ELSETK = "ELSETK";
-const std::string DOTK = "DOTK";
-const std::string WHILETK = "WHILETK";
-const std::string FORTK = "FORTK";
-const std::string SCANFTK = "SCANFTK";
-const std::string PRINTFTK = "PRINTFTK";
-const std::string RETURNTK = "RETURNTK";
-const std::string PLUS = "PLUS";
-const std::string MINU = "MINU";
-const std::string MULT = "MULT";
-const std::string DIV = "DIV";
-const std::string LSS = "LSS";
-const std::string LEQ = "LEQ";
-const std::string GRE = "GRE";
-const std::string GEQ = "GEQ";
-const std::string EQL = "EQL";
-const std::string NEQ = "NEQ";
-const std::string ASSIGN = "ASSIGN";
-const std::string SEMICN = "SEMICN";
-const std::string COMMA = "COMMA";
-const std::string LPARENT = "LPARENT";
-const std::string RPARENT = "RPARENT";
-const std::string LBRACK = "LBRACK";
-const std::string RBRACK = "RBRACK";
-const std::string LBRACE = "LBRACE";
-const std::string RBRACE = "RBRACE";
+enum class TokenKind : unsigned char {
+    IDENFR, INTCON, CHARCON, STRCON,
 
+    CONSTTK, INTTK, CHARTK, VOIDTK, MAINTK,
+    IFTK, ELSETK, DOTK, WHILETK, FORTK,
+    SCANFTK, PRINTFTK, RETURNTK,
+
+    PLUS, MINU, MULT, DIV,
+    LSS, LEQ, GRE, GEQ, EQL, NEQ,
+    ASSIGN, SEMICN, COMMA,
+    LPARENT, RPARENT, LBRACK, RBRACK, LBRACE, RBRACE,
+
+    END         // past the last token; never produced by the lexer
+};
+
+// the spelling used in the token dump, e.g. "IDENFR"
+const char *TokenName(TokenKind kind);
+
+// value points into the lexer's SourceBuffer (or at a static spelling), so it is only
+// valid while that buffer is alive.
 struct Lexeme {
-    std::string identifier;
-    std::string value;
+    StringRef value;
+    unsigned offset;        // byte offset of the token in the source; SourceBuffer::Line() maps it
+    int symbol_id;          // interned id of an IDENFR, NO_IDENTIFIER for every other kind
+    TokenKind kind;
     bool is_error;
-    int line_number;
 
     Lexeme() {
+        offset = 0;
+        symbol_id = NO_IDENTIFIER;
+        kind = TokenKind::IDENFR;
+        is_error = false;
+    }
+
+    explicit Lexeme(TokenKind kind) {
+        offset = 0;
+        symbol_id = NO_IDENTIFIER;
+        this->kind = kind;
         is_error = false;
-        line_number = 0;
     }
 };
 
 class LexicalAnalyser {
 private:
-    std::ifstream testfile_;
-    struct Lexeme *temp_lexeme_;
-    std::list<struct Lexeme> lexeme_list_;
+    SourceBuffer file_source_;
+    const SourceBuffer *source_;
+    const char *cursor_;
+    const char *end_;
+    const char *limit_;         // no token may start at or after this
+    const char *token_begin_;
+    const char *token_end_;
+    std::vector<struct Lexeme> lexeme_list_;
+    Lexeme *output_;        // where AddList() puts the token Next() is producing
     ErrorHanding *error_handing_;
-    int line_number_;
-    std::map<std::string, std::string> key_map_;
-    std::map<std::string, std::string> opera_map_;
+    Interner *interner_;
 
     static bool IsUnder(char c);
 
@@ -74,17 +72,15 @@ private:
 
     static bool IsDoubleQuote(char c);
 
-    bool IsOpera(char c);
+    static bool IsOpera(char c);
 
     static bool IsCharLetter(char c);
 
     static bool IsStringLetter(char c);
 
-    bool CheckKey(struct Lexeme *temp);
-
-    bool CheckSymbol(struct Lexeme *temp);
+    static bool CheckKey(struct Lexeme &temp);
 
-    void MapInitial();
+    int LineNumber() const;
 
     void GetChar(char &c);
 
@@ -94,7 +90,7 @@ private:
 
     void AddList(struct Lexeme temp);
 
-    void AddList(struct Lexeme temp, const std::string &identifier);
+    void AddList(struct Lexeme temp, TokenKind kind);
 
     bool AnalyzeKey(char &c);
 
@@ -105,9 +101,20 @@ private:
     bool AnalyzeDigit(char &c);
 
 public:
-    LexicalAnalyser(const std::string &file_name, ErrorHanding *error_handing);
+    LexicalAnalyser(const std::string &file_name, Interner *interner, ErrorHanding *error_handing);
+
+    LexicalAnalyser(const SourceBuffer *source, Interner *interner, ErrorHanding *error_handing);
+
+    LexicalAnalyser(const SourceBuffer *source, size_t begin, size_t limit, Interner *interner,
+                    ErrorHanding *error_handing);
+
+    bool Next(Lexeme &lexeme);
+
+    unsigned offset() const;
+
+    size_t token_end() const;
 
-    std::list<struct Lexeme> *Analyze();
+    std::vector<struct Lexeme> *Analyze();
 
     void FileClose();
 };
@@ -6,6 +6,8 @@
 #include "symbol.h"
 #include "instr.h"
 
+class CheckTable;
+
 class Midcode {
 private:
     MidcodeInstr instr_;
@@ -22,6 +24,13 @@ private:
     int temp2_;
     int temp_result_;
 
+    bool is_bound_;
+    Symbol *symbol1_;           // reg1_, or label_ for an instruction keeping its operand there
+    Symbol *symbol2_;           // reg2_
+    Symbol *symbol_result_;     // reg_result_
+
+    friend class MidcodeImage;
+
 public:
     Midcode(MidcodeInstr instr);
 
@@ -51,6 +60,10 @@ public:
 
     void Init();
 
+    void RebaseString(int string_base);
+
+    void BindSymbol(CheckTable *check_table);
+
     MidcodeInstr instr();
 
     OperaMember opera_member();
@@ -67,6 +80,12 @@ public:
 
     int temp_result();
 
+    Symbol *symbol1();
+
+    Symbol *symbol2();
+
+    Symbol *symbol_result();
+
     std::string GetTempReg1();
 
     std::string GetTempReg2();
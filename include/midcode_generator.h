@@ -25,6 +25,8 @@ private:
     std::ofstream midcode_;
     std::list<Midcode *> midcode_list_;
 
+    void WriteMidcode(Midcode *midcode);
+
     void PrintBez(int label, const std::string &expression);
 
     void PrintBnz(int label, const std::string &expression);
@@ -105,14 +107,7 @@ public:
 
     void PrintAssignReturn(int temp_reg_count);
 
-    void PrintRegOpReg(int result_reg, int op_reg1, int op_reg2, const std::string &op);
-
-    void PrintRegOpNumber(int result_reg, int op_reg, const std::string &number, const std::string &op);
-
-    void PrintNumberOpReg(int result_reg, const std::string &number, int op_reg, const std::string &op);
-
-    void
-    PrintNumberOpNumber(int result_reg, const std::string &number1, const std::string &number2, const std::string &op);
+    void PrintOperate(int result_reg, const std::string &value1, const std::string &value2, const std::string &op);
 
     void PrintNeg(int result_reg, const std::string &number);
 };
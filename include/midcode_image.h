@@ -0,0 +1,160 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include "frame_layout.h"
+#include "interner.h"
+#include "midcode.h"
+#include "symbol.h"
+#include "table.h"
+
+#define MIDCODE_IMAGE_MAGIC     0x4344494du     // "MIDC" read as a little-endian word
+#define MIDCODE_IMAGE_VERSION   2               // bump whenever a record below changes
+
+// The front end's result in one binary file: the identifiers, the printf strings, the symbols
+// with their frame offsets, and the midcode of the globals and of every function, so the
+// backends can run again without lexing or parsing. The file is a header followed by arrays of
+// fixed-size records and a character blob that every spelling points into:
+//
+//     ImageHeader
+//     TextRecord[text_count]          identifiers in Interner id order, then operand spellings
+//     uint32_t[string_count]          printf string i is text string_list[i]
+//     UnitRecord[unit_count]          "global" first, then the functions in program order
+//     uint32_t[unit_symbol_count]     a unit's symbols, in declaration order
+//     SymbolRecord[symbol_count]      in Symbol::index() order
+//     uint8_t[parameter_count]        parameter types, padded to 4 bytes
+//     MidcodeRecord[midcode_count]    unit after unit
+//     char[blob_size]
+//
+// Load maps the file and copies the records out of the mapping; nothing is parsed. Operands
+// that are numbers, characters or temporaries are stored as such and every other spelling as a
+// text, so the midcode comes back exactly as it was written. The records are in the byte order
+// of the machine that wrote them. The header holds a checksum of everything after it, and Load
+// also checks every unit against the shape the backends expect, so a damaged image is refused
+// rather than crashing them.
+class MidcodeImage {
+private:
+    enum class OperandKind : uint8_t {
+        NONE,           // ""
+        INT,            // 5, -3
+        CHAR,           // 'c'
+        TEMP,           // #4
+        TEXT            // a name, or any other spelling; the last kind
+    };
+
+    struct ImageHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t identifier_count;
+        uint32_t text_count;
+        uint32_t string_count;
+        uint32_t unit_count;
+        uint32_t unit_symbol_count;
+        uint32_t symbol_count;
+        uint32_t parameter_count;
+        uint32_t midcode_count;
+        uint32_t blob_size;
+        uint32_t checksum;          // of the rest of the file
+    };
+
+    struct TextRecord {
+        uint32_t offset;            // in the blob
+        uint32_t size;
+    };
+
+    struct UnitRecord {
+        uint32_t name;              // text
+        uint32_t symbol_begin;      // in the unit symbol list
+        uint32_t symbol_count;
+        uint32_t midcode_begin;
+        uint32_t midcode_count;
+        int32_t variable_size;
+        int32_t temp_count;
+    };
+
+    struct SymbolRecord {
+        uint32_t id;
+        uint8_t kind;
+        uint8_t type;
+        uint8_t level;
+        uint8_t has_const_value;
+        int32_t const_value;
+        int32_t array_length;
+        int32_t offset;
+        uint32_t parameter_begin;
+        uint32_t parameter_count;
+    };
+
+    // the string operands are label, reg1, reg2 and reg_result, in that order
+    struct MidcodeRecord {
+        uint8_t instr;
+        uint8_t opera_member;
+        uint8_t operand_kind[4];    // OperandKind
+        uint16_t padding;
+        int32_t count;
+        int32_t temp1;
+        int32_t temp2;
+        int32_t temp_result;
+        int32_t operand[4];         // the number, character code, temporary or text
+    };
+
+    SymbolArena *symbol_arena_;
+    std::vector<SymbolTable *> symbol_table_list_;
+    StringTable *string_table_;
+    CheckTable *check_table_;
+    std::map<std::string, SymbolTable *> symbol_table_map_;
+    std::map<std::string, FrameLayout> frame_layout_map_;
+    std::list<Midcode *> midcode_list_;
+
+    static bool ParseInteger(const std::string &spelling, int &value);
+
+    static void EncodeOperand(const std::string &spelling, std::map<std::string, uint32_t> &text_map,
+                              std::vector<std::string> &text_list, MidcodeRecord &record, int k);
+
+    static std::string DecodeOperand(const MidcodeRecord &record, int k, const std::vector<std::string> &text_list);
+
+    // the bits of a scope_list entry: where an identifier is declared
+    enum Scope : uint8_t {
+        GLOBAL_SCOPE = 1,
+        LOCAL_SCOPE = 2
+    };
+
+    static bool IsIdentifier(const std::string &text);
+
+    static bool IsTemporaryValid(int temp, const UnitRecord &unit);
+
+    static bool IsUnitValid(const UnitRecord &unit, bool is_global,
+                            const std::vector<MidcodeRecord> &midcode_record_list,
+                            const std::vector<uint8_t> &scope_list, uint32_t string_count);
+
+public:
+    MidcodeImage();
+
+    ~MidcodeImage();
+
+    MidcodeImage(const MidcodeImage &) = delete;
+
+    MidcodeImage &operator=(const MidcodeImage &) = delete;
+
+    static bool Write(const std::string &file_name, const Interner *interner, StringTable *string_table,
+                      const std::map<std::string, SymbolTable *> &symbol_table_map,
+                      const std::map<std::string, FrameLayout> &frame_layout_map,
+                      const std::list<Midcode *> &midcode_list);
+
+    // false for a file that is missing, truncated, of another format or version, damaged, or
+    // holding a record out of range or midcode the backends cannot run; the identifiers are interned into interner, which must be empty
+    bool Load(const std::string &file_name, Interner *interner);
+
+    StringTable *string_table();
+
+    CheckTable *check_table();
+
+    const std::map<std::string, SymbolTable *> &symbol_table_map() const;
+
+    const std::map<std::string, FrameLayout> &frame_layout_map() const;
+
+    const std::list<Midcode *> &midcode_list() const;
+};
@@ -0,0 +1,124 @@
+﻿#pragma once
+
+#include <istream>
+#include <ostream>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include "frame_layout.h"
+#include "midcode.h"
+#include "table.h"
+
+#define MAX_CALL_DEPTH    100000
+
+class MidcodeInterpreter {
+private:
+    enum class OperandType {
+        NONE,
+        IMMEDIATE,
+        GLOBAL,
+        LOCAL
+    };
+
+    struct Operand {
+        OperandType type;
+        int value;
+    };
+
+    struct Slot {
+        Operand operand;
+        int length;
+    };
+
+    struct Instruction {
+        MidcodeInstr instr;
+        Operand result;
+        Operand operand1;
+        Operand operand2;
+        int target;
+    };
+
+    struct Function {
+        std::string name;
+        int entry;
+        int frame_size;
+        std::vector<int> parameter_slot;
+    };
+
+    struct Frame {
+        int function;
+        int return_pc;
+        int base;
+    };
+
+    StringTable *string_table_;
+    std::map<std::string, SymbolTable *> symbol_table_map_;
+    std::map<std::string, FrameLayout> frame_layout_map_;
+    std::list<Midcode *> midcode_list_;
+
+    std::vector<Instruction> code_;
+    std::vector<Function> function_list_;
+    std::map<std::string, int> function_index_map_;
+    std::vector<std::string> string_list_;
+
+    std::map<std::string, Slot> global_map_;
+    std::map<std::string, Slot> local_map_;
+    std::map<int, int> label_map_;
+    std::vector<std::pair<int, std::string>> call_list_;
+
+    std::vector<int> global_;
+    std::vector<int> stack_;
+    std::vector<int> parameter_stack_;
+    std::vector<Frame> frame_list_;
+    int base_;
+    int return_value_;
+
+    long long step_limit_;
+    long long step_count_;
+    std::string error_;
+
+    static bool IsInteger(const std::string &str);
+
+    static bool IsChar(const std::string &str);
+
+    static bool IsTemporary(const std::string &str);
+
+    static std::string UnescapeString(const std::string &str);
+
+    int LayoutTable(const std::string &name, std::map<std::string, Slot> &slot_map, OperandType type);
+
+    Slot DecodeName(const std::string &name);
+
+    Operand DecodeOperand(const std::string &value, int &frame_size);
+
+    void DecodeFunction(std::list<Midcode *>::iterator &iter);
+
+    void Decode();
+
+    int &Access(const Operand &operand);
+
+    int Read(const Operand &operand);
+
+    int *Element(const Operand &array, int length, int index);
+
+    bool Trap(const std::string &error);
+
+    bool Call(int function, int return_pc, int &pc);
+
+    bool Execute(std::istream &input, std::ostream &output);
+
+public:
+    MidcodeInterpreter(StringTable *string_table,
+                       std::map<std::string, SymbolTable *> symbol_table_map,
+                       std::map<std::string, FrameLayout> frame_layout_map,
+                       std::list<Midcode *> midcode_list);
+
+    void set_step_limit(long long step_limit);
+
+    bool Run(std::istream &input, std::ostream &output);
+
+    long long step_count() const;
+
+    std::string error() const;
+};
@@ -7,6 +7,7 @@
 #include <list>
 #include "midcode.h"
 #include "table.h"
+#include "frame_layout.h"
 #include "objcode.h"
 
 #define RS                Reg::t0
@@ -29,21 +30,18 @@ private:
     CheckTable *check_table_;
     StringTable *string_table_;
     std::map<std::string, SymbolTable *> symbol_table_map_;
+    std::map<std::string, FrameLayout> frame_layout_map_;
     std::list<Midcode *> midcode_list_;
 
-    std::map<std::string, int> temporary_offset_map_;
-    std::map<std::string, int> function_offset_map_;
-
-    int temp_count_;
-    int temp_offset_;
-    int dm_offset_;
+    std::string function_name_;
+    Symbol *function_;
+    int optimize_level_;
+    const FrameLayout *frame_layout_;   // of the current function
 
     void LoadTable(int level, const std::string &name);
 
     void InitConstString();
 
-    void InitVariable(const std::string &function);
-
     void InitData();
 
     void PrintText();
@@ -52,9 +50,9 @@ private:
 
     void InitText();
 
-    void SaveVariable(const std::string &name, Reg reg);
+    void SaveVariable(Symbol *symbol, Reg reg);
 
-    void LoadVariable(const std::string &name, Reg reg);
+    void LoadVariable(Symbol *symbol, Reg reg);
 
     static bool IsInteger(const std::string &str);
 
@@ -62,17 +60,15 @@ private:
 
     static bool IsTemporary(const std::string &str);
 
+    int GetTemporaryOffset(const std::string &name);
+
     void SaveTemporary(const std::string &name, Reg reg);
 
     void LoadTemporary(const std::string &name, Reg reg);
 
-    void LoadValue(const std::string &value, Reg reg);
-
-    bool IsConstVariable(const std::string &name);
+    void LoadValue(const std::string &value, Symbol *symbol, Reg reg);
 
-    int GetConstVariable(const std::string &name);
-
-    void GenerateScanf(const std::string &variable_name, int type);
+    void GenerateScanf(Symbol *variable, int type);
 
     void GeneratePrintfIntChar(Midcode *midcode, int type);
 
@@ -80,50 +76,53 @@ private:
 
     void GeneratePrintfEnd();
 
+    std::string GetLabel(Midcode *midcode);
+
     void GenerateLabel(const std::string &label);
 
     void GenerateJump(const std::string &label);
 
-    void GenerateAssign(const std::string &result, const std::string &value);
+    void GenerateAssign(Midcode *midcode);
 
     void GenerateAssignReturn(const std::string &temp);
 
-    void SetArrayIndex(const std::string &index, Reg base, int &offset, bool &is_use_temp);
+    void SetArrayIndex(const std::string &index, Symbol *symbol, Reg base, int &offset, bool &is_use_temp);
 
-    void GenerateAssignArray(const std::string &array, const std::string &index, const std::string &value);
+    void GenerateAssignArray(Midcode *midcode);
 
-    void GenerateLoadArray(const std::string &temp, const std::string &array, const std::string &index);
+    void GenerateLoadArray(Midcode *midcode);
 
-    void SetOperand(const std::string &value, Reg reg, bool &is_immediate, int &immediate);
+    void SetOperand(const std::string &value, Symbol *symbol, Reg reg, bool &is_immediate, int &immediate);
 
-    void DealNumberOpNumber(const std::string &value_1, const std::string &value_2,
+    void DealNumberOpNumber(const std::string &value_1, Symbol *symbol_1,
+                            const std::string &value_2, Symbol *symbol_2,
                             int &immediate_1, bool &is_immediate_1,
                             int &immediate_2, bool &is_immediate_2);
 
-    void DealNumberOpReg(const std::string &value_1, const std::string &temp_2,
+    void DealNumberOpReg(const std::string &value_1, Symbol *symbol_1, const std::string &temp_2,
                          int &immediate_1, bool &is_immediate_1);
 
-    void DealRegOpNumber(const std::string &temp_1, const std::string &value_2,
+    void DealRegOpNumber(const std::string &temp_1, const std::string &value_2, Symbol *symbol_2,
                          int &immediate_2, bool &is_immediate_2);
 
     void DealRegOpReg(const std::string &temp_1, const std::string &temp_2);
 
-    void GenerateOperate(Midcode *midcode, const std::string &result,
+    void GenerateOperate(Midcode *midcode, const std::string &result, Symbol *result_symbol,
                          MidcodeInstr op, OperaMember member_type);
 
     void GenerateOperate(std::list<Midcode *>::iterator &iter, Midcode *midcode);
 
     void GenerateStep(std::list<Midcode *>::iterator &iter, Midcode *&midcode);
 
-    void GenerateNeg(const std::string &temp_result, const std::string &value);
+    void GenerateNeg(const std::string &temp_result, const std::string &value, Symbol *symbol);
 
-    void SetJudgeReg(const std::string &value, Reg reg);
+    void SetJudgeReg(const std::string &value, Symbol *symbol, Reg reg);
 
     void GenerateJudge(Midcode *midcode, MidcodeInstr judge);
 
-    void GeneratePush(const std::string &value);
+    void GeneratePush(const std::string &value, Symbol *symbol);
 
-    void GenerateCall(const std::string &prev_name, const std::string &call_name);
+    void GenerateCall(Symbol *function);
 
     void GenerateSave();
 
@@ -131,21 +130,25 @@ private:
 
     void GenerateReturn(Midcode *midcode, bool is_return_value);
 
-    void GenerateParameter(const std::string &function_name, const std::string &value, int count);
+    void GenerateParameter(Symbol *parameter, int count);
 
-    void GenerateBody(const std::string &function_name, std::list<Midcode *>::iterator &iter);
+    void GenerateBody(std::list<Midcode *>::iterator &iter);
 
     void GenerateFunction(const std::string &function_name, std::list<Midcode *>::iterator &iter);
 
     void Generate();
 
 public:
-    MipsGenerator(const std::string &outputFileName, int temp_count,
+    MipsGenerator(const std::string &outputFileName,
                   StringTable *stringTable, CheckTable *check_table,
-                  std::map<std::string, SymbolTable *> symbolTableMap, std::list<Midcode *> midcode_list);
+                  std::map<std::string, SymbolTable *> symbolTableMap,
+                  std::map<std::string, FrameLayout> frame_layout_map, std::list<Midcode *> midcode_list,
+                  int optimize_level);
 
     void GenerateMips();
 
+    int instruction_count() const;
+
     void FileClose();
 };
 
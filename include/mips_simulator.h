@@ -0,0 +1,83 @@
+﻿#pragma once
+
+#include <istream>
+#include <ostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "instr.h"
+#include "reg.h"
+
+#define DATA_BASE       0x10010000
+#define DATA_SIZE       (16 << 20)
+
+class MipsSimulator {
+private:
+    enum class Opcode {
+        add, addi, sub, mul, muli,
+        div, divi, mflo,
+        sll,
+        lw, sw,
+        bgt, bge, blt, ble, beq, bne,
+        jal, jr, j,
+        la, li, move,
+        syscall, nop
+    };
+
+    struct Instruction {
+        Opcode opcode;
+        int rd;
+        int rs;
+        int rt;
+        int immediate;
+        std::string label;
+    };
+
+    std::vector<Instruction> text_;
+    std::vector<unsigned char> data_;
+    std::map<std::string, int> text_label_map_;
+    std::map<std::string, int> data_label_map_;
+    int data_cursor_;
+
+    int reg_[32];
+    int lo_;
+
+    long long step_limit_;
+    long long step_count_;
+    std::string error_;
+
+    static std::vector<std::string> Split(const std::string &line);
+
+    static int ParseReg(const std::string &str);
+
+    static std::string ParseString(const std::string &str);
+
+    bool ParseData(const std::string &line);
+
+    bool ParseText(const std::vector<std::string> &token);
+
+    bool ParseMemory(const std::string &str, Instruction &instruction);
+
+    bool Link();
+
+    bool Trap(const std::string &error);
+
+    bool LoadWord(int address, int &value);
+
+    bool StoreWord(int address, int value);
+
+    bool Syscall(std::istream &input, std::ostream &output, bool &is_exit);
+
+public:
+    MipsSimulator();
+
+    bool Load(std::istream &mips);
+
+    void set_step_limit(long long step_limit);
+
+    bool Run(std::istream &input, std::ostream &output);
+
+    long long step_count() const;
+
+    std::string error() const;
+};
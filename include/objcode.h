@@ -9,6 +9,7 @@
 class Objcode {
 private:
     std::ofstream mips_;
+    int instruction_count_;
 
 public:
     explicit Objcode(const std::string& mipsFile);
@@ -37,6 +38,8 @@ public:
 
     void Output(MipsInstr instr, Reg t0, Reg t1, const std::string& label);
 
+    int instruction_count() const;
+
     void FileClose();
 };
 
@@ -0,0 +1,60 @@
+﻿#pragma once
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include "midcode.h"
+
+// Rewrites a copy of the midcode list. Midcodes are never modified in place: a folded one is
+// replaced by a new midcode, which the optimizer owns and frees when it is destroyed, so its
+// result is valid as long as the optimizer is. The midcodes it was given stay with their owner.
+class Optimizer {
+private:
+    std::list<Midcode *> midcode_list_;
+    std::vector<Midcode *> created_list_;   // every midcode made here, kept or removed since
+
+    static bool IsInteger(const std::string &str);
+
+    static bool IsChar(const std::string &str);
+
+    static bool IsTemporary(const std::string &str);
+
+    static bool IsFunctionDeclare(Midcode *midcode);
+
+    static int GetValue(const std::string &str);
+
+    static void GetOperand(Midcode *midcode, std::string &value1, std::string &value2);
+
+    static std::vector<std::string> GetUseList(Midcode *midcode);
+
+    static std::string GetDefine(Midcode *midcode);
+
+    static std::string Replace(const std::string &value, const std::map<std::string, std::string> &constant_map);
+
+    static Midcode *BuildOperate(MidcodeInstr instr, int temp_result,
+                                 const std::string &value1, const std::string &value2);
+
+    Midcode *FoldMidcode(Midcode *midcode, std::map<std::string, std::string> &constant_map);
+
+    void FoldConstant();
+
+    void RemoveDeadTemporary(std::list<Midcode *>::iterator begin, std::list<Midcode *>::iterator end);
+
+    void RemoveDeadTemporary();
+
+    void RemoveRedundantJump();
+
+public:
+    explicit Optimizer(std::list<Midcode *> midcode_list);
+
+    ~Optimizer();
+
+    Optimizer(const Optimizer &) = delete;
+
+    Optimizer &operator=(const Optimizer &) = delete;
+
+    void Optimize(int optimize_level);
+
+    std::list<Midcode *> midcode_list();
+};
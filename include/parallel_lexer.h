@@ -0,0 +1,30 @@
+﻿#pragma once
+
+#include <vector>
+#include "error_handing.h"
+#include "interner.h"
+#include "lexical_analyser.h"
+#include "source_buffer.h"
+
+#define PARALLEL_LEX_SIZE       (1 << 20)       // smaller sources are not worth the threads
+#define PARALLEL_LEX_CHUNK      (1 << 18)       // least bytes per chunk
+
+// Lexes a large source on several threads. The text is cut just after a newline near every
+// chunk_size bytes, and each chunk is lexed with its own Interner and ErrorHanding. The
+// results are then stitched in source order. Token offsets are absolute, so only the
+// identifier ids need remapping. A boundary is unsafe only if a token crossed it, which
+// takes a malformed string or char literal. In that case the whole source is lexed
+// serially instead.
+class ParallelLexer {
+private:
+    const SourceBuffer *source_;
+    Interner *interner_;
+    ErrorHanding *error_handing_;
+    int job_count_;
+    std::vector<struct Lexeme> lexeme_list_;
+
+public:
+    ParallelLexer(const SourceBuffer *source, Interner *interner, ErrorHanding *error_handing, int job_count);
+
+    std::vector<struct Lexeme> *Analyze();
+};
@@ -4,66 +4,77 @@
 #include <list>
 #include <map>
 #include <string>
+#include <vector>
 #include "lexical_analyser.h"
+#include "token_stream.h"
 #include "syntax_node.h"
 #include "table.h"
 #include "midcode_generator.h"
 #include "error_handing.h"
 
-const std::string STRING = "<字符串>";
-const std::string PROGRAM = "<程序>";
-const std::string CONST_DECLARE = "<常量说明>";
-const std::string CONST_DEFINE = "<常量定义>";
-const std::string UNSIGNINT = "<无符号整数>";
-const std::string INTEGER = "<整数>";
-const std::string HEAD_STATE = "<声明头部>";
-const std::string VARIABLE_DECLARE = "<变量说明>";
-const std::string VARIABLE_DEFINE = "<变量定义>";
-const std::string RETURN_FUNCTION = "<有返回值函数定义>";
-const std::string NO_RETURN_FUNCTION = "<无返回值函数定义>";
-const std::string COMPOSITE_SENTENCE = "<复合语句>";
-const std::string PARAMETER_TABLE = "<参数表>";
-const std::string MAIN_FUNCTION = "<主函数>";
-const std::string EXPRESSION = "<表达式>";
-const std::string ITEM = "<项>";
-const std::string FACTOR = "<因子>";
-const std::string SENTENCE = "<语句>";
-const std::string ASSIGN_SENTENCE = "<赋值语句>";
-const std::string IF_SENTENCE = "<条件语句>";
-const std::string CONDITION = "<条件>";
-const std::string LOOP_SENTENCE = "<循环语句>";
-const std::string STEP = "<步长>";
-const std::string RETURN_CALL_SENTENCE = "<有返回值函数调用语句>";
-const std::string NO_RETURN_CALL_SENTENCE = "<无返回值函数调用语句>";
-const std::string VALUE_PARAMETER_TABLE = "<值参数表>";
-const std::string SENTENCE_COLLECTION = "<语句列>";
-const std::string SCANF_SENTENCE = "<读语句>";
-const std::string PRINTF_SENTENCE = "<写语句>";
-const std::string RETURN_SENTENCE = "<返回语句>";
+// One function found by the pre-scan. Its header has been analysed serially; the body is
+// parsed on a worker with strings numbered from the function's start, and the results are
+// merged in source order, shifting the strings past the ones merged before.
+struct FunctionJob {
+    Symbol *function;
+    TypeSymbol return_type;
+    int order;                          // declaration order among the functions
+    SymbolTable *symbol_table;          // level 1: the parameters, then the locals
+    SymbolArena *symbol_arena;          // the locals, until the merge
+    size_t begin;                       // token index of the body's LBRACE
+    size_t end;                         // one past the matching RBRACE
+    MidcodeGenerator *midcode_generator;
+    StringTable *string_table;
+    ErrorHanding *error_handing;
+    int temp_count;                     // the highest temporary number the body used
+};
 
 class ParseAnalyser {
 private:
-    int label_count_;
-    int reg_count_;
-    std::list<struct Lexeme>::iterator iter_;
-    std::list<struct Lexeme>::iterator iter_end_;
+    int label_count_;                   // labels and temporaries are numbered per function
+    int reg_count_;                     // the next free temporary
+    int reg_max_;                       // the highest temporary used in the current function
+    int temp_count_;                    // temporaries of all functions, for the report
+    SyntaxTree *syntax_tree_;           // nullptr unless a syntax dump was requested
+    int syntax_node_count_;
+    const SourceBuffer *source_;
+    TokenStream *token_stream_;
+    Interner *interner_;
+    SymbolArena *symbol_arena_;         // nullptr in a function job
     CheckTable *check_table_;
     StringTable *string_table_;
     std::map<std::string, SymbolTable *> symbol_table_map_;
+    std::vector<SymbolTable *> symbol_table_list_;  // every table this parser created; it owns them
     MidcodeGenerator *midcode_generator_;
     ErrorHanding *error_handing_;
+    std::vector<FunctionJob> *job_list_;        // set while pre-scanning: bodies are recorded, not parsed
+    std::map<int, int> function_order_map_;     // function symbol id -> declaration order
+    const std::map<int, int> *function_order_;  // set in a function job
+    int function_limit_;                        // a function job sees functions up to this order
+
+    ParseAnalyser(const ParseAnalyser &parent, FunctionJob &job, TokenStream *token_stream);
+
+    const Lexeme &Peek(int k = 0);
+
+    int LineNumber(int k = 0);
 
-    void CountIterator(int step);
+    void Advance();
 
     Symbol *FindSymbol();
 
     Symbol *FindSymbol(int level);
 
+    Symbol *VisibleSymbol(Symbol *symbol);
+
+    int SymbolId(bool is_declare);
+
     Symbol *InsertIdentifier(KindSymbol kind, TypeSymbol type, int level);
 
     void InsertSymbolTable(const std::string &name, int level);
 
-    void CleanLevel(int level);
+    SymbolTable *NewSymbolTable();
+
+    void OpenFunctionScope();
 
     void AddChild(SyntaxNode *node);
 
@@ -77,11 +88,11 @@ private:
 
     void AddRparentChild(SyntaxNode *node);
 
-    static SyntaxNode *AddSyntaxChild(const std::string &syntaxName, SyntaxNode *node);
+    SyntaxNode *AddSyntaxChild(SyntaxKind kind, SyntaxNode *node);
 
     void SetSymbolType(TypeSymbol &type);
 
-    bool IsThisIdentifier(const std::string &identifier);
+    bool IsThisIdentifier(TokenKind kind, int k = 0);
 
     bool IsPlusOrMinu();
 
@@ -103,11 +114,21 @@ private:
 
     void AnalyzeReturnCallSentence(SyntaxNode *node);
 
-    TypeSymbol AnalyzeFactor(SyntaxNode *node);
+    static bool IsConstant(const std::string &value);
 
-    TypeSymbol AnalyzeItem(SyntaxNode *node);
+    static int ConstantValue(const std::string &value);
 
-    TypeSymbol AnalyzeExpression(SyntaxNode *node);
+    int AllocateTemporary(const std::string &value1, const std::string &value2);
+
+    std::string FoldOperate(const std::string &op, const std::string &value1, const std::string &value2);
+
+    std::string FoldNeg(const std::string &value);
+
+    TypeSymbol AnalyzeFactor(SyntaxNode *node, std::string &value);
+
+    TypeSymbol AnalyzeItem(SyntaxNode *node, std::string &value);
+
+    TypeSymbol AnalyzeExpression(SyntaxNode *node, std::string &value);
 
     void AnalyzeCondition(SyntaxNode *node, bool isFalseBranch, int label_count);
 
@@ -139,6 +160,8 @@ private:
 
     void AnalyzeCompositeSentence(SyntaxNode *node, TypeSymbol returnType);
 
+    void AnalyzeFunctionBody(SyntaxNode *node, Symbol *function, TypeSymbol returnType);
+
     void AnalyzeMain(SyntaxNode *node);
 
     void AnalyzeParameterTable(SyntaxNode *node, Symbol *function);
@@ -149,12 +172,37 @@ private:
 
     void AnalyzeFunc(SyntaxNode *node);
 
+    void BeginFunctionSpan();
+
+    void BeginFunctionJob();
+
+    void EndFunctionJob();
+
     void BuildSyntaxTree(SyntaxNode *root);
 
+    bool IsFunctionSplittable();
+
+    void AnalyzeFunctionJob(FunctionJob &job);
+
+    void MergeFunctionJob(FunctionJob &job);
+
+    bool AnalyzeParallel(int job_count);
+
 public:
-    ParseAnalyser(const std::string &fileName, std::list<struct Lexeme> *lexList, ErrorHanding *errorHanding);
+    ParseAnalyser(const std::string &fileName, const SourceBuffer *source, TokenStream *token_stream,
+                  Interner *interner, ErrorHanding *errorHanding);
 
-    void AnalyzeParse();
+    ~ParseAnalyser();
+
+    ParseAnalyser(const ParseAnalyser &) = delete;
+
+    ParseAnalyser &operator=(const ParseAnalyser &) = delete;
+
+    void AnalyzeParse(bool is_syntax_tree, int job_count);
+
+    bool PrintSyntaxTree(const std::string &file_name);
+
+    void FreeSyntaxTree();
 
     std::map<std::string, SymbolTable *> symbol_table_map();
 
@@ -164,7 +212,9 @@ public:
 
     CheckTable *check_table();
 
-    int reg_count() const;
+    int temp_count() const;
+
+    int syntax_node_count();
 
     void FileClose();
 };
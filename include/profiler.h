@@ -0,0 +1,67 @@
+﻿#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Phase timing and heap accounting (-ftime-report). Heap bytes come from the global
+// operator new/delete replacement in profiler.cpp, so they cover every C++ allocation once a
+// profiler is enabled. A span's heap figures are those of the thread that opened it.
+// Each thread has its own profiler; Flush() hands its spans to the process-wide
+// Chrome trace written by WriteTrace(). A worker Adopt()s its spans into the profiler
+// that started it, so the report shows them under the span waiting for the worker.
+class Profiler {
+private:
+    struct Span {
+        std::string name;
+        std::string detail;         // e.g. the function a "function" span covers
+        int depth;
+        long long begin_time;       // nanoseconds since the process started
+        long long end_time;
+        long long begin_heap;
+        long long peak_heap;
+        long long end_heap;
+        long long outer_peak;
+        bool is_adopted;            // a worker's span, traced by the worker itself
+    };
+
+    bool is_enabled_;
+    int thread_id_;
+    size_t flush_count_;
+    std::vector<Span> span_list_;
+    std::vector<size_t> stack_;
+    std::vector<std::pair<std::string, long long>> count_list_;
+
+    static long long Now();
+
+    static std::string Escape(const std::string &str);
+
+public:
+    Profiler();
+
+    static Profiler *GetInstance();
+
+    static long long heap_current();
+
+    void Enable();
+
+    bool is_enabled() const;
+
+    void Begin(const std::string &name, const std::string &detail = "");
+
+    void End();
+
+    void AddCount(const std::string &name, long long count);
+
+    // copies worker's finished spans under the innermost open span; safe to call from
+    // several workers at once while this profiler's thread waits for them
+    void Adopt(const Profiler &worker);
+
+    void Report(std::ostream &output) const;
+
+    void Flush();
+
+    static bool WriteTrace(const std::string &file_name);
+};
@@ -0,0 +1,38 @@
+﻿#pragma once
+
+#include <cstddef>
+
+// Character-class scanning kernels for the lexer's hot loops. Each Skip* returns the first
+// byte in [begin, end) outside its class (or end). On x86 the widest of AVX2 / SSE2 is
+// picked once at startup; elsewhere, and for the tail of every run, a scalar loop is used.
+class Scanner {
+private:
+    struct Kernel {
+        const char *(*skip_space)(const char *begin, const char *end);
+        const char *(*skip_identifier)(const char *begin, const char *end);
+        const char *(*skip_digit)(const char *begin, const char *end);
+        const char *(*skip_string_letter)(const char *begin, const char *end);
+    };
+
+    static const Kernel &kernel();
+
+public:
+    // isspace() in the C locale
+    static const char *SkipSpace(const char *begin, const char *end) {
+        return kernel().skip_space(begin, end);
+    }
+
+    // letters, digits and '_'
+    static const char *SkipIdentifier(const char *begin, const char *end) {
+        return kernel().skip_identifier(begin, end);
+    }
+
+    static const char *SkipDigit(const char *begin, const char *end) {
+        return kernel().skip_digit(begin, end);
+    }
+
+    // ASCII 32..126 except '"', i.e. what may appear unescaped inside a string literal
+    static const char *SkipStringLetter(const char *begin, const char *end) {
+        return kernel().skip_string_letter(begin, end);
+    }
+};
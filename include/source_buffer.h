@@ -0,0 +1,47 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Whole source text in one contiguous block: a read-only mmap of a regular file, or an
+// owned copy for in-memory text and files that cannot be mapped. Tokens point into it.
+// Open("-") reads stdin, which is mapped too when it is redirected from a regular file.
+// Tokens record byte offsets only; Line()/Column() resolve one on demand, building the
+// line-start index on first use, so a compile without diagnostics never scans for newlines.
+class SourceBuffer {
+private:
+    const char *data_;
+    size_t size_;
+    void *map_;
+    size_t map_size_;
+    std::string text_;
+    mutable std::vector<size_t> line_start_list_;      // empty until the first Line()/Column()
+
+    void Unmap();
+
+    void BuildLineIndex() const;
+
+    size_t FindLine(size_t offset) const;
+
+public:
+    SourceBuffer();
+
+    SourceBuffer(const SourceBuffer &) = delete;
+
+    SourceBuffer &operator=(const SourceBuffer &) = delete;
+
+    ~SourceBuffer();
+
+    bool Open(const std::string &file_name);
+
+    void Assign(const std::string &text);
+
+    const char *data() const;
+
+    size_t size() const;
+
+    int Line(size_t offset) const;
+
+    int Column(size_t offset) const;
+};
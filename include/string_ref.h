@@ -0,0 +1,77 @@
+﻿#pragma once
+
+#include <cstring>
+#include <ostream>
+#include <string>
+
+// Non-owning view of characters that live in a source buffer. The build is C++11, so this
+// stands in for std::string_view; the viewed buffer must outlive the view.
+class StringRef {
+private:
+    const char *data_;
+    size_t size_;
+
+public:
+    StringRef() : data_(""), size_(0) {}
+
+    StringRef(const char *data, size_t size) : data_(data), size_(size) {}
+
+    StringRef(const char *str) : data_(str), size_(strlen(str)) {}
+
+    StringRef(const std::string &str) : data_(str.data()), size_(str.size()) {}
+
+    const char *data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    char operator[](size_t index) const {
+        return data_[index];
+    }
+
+    std::string str() const {
+        return std::string(data_, size_);
+    }
+
+    operator std::string() const {
+        return str();
+    }
+
+    bool operator==(const StringRef &other) const {
+        return size_ == other.size_ && memcmp(data_, other.data_, size_) == 0;
+    }
+
+    bool operator!=(const StringRef &other) const {
+        return !(*this == other);
+    }
+};
+
+inline std::string operator+(const std::string &lhs, const StringRef &rhs) {
+    return lhs + rhs.str();
+}
+
+inline std::string operator+(const StringRef &lhs, const std::string &rhs) {
+    return lhs.str() + rhs;
+}
+
+inline std::ostream &operator<<(std::ostream &output, const StringRef &str) {
+    return output.write(str.data(), (std::streamsize) str.size());
+}
+
+// FNV-1a, so StringRef can key the unordered containers.
+struct StringRefHash {
+    size_t operator()(const StringRef &str) const {
+        size_t hash = 2166136261u;
+        for (size_t i = 0; i < str.size(); i++) {
+            hash = (hash ^ (unsigned char) str[i]) * 16777619u;
+        }
+        return hash;
+    }
+};
@@ -1,40 +1,53 @@
 ﻿#pragma once
 
 #include <string>
+#include <vector>
+
+#define SYMBOL_CHUNK_SIZE   256     // symbols per arena chunk
 
 enum class KindSymbol {
     CONST,
     VARIABLE,
     ARRAY,
     FUNCTION,
-    PARAMETER
+    PARAMETER       // the last: MidcodeImage::Load rejects anything past it
 };
 
-enum class TypeSymbol {
+enum class TypeSymbol : unsigned char {
     INT,
     CHAR,
-    VOID
+    VOID            // the last: MidcodeImage::Load rejects anything past it
 };
 
 class Symbol {
 private:
-    std::string name_;
-    std::string parameter_;
-    std::string const_value_;
+    int id_;
+    int index_;                     // dense within the compilation: the SymbolArena position
+    const std::string *name_;       // the interned spelling, owned by the Interner
+    std::vector<TypeSymbol> parameter_list_;
+    bool has_const_value_;
+    int const_value_;               // a const's value; a char const holds the character code
 
     int array_length_;
     int reg_number_;
     int offset_;
+    int level_;                     // 0 for a global, 1 for a function's parameter or local
 
     KindSymbol kind_;
     TypeSymbol type_;
 
+    friend class SymbolArena;
+
 public:
     Symbol();
 
-    void SetProperty(const std::string &name, KindSymbol kind, TypeSymbol type);
+    void SetProperty(int id, const std::string *name, KindSymbol kind, TypeSymbol type);
+
+    int id() const;
 
-    std::string name();
+    int index() const;
+
+    const std::string &name() const;
 
     KindSymbol kind();
 
@@ -42,15 +55,20 @@ public:
 
     TypeSymbol type();
 
-    void AddParameter(char c);
+    void AddParameter(TypeSymbol type);
+
+    const std::vector<TypeSymbol> &parameter_list() const;
 
-    std::string parameter();
+    int GetParameterCount() const;
 
-    int GetParameterCount();
+    void set_const_value(int const_value);
 
-    void set_const_value(const std::string &const_value);
+    bool has_const_value() const;
 
-    std::string const_value();
+    int const_value() const;
+
+    // the const as a midcode operand: 5, or 'c' for a char const
+    std::string GetConstOperand() const;
 
     void set_array_length(int array_length);
 
@@ -64,5 +82,39 @@ public:
 
     int offset() const;
 
+    void set_level(int level);
+
+    int level() const;
+
+};
+
+// Every symbol of one compilation, carved out of fixed-size chunks so pointers stay put, and
+// freed at once with the arena. Symbols are numbered densely from 0 in allocation order, so
+// facts about them can live in vectors and bitsets indexed by Symbol::index(). A function job
+// allocates from an arena of its own, which the parser appends to its arena when it merges.
+class SymbolArena {
+private:
+    std::vector<Symbol *> chunk_list_;
+    Symbol *chunk_;                         // the chunk symbols are carved from
+    int chunk_used_;
+    std::vector<Symbol *> symbol_list_;     // by index
+
+public:
+    SymbolArena();
+
+    ~SymbolArena();
+
+    SymbolArena(const SymbolArena &) = delete;
+
+    SymbolArena &operator=(const SymbolArena &) = delete;
+
+    Symbol *NewSymbol();
+
+    // takes over other's symbols, numbered after these; other is left empty
+    void Append(SymbolArena &other);
+
+    int size() const;
+
+    Symbol *symbol(int index) const;
 };
 
@@ -2,49 +2,80 @@
 
 #include <fstream>
 #include <string>
-#include <list>
+#include <vector>
+#include "lexical_analyser.h"
+#include "string_ref.h"
+
+#define SYNTAX_CHUNK_SIZE   4096    // nodes per arena chunk
+#define SYNTAX_PRINT_BUFFER 65536   // bytes of dump text gathered before each write
+
+enum class SyntaxKind : unsigned char {
+    TOKEN,      // a leaf holding one lexeme
+
+    STRING, PROGRAM, CONST_DECLARE, CONST_DEFINE, UNSIGNINT, INTEGER, HEAD_STATE,
+    VARIABLE_DECLARE, VARIABLE_DEFINE, RETURN_FUNCTION, NO_RETURN_FUNCTION,
+    COMPOSITE_SENTENCE, PARAMETER_TABLE, MAIN_FUNCTION,
+    EXPRESSION, ITEM, FACTOR,
+    SENTENCE, ASSIGN_SENTENCE, IF_SENTENCE, CONDITION, LOOP_SENTENCE, STEP,
+    RETURN_CALL_SENTENCE, NO_RETURN_CALL_SENTENCE, VALUE_PARAMETER_TABLE,
+    SENTENCE_COLLECTION, SCANF_SENTENCE, PRINTF_SENTENCE, RETURN_SENTENCE
+};
+
+// the spelling used in the syntax dump, e.g. "<表达式>"
+const char *SyntaxName(SyntaxKind kind);
 
+// A node of the concrete syntax tree. Nodes are carved out of a SyntaxTree and freed with
+// it; a TOKEN node keeps its spelling as a view into the source buffer.
 class SyntaxNode {
 private:
-    std::string syntax_identifier_;
-    std::string lexeme_identifier_;
-    std::string lexeme_value_;
-    std::string value_;
-    std::list<SyntaxNode *> child_list_;
-
-    void WriteLexical(std::ofstream &output);
+    SyntaxKind kind_;
+    TokenKind token_kind_;
+    unsigned lexeme_size_;
+    const char *lexeme_data_;
+    SyntaxNode *first_child_;
+    SyntaxNode *last_child_;
+    SyntaxNode *next_sibling_;
 
-    void WriteSyntax(std::ofstream &output);
+    friend class SyntaxTree;
 
 public:
-    SyntaxNode();
+    SyntaxKind kind() const;
 
-    SyntaxNode(const std::string & syntax_identifier);
+    TokenKind token_kind() const;
 
-    SyntaxNode(const std::string & lexeme_identifier, const std::string & lexeme_value);
+    StringRef lexeme() const;
 
-    void set_syntax_identifier(const std::string & syntax_identifier);
+    bool IsLeaf() const;
 
-    void set_value(const std::string & value);
+    SyntaxNode *first_child() const;
 
-    bool IsLeaf();
+    SyntaxNode *next_sibling() const;
 
-    bool IsLexemeEmpty();
+    void Print(std::string &buffer) const;
+};
 
-    void AddChild(SyntaxNode *child);
+class SyntaxTree {
+private:
+    std::vector<SyntaxNode *> chunk_list_;
+    int node_count_;
+    SyntaxNode *root_;
 
-    std::string syntax_identifier();
+    SyntaxNode *NewNode(SyntaxNode *parent);
 
-    std::string lexeme_identifier();
+public:
+    SyntaxTree();
 
-    std::string lexeme_value();
+    ~SyntaxTree();
 
-    std::string value();
+    SyntaxNode *AddRoot(SyntaxKind kind);
 
-    std::string GetFirstChildNumericalValue();
+    SyntaxNode *AddSyntax(SyntaxNode *parent, SyntaxKind kind);
 
-    std::list<SyntaxNode *> GetChildList();
+    void AddToken(SyntaxNode *parent, const Lexeme &lexeme);
 
-    void Print(std::ofstream &output);
-};
+    SyntaxNode *root() const;
 
+    int node_count() const;
+
+    void Print(std::ofstream &output) const;
+};
@@ -3,6 +3,7 @@
 #include <string>
 #include <map>
 #include <vector>
+#include "interner.h"
 #include "symbol.h"
 
 class StringTable {
@@ -19,42 +20,94 @@ public:
     std::string GetString(int string_number);
 };
 
+#define SYMBOL_TABLE_CAPACITY   16      // initial slots; always a power of two
+
+// Symbols keyed by interned identifier id; name must be the Interner's copy of the spelling.
+// The slots are an open-addressing table probed linearly from a hash of the id, doubled
+// before it gets half full; symbol_list keeps the symbols in declaration order. The symbols
+// belong to a SymbolArena.
 class SymbolTable {
 private:
-    std::map<std::string, Symbol *> symbol_map_;
+    std::vector<Symbol *> slot_list_;
+    std::vector<Symbol *> symbol_list_;
+
+    size_t Probe(int id) const;
+
+    void Grow();
 public:
     SymbolTable();
 
-    Symbol *AddSymbol(const std::string &name, KindSymbol kind, TypeSymbol type);
+    SymbolTable(const SymbolTable &) = delete;
 
-    Symbol *FindSymbol(const std::string &name);
+    SymbolTable &operator=(const SymbolTable &) = delete;
 
-    std::map<std::string, Symbol *> symbol_map();
+    // FindSymbol returns symbol for its id from now on, even if another had that id
+    void AddSymbol(Symbol *symbol);
+
+    Symbol *FindSymbol(int id) const;
+
+    const std::vector<Symbol *> &symbol_list() const;
 };
 
+// The parser looks symbols up by the id its tokens carry. The string overloads translate a
+// midcode operand through the Interner first; the backend uses them once per operand, to bind
+// it (Midcode::BindSymbol), and reads the cached symbol from then on.
+//
+// Level 0 is the global table; every scope opened above it is one level deeper. Names declared
+// in scopes are bound in binding_list_, indexed by id, to the innermost symbol; a declaration
+// logs the binding it hides, and closing a scope replays the log back to where the scope
+// opened, so opening and closing a scope allocate nothing and a lookup is one index. The
+// symbols of a function's scopes are kept in the function's SymbolTable, which the parser
+// hands on to the backends. The check table owns none of the tables; new symbols come from
+// symbol_arena_.
 class CheckTable {
 private:
+    struct Shadow {
+        int id;
+        Symbol *symbol;                     // the binding the declaration hid
+    };
+
+    const Interner *interner_;
+    SymbolArena *symbol_arena_;
     std::map<std::string, int> function_variable;
-    std::vector<SymbolTable *> symbol_table_vector_;
+    SymbolTable *global_table_;
+    SymbolTable *function_table_;           // the symbols of every open scope
+    std::vector<Symbol *> binding_list_;    // id -> innermost symbol above level 0, or nullptr
+    std::vector<Shadow> undo_log_;
+    std::vector<size_t> scope_list_;        // undo_log_ size when each open scope was opened
+
+    void Bind(Symbol *symbol);
+
 public:
-    CheckTable();
+    CheckTable(const Interner *interner, SymbolArena *symbol_arena);
+
+    CheckTable(const CheckTable &) = delete;
+
+    CheckTable &operator=(const CheckTable &) = delete;
+
+    // level is 0 or the current level
+    Symbol *AddSymbol(int id, KindSymbol kind, TypeSymbol type, int level);
 
-    Symbol *AddSymbol(const std::string &name, KindSymbol kind, TypeSymbol type, int level);
+    Symbol *FindSymbol(int id);
+
+    Symbol *FindSymbol(int id, int level);
 
     Symbol *FindSymbol(const std::string &name);
 
     Symbol *FindSymbol(const std::string &name, int level);
 
-    int GetSymbolLevel(const std::string &name);
+    int level() const;
+
+    void OpenScope();
 
-    void ClearLevel(int level);
+    void CloseScope();
 
+    // Level 0 replaces the global table. Level 1 closes every scope and opens a function scope
+    // over symbol_table, binding the symbols already in it.
     void SetTable(int level, SymbolTable *symbol_table);
 
     SymbolTable *GetSymbolTable(int level);
 
-    std::map<std::string, Symbol *> GetSymbolMap(int level);
-
     void AddFunctionVariableNumber(const std::string &function_name, int number);
 
     int GetFunctionVariableNumber(const std::string &function_name);
@@ -0,0 +1,41 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "lexical_analyser.h"
+
+#define TOKEN_RING_SIZE     8       // power of two: the lookahead window plus a few consumed tokens
+
+// Pulls tokens from the lexer on demand into a small ring, so the parser holds at most
+// TOKEN_RING_SIZE tokens however long the source is. It can also walk a token list lexed
+// up front (by ParallelLexer), or just the tokens [begin, end) of one, as a function job
+// does (see ParseAnalyser). Peek(k) reaches a few tokens either side of the cursor;
+// anything before the first or after the last token reads as END.
+class TokenStream {
+private:
+    LexicalAnalyser *lexical_analyser_;
+    const std::vector<struct Lexeme> *lexeme_list_;
+    Lexeme ring_[TOKEN_RING_SIZE];
+    size_t index_;          // position of the current token in the whole stream
+    size_t end_index_;      // a list walk stops here
+    size_t fill_count_;     // tokens pulled from the lexer so far
+    bool is_drained_;
+    Lexeme end_lexeme_;
+
+public:
+    explicit TokenStream(LexicalAnalyser *lexical_analyser);
+
+    TokenStream(const std::vector<struct Lexeme> *lexeme_list, unsigned end_offset);
+
+    TokenStream(const std::vector<struct Lexeme> *lexeme_list, size_t begin, size_t end);
+
+    const Lexeme &Peek(int k = 0);
+
+    void Advance();
+
+    size_t token_count() const;
+
+    size_t index() const;
+
+    const std::vector<struct Lexeme> *lexeme_list() const;
+};
@@ -0,0 +1,197 @@
+﻿#include "compiler.h"
+
+#include <thread>
+#include "midcode_generator.h"
+#include "optimizer.h"
+#include "mips_generator.h"
+#include "parallel_lexer.h"
+#include "profiler.h"
+
+using namespace std;
+
+Compiler::Compiler(const string &testfile, const string &midcode_file, const string &error_file) {
+    testfile_ = testfile;
+    midcode_file_ = midcode_file;
+    error_handing_ = new ErrorHanding(error_file);
+    source_ = new SourceBuffer();
+    interner_ = new Interner();
+    lex_job_count_ = 0;
+    parse_job_count_ = 0;
+    parse_analyser_ = nullptr;
+    midcode_image_ = nullptr;
+    string_table_ = nullptr;
+    check_table_ = nullptr;
+}
+
+// A batch driver compiles many programs in one process, so everything is given back here.
+Compiler::~Compiler() {
+    for (Optimizer *optimizer : optimizer_list_) {
+        delete optimizer;
+    }
+    delete midcode_image_;
+    delete parse_analyser_;
+    delete interner_;
+    delete source_;
+    delete error_handing_;
+}
+
+void Compiler::set_lex_job_count(int lex_job_count) {
+    lex_job_count_ = lex_job_count;
+}
+
+void Compiler::set_parse_job_count(int parse_job_count) {
+    parse_job_count_ = parse_job_count;
+}
+
+void Compiler::set_syntax_file(const string &syntax_file) {
+    syntax_file_ = syntax_file;
+}
+
+bool Compiler::Open() {
+    Profiler *profiler = Profiler::GetInstance();
+
+    profiler->Begin("read");
+    bool is_open = source_->Open(testfile_);
+    profiler->End();
+    return is_open;
+}
+
+bool Compiler::Analyze() {
+    Profiler *profiler = Profiler::GetInstance();
+
+    int default_job_count = source_->size() >= PARALLEL_LEX_SIZE ? (int) max(1u, thread::hardware_concurrency()) : 1;
+    int job_count = lex_job_count_ == 0 ? default_job_count : lex_job_count_;
+    int parse_job_count = parse_job_count_ == 0 ? default_job_count : parse_job_count_;
+    if (!syntax_file_.empty()) {
+        parse_job_count = 1;
+    }
+    LexicalAnalyser lexical_analyser(source_, interner_, error_handing_);
+    ParallelLexer parallel_lexer(source_, interner_, error_handing_, job_count);
+    TokenStream *token_stream;
+    bool is_lex_first = job_count > 1 || parse_job_count > 1;    // function jobs need the whole token list
+    if (is_lex_first) {
+        profiler->Begin("lex");
+        token_stream = new TokenStream(parallel_lexer.Analyze(), (unsigned) source_->size());
+        profiler->End();
+    } else {
+        token_stream = new TokenStream(&lexical_analyser);
+    }
+
+    // unless lexed up front, the parser pulls tokens as it goes; midcode is emitted while parsing
+    profiler->Begin(is_lex_first ? "parse+midcode" : "lex+parse+midcode");
+    parse_analyser_ = new ParseAnalyser(midcode_file_, source_, token_stream, interner_, error_handing_);
+    parse_analyser_->AnalyzeParse(!syntax_file_.empty(), parse_job_count);
+    parse_analyser_->FileClose();
+    lexical_analyser.FileClose();
+    profiler->End();
+    if (!syntax_file_.empty()) {
+        profiler->Begin("syntax dump");
+        parse_analyser_->PrintSyntaxTree(syntax_file_);
+        profiler->End();
+    }
+    if (profiler->is_enabled()) {
+        profiler->AddCount("tokens", (long long) token_stream->token_count());
+        profiler->AddCount("identifiers", interner_->size());
+        if (!syntax_file_.empty()) {
+            profiler->AddCount("syntax nodes", parse_analyser_->syntax_node_count());
+        }
+        profiler->AddCount("midcodes", (long long) parse_analyser_->midcode_list().size());
+        profiler->AddCount("temporaries", parse_analyser_->temp_count());
+    }
+    delete token_stream;
+    parse_analyser_->FreeSyntaxTree();
+
+    if (error_handing_->IsError()) {
+        error_handing_->PrintError();
+        error_handing_->FileClose();
+        return false;
+    }
+    error_handing_->FileClose();
+
+    string_table_ = parse_analyser_->string_table();
+    check_table_ = parse_analyser_->check_table();
+    symbol_table_map_ = parse_analyser_->symbol_table_map();
+    midcode_list_ = parse_analyser_->midcode_list();
+    profiler->Begin("frame layout");
+    frame_layout_map_ = FrameLayout::LayoutProgram(midcode_list_, check_table_, symbol_table_map_);
+    profiler->End();
+    return true;
+}
+
+bool Compiler::Load(const string &image_file) {
+    Profiler *profiler = Profiler::GetInstance();
+
+    profiler->Begin("load image");
+    midcode_image_ = new MidcodeImage();
+    bool is_loaded = midcode_image_->Load(image_file, interner_);
+    profiler->End();
+    if (!is_loaded) {
+        return false;
+    }
+    string_table_ = midcode_image_->string_table();
+    check_table_ = midcode_image_->check_table();
+    symbol_table_map_ = midcode_image_->symbol_table_map();
+    midcode_list_ = midcode_image_->midcode_list();
+    frame_layout_map_ = midcode_image_->frame_layout_map();
+    profiler->AddCount("midcodes", (long long) midcode_list_.size());
+
+    if (!midcode_file_.empty()) {
+        profiler->Begin("midcode dump");
+        MidcodeGenerator midcode_generator;
+        midcode_generator.OpenMidcodeFile(midcode_file_);
+        for (Midcode *midcode : midcode_list_) {
+            midcode_generator.AddMidcode(midcode);
+        }
+        midcode_generator.FileClose();
+        profiler->End();
+    }
+    return true;
+}
+
+bool Compiler::Save(const string &image_file) {
+    Profiler *profiler = Profiler::GetInstance();
+
+    profiler->Begin("save image");
+    bool is_saved = MidcodeImage::Write(image_file, interner_, string_table_, symbol_table_map_,
+                                        frame_layout_map_, midcode_list_);
+    profiler->End();
+    return is_saved;
+}
+
+list<Midcode *> Compiler::Optimize(int optimize_level) {
+    Profiler *profiler = Profiler::GetInstance();
+
+    profiler->Begin("optimize");
+    auto optimizer = new Optimizer(midcode_list_);
+    optimizer_list_.push_back(optimizer);
+    optimizer->Optimize(optimize_level);
+    list<Midcode *> midcode_list = optimizer->midcode_list();
+    profiler->End();
+    profiler->AddCount("optimized midcodes", (long long) midcode_list.size());
+    return midcode_list;
+}
+
+void Compiler::GenerateMips(const string &mips_file, int optimize_level) {
+    MipsGenerator mips_generator = MipsGenerator(mips_file,
+                                                 string_table_, check_table_, symbol_table_map_, frame_layout_map_,
+                                                 Optimize(optimize_level), optimize_level);
+
+    Profiler *profiler = Profiler::GetInstance();
+    profiler->Begin("mips");
+    mips_generator.GenerateMips();
+    mips_generator.FileClose();
+    profiler->End();
+    profiler->AddCount("mips instructions", mips_generator.instruction_count());
+}
+
+StringTable *Compiler::string_table() {
+    return string_table_;
+}
+
+map<string, SymbolTable *> Compiler::symbol_table_map() {
+    return symbol_table_map_;
+}
+
+map<string, FrameLayout> Compiler::frame_layout_map() {
+    return frame_layout_map_;
+}
\ No newline at end of file
@@ -28,4 +28,8 @@ int Error::line_number() const {
 
 char Error::error_type() const {
     return error_type_;
+}
+
+ErrorOrigin Error::origin() const {
+    return error_type_ == ILLEGAL_SYMBOL_OR_LEXICAL_INCONFORMITY ? ErrorOrigin::LEX : ErrorOrigin::PARSE;
 }
\ No newline at end of file
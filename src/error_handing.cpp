@@ -2,6 +2,9 @@
 
 using namespace std;
 
+// collects errors only, e.g. for one chunk of a parallel lex; Append() them to a real one
+ErrorHanding::ErrorHanding() = default;
+
 ErrorHanding::ErrorHanding(const string &file_name) {
     this->error_file_.open(file_name);
 }
@@ -14,7 +17,20 @@ void ErrorHanding::AddError(int line_number, char error_type) {
     error_list_.emplace_back(line_number, error_type);
 }
 
+void ErrorHanding::Append(const ErrorHanding &other) {
+    error_list_.insert(error_list_.end(), other.error_list_.begin(), other.error_list_.end());
+}
+
+// Lexical errors are found before or alongside the parser's depending on how the source was
+// lexed, so they are printed by line and, within a line, the lexer's before the parser's; each
+// pass reports in source order and list::sort is stable, so the output is the same either way.
 void ErrorHanding::PrintError() {
+    error_list_.sort([](const Error &lhs, const Error &rhs) {
+        if (lhs.line_number() != rhs.line_number()) {
+            return lhs.line_number() < rhs.line_number();
+        }
+        return lhs.origin() < rhs.origin();
+    });
     auto iter = error_list_.begin();
 
     while (iter != error_list_.end()) {
@@ -0,0 +1,154 @@
+﻿#include "frame_layout.h"
+
+#include <algorithm>
+
+using namespace std;
+
+FrameLayout::FrameLayout() {
+    variable_size_ = 0;
+    temp_count_ = 0;
+}
+
+FrameLayout::FrameLayout(int variable_size, int temp_count) {
+    variable_size_ = variable_size;
+    temp_count_ = temp_count;
+}
+
+bool FrameLayout::IsFunctionDeclare(MidcodeInstr instr) {
+    return instr == MidcodeInstr::INT_FUNC_DECLARE
+           || instr == MidcodeInstr::CHAR_FUNC_DECLARE
+           || instr == MidcodeInstr::VOID_FUNC_DECLARE;
+}
+
+bool FrameLayout::IsJump(MidcodeInstr instr) {
+    switch (instr) {
+        case MidcodeInstr::JUMP:
+        case MidcodeInstr::BGT:
+        case MidcodeInstr::BGE:
+        case MidcodeInstr::BLT:
+        case MidcodeInstr::BLE:
+        case MidcodeInstr::BEQ:
+        case MidcodeInstr::BNE:
+        case MidcodeInstr::BEZ:
+        case MidcodeInstr::BNZ:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// A loop runs from its label, which a LOOP marker follows, to the last jump back to that label.
+void FrameLayout::CountUse(const vector<Midcode *> &body, CheckTable *check_table,
+                           vector<long long> &weight_list) {
+    map<int, size_t> loop_begin_map;
+    map<int, size_t> loop_end_map;
+    for (size_t i = 0; i < body.size(); i++) {
+        if (body[i]->instr() == MidcodeInstr::LABEL
+            && i + 1 < body.size() && body[i + 1]->instr() == MidcodeInstr::LOOP) {
+            loop_begin_map[body[i]->count()] = i;
+        } else if (IsJump(body[i]->instr()) && loop_begin_map.count(body[i]->count()) > 0) {
+            loop_end_map[body[i]->count()] = i;
+        }
+    }
+    vector<int> depth_change(body.size() + 1, 0);
+    for (const auto &loop_end : loop_end_map) {
+        depth_change[loop_begin_map[loop_end.first]]++;
+        depth_change[loop_end.second + 1]--;
+    }
+
+    int depth = 0;
+    for (size_t i = 0; i < body.size(); i++) {
+        depth += depth_change[i];
+        Midcode *midcode = body[i];
+        if (midcode->instr() == MidcodeInstr::VAR_INT || midcode->instr() == MidcodeInstr::VAR_CHAR) {
+            continue;
+        }
+        midcode->BindSymbol(check_table);
+        long long weight = 1;
+        for (int k = 0; k < min(depth, LOOP_WEIGHT_MAX_DEPTH); k++) {
+            weight *= LOOP_WEIGHT;
+        }
+        for (Symbol *symbol : {midcode->symbol1(), midcode->symbol2(), midcode->symbol_result()}) {
+            if (symbol == nullptr) {
+                continue;
+            }
+            if ((size_t) symbol->index() >= weight_list.size()) {
+                weight_list.resize(2 * (size_t) symbol->index() + 1, 0);
+            }
+            weight_list[symbol->index()] += weight;
+        }
+    }
+}
+
+void FrameLayout::Build(const SymbolTable *symbol_table, const vector<long long> &weight_list,
+                        int temp_count) {
+    vector<Symbol *> scalar_list;
+    vector<Symbol *> array_list;
+    for (Symbol *symbol : symbol_table->symbol_list()) {
+        if (symbol->kind() == KindSymbol::ARRAY) {
+            array_list.push_back(symbol);
+        } else if (symbol->kind() == KindSymbol::VARIABLE || symbol->kind() == KindSymbol::PARAMETER) {
+            scalar_list.push_back(symbol);
+        }
+    }
+    auto weight = [&weight_list](Symbol *symbol) {
+        return (size_t) symbol->index() < weight_list.size() ? weight_list[symbol->index()] : 0;
+    };
+    auto is_hotter = [&weight](Symbol *symbol_1, Symbol *symbol_2) {
+        return weight(symbol_1) > weight(symbol_2);
+    };
+    stable_sort(scalar_list.begin(), scalar_list.end(), is_hotter);
+    stable_sort(array_list.begin(), array_list.end(), is_hotter);
+
+    variable_size_ = 0;
+    for (Symbol *symbol : scalar_list) {
+        symbol->set_offset(variable_size_);
+        variable_size_ += 4;
+    }
+    for (Symbol *symbol : array_list) {
+        symbol->set_offset(variable_size_);
+        variable_size_ += 4 * symbol->array_length();
+    }
+    temp_count_ = temp_count;
+}
+
+int FrameLayout::variable_size() const {
+    return variable_size_;
+}
+
+int FrameLayout::frame_size() const {
+    return variable_size_ + 4 * (temp_count_ + 1);
+}
+
+int FrameLayout::temp_count() const {
+    return temp_count_;
+}
+
+// Binds every operand as the backends would, under the scope of its function, and weighs the
+// uses; the globals are laid out last, once every function has counted its uses of them.
+map<string, FrameLayout> FrameLayout::LayoutProgram(const list<Midcode *> &midcode_list,
+                                                    CheckTable *check_table,
+                                                    const map<string, SymbolTable *> &symbol_table_map) {
+    vector<long long> weight_list;
+    map<string, FrameLayout> layout_map;
+
+    auto iter = midcode_list.begin();
+    while (iter != midcode_list.end()) {
+        if (!IsFunctionDeclare((*iter)->instr())) {
+            iter++;
+            continue;
+        }
+        string name = (*iter)->label();
+        SymbolTable *symbol_table = symbol_table_map.at(name);
+        vector<Midcode *> body;
+        for (iter++; iter != midcode_list.end() && !IsFunctionDeclare((*iter)->instr()); iter++) {
+            body.push_back(*iter);
+        }
+
+        check_table->SetTable(1, symbol_table);
+        CountUse(body, check_table, weight_list);
+        layout_map[name].Build(symbol_table, weight_list, check_table->GetFunctionVariableNumber(name));
+    }
+    layout_map["global"].Build(symbol_table_map.at("global"), weight_list, 0);
+    return layout_map;
+}
\ No newline at end of file
@@ -15,4 +15,41 @@ namespace midcodeinstr {
                 assert(0);
         }
     }
+
+    std::string GetOperatorString(MidcodeInstr instr) {
+        switch (instr) {
+            case MidcodeInstr::ADD:
+                return "+";
+            case MidcodeInstr::SUB:
+                return "-";
+            case MidcodeInstr::MUL:
+                return "*";
+            case MidcodeInstr::DIV:
+                return "/";
+            default:
+                assert(0);
+        }
+    }
+
+    bool Calculate(MidcodeInstr instr, int value1, int value2, int &result) {
+        switch (instr) {
+            case MidcodeInstr::ADD:
+                result = (int) ((unsigned) value1 + (unsigned) value2);
+                return true;
+            case MidcodeInstr::SUB:
+                result = (int) ((unsigned) value1 - (unsigned) value2);
+                return true;
+            case MidcodeInstr::MUL:
+                result = (int) ((unsigned) value1 * (unsigned) value2);
+                return true;
+            case MidcodeInstr::DIV:
+                if (value2 == 0 || value2 == -1) {
+                    return false;
+                }
+                result = value1 / value2;
+                return true;
+            default:
+                return false;
+        }
+    }
 }
\ No newline at end of file
@@ -0,0 +1,34 @@
+﻿#include "interner.h"
+
+#include <cassert>
+
+using namespace std;
+
+Interner::Interner() = default;
+
+int Interner::Intern(const StringRef &name) {
+    auto iter = id_map_.find(name);
+    if (iter != id_map_.end()) {
+        return iter->second;
+    }
+
+    int id = (int) name_list_.size();
+    name_list_.push_back(name.str());
+    const string &stored = name_list_.back();
+    id_map_.insert(make_pair(StringRef(stored.data(), stored.size()), id));
+    return id;
+}
+
+int Interner::Find(const StringRef &name) const {
+    auto iter = id_map_.find(name);
+    return iter == id_map_.end() ? NO_IDENTIFIER : iter->second;
+}
+
+const string &Interner::Name(int id) const {
+    assert(id >= 0 && id < (int) name_list_.size());
+    return name_list_[id];
+}
+
+int Interner::size() const {
+    return (int) name_list_.size();
+}
\ No newline at end of file
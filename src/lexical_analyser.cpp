@@ -1,13 +1,102 @@
 ﻿#include "lexical_analyser.h"
 
+#include <cstdio>
+#include <cstring>
+#include "scanner.h"
+
 using namespace std;
 
-LexicalAnalyser::LexicalAnalyser(const string &file_name, ErrorHanding *error_handing) {
-    this->testfile_.open(file_name);
-    this->temp_lexeme_ = new Lexeme();
+#define KEYWORD_SLOT    16
+
+// Perfect hash over the 13 keywords: every keyword lands in its own slot, so a
+// lookup is one hash, one length check and one memcmp.
+static constexpr unsigned KeywordHash(const char *str, size_t size) {
+    return (unsigned) (4 * size + (unsigned char) str[0] + 5 * (unsigned char) str[size - 1]) % KEYWORD_SLOT;
+}
+
+struct Keyword {
+    const char *spelling;
+    size_t size;
+    TokenKind kind;
+};
+
+static const Keyword keyword_table[KEYWORD_SLOT] = {
+        {"return", 6, TokenKind::RETURNTK},     // 0
+        {nullptr,  0, TokenKind::IDENFR},
+        {nullptr,  0, TokenKind::IDENFR},
+        {"main",   4, TokenKind::MAINTK},       // 3
+        {"while",  5, TokenKind::WHILETK},      // 4
+        {"scanf",  5, TokenKind::SCANFTK},      // 5
+        {"printf", 6, TokenKind::PRINTFTK},     // 6
+        {"do",     2, TokenKind::DOTK},         // 7
+        {nullptr,  0, TokenKind::IDENFR},
+        {"int",    3, TokenKind::INTTK},        // 9
+        {"void",   4, TokenKind::VOIDTK},       // 10
+        {"const",  5, TokenKind::CONSTTK},      // 11
+        {"for",    3, TokenKind::FORTK},        // 12
+        {"char",   4, TokenKind::CHARTK},       // 13
+        {"else",   4, TokenKind::ELSETK},       // 14
+        {"if",     2, TokenKind::IFTK},         // 15
+};
+
+static_assert(KeywordHash("return", 6) == 0 && KeywordHash("main", 4) == 3 && KeywordHash("while", 5) == 4
+              && KeywordHash("scanf", 5) == 5 && KeywordHash("printf", 6) == 6 && KeywordHash("do", 2) == 7
+              && KeywordHash("int", 3) == 9 && KeywordHash("void", 4) == 10 && KeywordHash("const", 5) == 11
+              && KeywordHash("for", 3) == 12 && KeywordHash("char", 4) == 13 && KeywordHash("else", 4) == 14
+              && KeywordHash("if", 2) == 15, "keyword_table is out of step with KeywordHash");
+
+const char *TokenName(TokenKind kind) {
+    static const char *name_list[] = {
+            "IDENFR", "INTCON", "CHARCON", "STRCON",
+            "CONSTTK", "INTTK", "CHARTK", "VOIDTK", "MAINTK",
+            "IFTK", "ELSETK", "DOTK", "WHILETK", "FORTK",
+            "SCANFTK", "PRINTFTK", "RETURNTK",
+            "PLUS", "MINU", "MULT", "DIV",
+            "LSS", "LEQ", "GRE", "GEQ", "EQL", "NEQ",
+            "ASSIGN", "SEMICN", "COMMA",
+            "LPARENT", "RPARENT", "LBRACK", "RBRACK", "LBRACE", "RBRACE",
+            "END"
+    };
+    return name_list[(int) kind];
+}
+
+LexicalAnalyser::LexicalAnalyser(const string &file_name, Interner *interner, ErrorHanding *error_handing) {
+    this->file_source_.Open(file_name);
+    this->source_ = &file_source_;
+    this->cursor_ = file_source_.data();
+    this->end_ = file_source_.data() + file_source_.size();
+    this->limit_ = end_;
+    this->token_begin_ = cursor_;
+    this->token_end_ = cursor_;
+    this->error_handing_ = error_handing;
+    this->interner_ = interner;
+    this->output_ = nullptr;
+}
+
+LexicalAnalyser::LexicalAnalyser(const SourceBuffer *source, Interner *interner, ErrorHanding *error_handing) {
+    this->source_ = source;
+    this->cursor_ = source->data();
+    this->end_ = source->data() + source->size();
+    this->limit_ = end_;
+    this->token_begin_ = cursor_;
+    this->token_end_ = cursor_;
     this->error_handing_ = error_handing;
-    this->line_number_ = 1;
-    MapInitial();
+    this->interner_ = interner;
+    this->output_ = nullptr;
+}
+
+// Lexes the tokens starting in [begin, limit); the last one may run on past limit.
+LexicalAnalyser::LexicalAnalyser(const SourceBuffer *source, size_t begin, size_t limit, Interner *interner,
+                                 ErrorHanding *error_handing) {
+    this->source_ = source;
+    this->cursor_ = source->data() + begin;
+    this->end_ = source->data() + source->size();
+    this->limit_ = source->data() + limit;
+    this->token_begin_ = cursor_;
+    this->token_end_ = cursor_;
+    this->error_handing_ = error_handing;
+    this->interner_ = interner;
+    this->output_ = nullptr;
 }
 
 bool LexicalAnalyser::IsUnder(char c) {
@@ -43,16 +132,14 @@ bool LexicalAnalyser::IsDoubleQuote(char c) {
 }
 
 bool LexicalAnalyser::IsOpera(char c) {
-    string str;
-    str.clear();
-    str.append(1, c);
-
-    auto iter = opera_map_.find(str);
-
-    if (iter == opera_map_.end()) {
-        return false;
-    } else {
-        return true;
+    switch (c) {
+        case '+': case '-': case '*': case '/':
+        case '<': case '>': case '=':
+        case ';': case ',':
+        case '(': case ')': case '[': case ']': case '{': case '}':
+            return true;
+        default:
+            return false;
     }
 }
 
@@ -70,107 +157,63 @@ bool LexicalAnalyser::IsStringLetter(char c) {
     return false;
 }
 
-bool LexicalAnalyser::CheckKey(struct Lexeme *temp) {
-
-    auto iter = key_map_.find(temp->value);
-
-    if (iter == key_map_.end()) {
-        return false;
-    } else {
-        temp->identifier = iter->second;
-        return true;
-    }
-}
-
-bool LexicalAnalyser::CheckSymbol(struct Lexeme *temp) {
-    auto iter = opera_map_.find(temp->value);
+bool LexicalAnalyser::CheckKey(struct Lexeme &temp) {
+    const Keyword &keyword = keyword_table[KeywordHash(temp.value.data(), temp.value.size())];
 
-    if (iter == opera_map_.end()) {
+    if (keyword.size != temp.value.size() || memcmp(keyword.spelling, temp.value.data(), keyword.size) != 0) {
         return false;
     } else {
-        temp->identifier = iter->second;
+        temp.kind = keyword.kind;
         return true;
     }
 }
 
-void LexicalAnalyser::MapInitial() {
-    key_map_.insert(pair<string, string>("const", CONSTTK));
-    key_map_.insert(pair<string, string>("int", INTTK));
-    key_map_.insert(pair<string, string>("char", CHARTK));
-    key_map_.insert(pair<string, string>("void", VOIDTK));
-    key_map_.insert(pair<string, string>("main", MAINTK));
-    key_map_.insert(pair<string, string>("if", IFTK));
-    key_map_.insert(pair<string, string>("else", ELSETK));
-    key_map_.insert(pair<string, string>("do", DOTK));
-    key_map_.insert(pair<string, string>("while", WHILETK));
-    key_map_.insert(pair<string, string>("for", FORTK));
-    key_map_.insert(pair<string, string>("scanf", SCANFTK));
-    key_map_.insert(pair<string, string>("printf", PRINTFTK));
-    key_map_.insert(pair<string, string>("return", RETURNTK));
-
-    opera_map_.insert(pair<string, string>("+", PLUS));
-    opera_map_.insert(pair<string, string>("-", MINU));
-    opera_map_.insert(pair<string, string>("*", MULT));
-    opera_map_.insert(pair<string, string>("/", DIV));
-    opera_map_.insert(pair<string, string>("<", LSS));
-    opera_map_.insert(pair<string, string>("<=", LEQ));
-    opera_map_.insert(pair<string, string>(">", GRE));
-    opera_map_.insert(pair<string, string>(">=", GEQ));
-    opera_map_.insert(pair<string, string>("=", ASSIGN));
-    opera_map_.insert(pair<string, string>("==", EQL));
-    opera_map_.insert(pair<string, string>("!=", NEQ));
-    opera_map_.insert(pair<string, string>(";", SEMICN));
-    opera_map_.insert(pair<string, string>(",", COMMA));
-    opera_map_.insert(pair<string, string>("(", LPARENT));
-    opera_map_.insert(pair<string, string>(")", RPARENT));
-    opera_map_.insert(pair<string, string>("[", LBRACK));
-    opera_map_.insert(pair<string, string>("]", RBRACK));
-    opera_map_.insert(pair<string, string>("{", LBRACE));
-    opera_map_.insert(pair<string, string>("}", RBRACE));
-}
-
+// Reading past the end yields EOF and still advances, so UngetChar() stays symmetric.
 void LexicalAnalyser::GetChar(char &c) {
-    c = testfile_.get();
+    c = cursor_ < end_ ? *cursor_ : (char) EOF;
+    cursor_++;
 }
 
 void LexicalAnalyser::UngetChar() {
-    testfile_.unget();
+    cursor_--;
 }
 
 void LexicalAnalyser::GoForward(char &c) {
-    while (isspace(c)) {
-        if (c == '\n') {
-            this->line_number_++;
-        }
+    if (isspace(c)) {
+        cursor_ = Scanner::SkipSpace(cursor_, end_);
         GetChar(c);
     }
 }
 
+// line of the character just read, for lexical errors
+int LexicalAnalyser::LineNumber() const {
+    return source_->Line((size_t) (cursor_ - 1 - source_->data()));
+}
+
 void LexicalAnalyser::AddList(struct Lexeme temp) {
-    temp.line_number = this->line_number_;
-    lexeme_list_.push_back(temp);
+    temp.offset = (unsigned) (token_begin_ - source_->data());
+    *output_ = temp;
+    output_ = nullptr;
 }
 
-void LexicalAnalyser::AddList(struct Lexeme temp, const string &identifier) {
-    temp.line_number = this->line_number_;
-    temp.identifier = identifier;
-    lexeme_list_.push_back(temp);
+void LexicalAnalyser::AddList(struct Lexeme temp, TokenKind kind) {
+    temp.kind = kind;
+    this->AddList(temp);
 }
 
 bool LexicalAnalyser::AnalyzeKey(char &c) {
     if (isalpha(c) || IsUnder(c)) {
-        temp_lexeme_ = new Lexeme();
-        do {
-            temp_lexeme_->value.push_back(c);
-            this->GetChar(c);
-        } while (isalpha(c) || this->IsUnder(c) || isdigit(c));
-        this->UngetChar();
+        Lexeme temp;
+        const char *begin = cursor_ - 1;
+        cursor_ = Scanner::SkipIdentifier(cursor_, end_);
+        temp.value = StringRef(begin, cursor_ - begin);
 
-        if (this->CheckKey(temp_lexeme_)) {
-            this->AddList(*temp_lexeme_);
+        if (this->CheckKey(temp)) {
+            this->AddList(temp);
             return true;
         } else {
-            this->AddList(*temp_lexeme_, IDENFR);
+            temp.symbol_id = interner_->Intern(temp.value);
+            this->AddList(temp, TokenKind::IDENFR);
             return true;
         }
     }
@@ -180,35 +223,35 @@ bool LexicalAnalyser::AnalyzeKey(char &c) {
 
 bool LexicalAnalyser::AnalyzeQuote(char &c) {
     if (this->IsSingleQuote(c)) {
-        temp_lexeme_ = new Lexeme();
+        Lexeme temp;
         this->GetChar(c);
         if (!this->IsCharLetter(c)) {
-            error_handing_->AddError(line_number_, ILLEGAL_SYMBOL_OR_LEXICAL_INCONFORMITY);
+            error_handing_->AddError(this->LineNumber(), ILLEGAL_SYMBOL_OR_LEXICAL_INCONFORMITY);
         }
-        temp_lexeme_->value.push_back(c);
+        temp.value = StringRef(cursor_ - 1, cursor_ <= end_ ? 1 : 0);
         this->GetChar(c);
         if (!this->IsSingleQuote(c)) {
             this->UngetChar();
-            error_handing_->AddError(line_number_, ILLEGAL_SYMBOL_OR_LEXICAL_INCONFORMITY);
+            error_handing_->AddError(this->LineNumber(), ILLEGAL_SYMBOL_OR_LEXICAL_INCONFORMITY);
         }
-        this->AddList(*temp_lexeme_, CHARCON);
+        this->AddList(temp, TokenKind::CHARCON);
         return true;
     } else if (this->IsDoubleQuote(c)) {
-        temp_lexeme_ = new Lexeme();
+        Lexeme temp;
+        const char *begin = cursor_;
         while (true) {
+            cursor_ = Scanner::SkipStringLetter(cursor_, end_);
             this->GetChar(c);
-            if (this->IsDoubleQuote(c)) {
+            if (this->IsDoubleQuote(c) || cursor_ > end_) {
                 break;
             }
             if (!this->IsStringLetter(c)) {
-                error_handing_->AddError(line_number_, ILLEGAL_SYMBOL_OR_LEXICAL_INCONFORMITY);
-            }
-            temp_lexeme_->value.push_back(c);
-            if (c == '\\') {
-                temp_lexeme_->value.push_back(c);
+                error_handing_->AddError(this->LineNumber(), ILLEGAL_SYMBOL_OR_LEXICAL_INCONFORMITY);
             }
         }
-        this->AddList(*temp_lexeme_, STRCON);
+        // the raw spelling; backslashes are escaped when the string enters the StringTable
+        temp.value = StringRef(begin, min(cursor_, end_) - begin - (cursor_ <= end_ ? 1 : 0));
+        this->AddList(temp, TokenKind::STRCON);
         return true;
     }
 
@@ -216,61 +259,95 @@ bool LexicalAnalyser::AnalyzeQuote(char &c) {
 }
 
 bool LexicalAnalyser::AnalyzeOpera(char &c) {
-    if (this->IsOpera(c) || c == '!') {
-        temp_lexeme_ = new Lexeme();
-        temp_lexeme_->value.push_back(c);
+    if (!this->IsOpera(c) && c != '!') {
+        return false;
+    }
 
-        if (c == '>' || c == '<' || c == '=') {
+    Lexeme temp;
+    const char *begin = cursor_ - 1;
+    temp.value = StringRef(begin, 1);
+
+    switch (c) {
+        case '+': temp.kind = TokenKind::PLUS; break;
+        case '-': temp.kind = TokenKind::MINU; break;
+        case '*': temp.kind = TokenKind::MULT; break;
+        case '/': temp.kind = TokenKind::DIV; break;
+        case ';': temp.kind = TokenKind::SEMICN; break;
+        case ',': temp.kind = TokenKind::COMMA; break;
+        case '(': temp.kind = TokenKind::LPARENT; break;
+        case ')': temp.kind = TokenKind::RPARENT; break;
+        case '[': temp.kind = TokenKind::LBRACK; break;
+        case ']': temp.kind = TokenKind::RBRACK; break;
+        case '{': temp.kind = TokenKind::LBRACE; break;
+        case '}': temp.kind = TokenKind::RBRACE; break;
+        case '<':
+        case '>':
+        case '=': {
+            char first = c;
             this->GetChar(c);
-            if (this->IsEqu(c)) {
-                temp_lexeme_->value.push_back(c);
+            bool is_equ = this->IsEqu(c);
+            if (is_equ) {
+                temp.value = StringRef(begin, 2);
             } else {
                 this->UngetChar();
             }
-        } else if (c == '!') {
+            if (first == '<') {
+                temp.kind = is_equ ? TokenKind::LEQ : TokenKind::LSS;
+            } else if (first == '>') {
+                temp.kind = is_equ ? TokenKind::GEQ : TokenKind::GRE;
+            } else {
+                temp.kind = is_equ ? TokenKind::EQL : TokenKind::ASSIGN;
+            }
+            break;
+        }
+        default: {    // '!'
             this->GetChar(c);
             if (this->IsEqu(c)) {
-                temp_lexeme_->value.push_back(c);
+                temp.value = StringRef(begin, 2);
             } else {
                 this->UngetChar();
-                temp_lexeme_->value.push_back('=');
-                error_handing_->AddError(line_number_, ILLEGAL_SYMBOL_OR_LEXICAL_INCONFORMITY);
+                temp.value = "!=";
+                error_handing_->AddError(this->LineNumber(), ILLEGAL_SYMBOL_OR_LEXICAL_INCONFORMITY);
             }
-            temp_lexeme_->is_error = true;
-        }
-
-        if (this->CheckSymbol(temp_lexeme_)) {
-            this->AddList(*temp_lexeme_);
-            return true;
+            temp.kind = TokenKind::NEQ;
+            temp.is_error = true;
+            break;
         }
     }
 
-    return false;
+    this->AddList(temp);
+    return true;
 }
 
 bool LexicalAnalyser::AnalyzeDigit(char &c) {
     if (isdigit(c)) {
-        temp_lexeme_ = new Lexeme();
-        do {
-            temp_lexeme_->value.push_back(c);
-            this->GetChar(c);
-        } while (isdigit(c));
-        this->UngetChar();
-        if (temp_lexeme_->value[0] == '0' && temp_lexeme_->value.size() > 1) {
-            error_handing_->AddError(line_number_, ILLEGAL_SYMBOL_OR_LEXICAL_INCONFORMITY);
+        Lexeme temp;
+        const char *begin = cursor_ - 1;
+        cursor_ = Scanner::SkipDigit(cursor_, end_);
+        temp.value = StringRef(begin, cursor_ - begin);
+        if (temp.value[0] == '0' && temp.value.size() > 1) {
+            error_handing_->AddError(this->LineNumber(), ILLEGAL_SYMBOL_OR_LEXICAL_INCONFORMITY);
         }
-        this->AddList(*temp_lexeme_, INTCON);
+        this->AddList(temp, TokenKind::INTCON);
         return true;
     }
 
     return false;
 }
 
-list<struct Lexeme> *LexicalAnalyser::Analyze() {
+// Scans just far enough to produce one token; false once the source is exhausted.
+bool LexicalAnalyser::Next(Lexeme &lexeme) {
     char c;
 
-    while ((c = testfile_.get()) != -1) {
+    output_ = &lexeme;
+    while (output_ != nullptr && cursor_ < end_) {
+        this->GetChar(c);
         this->GoForward(c);
+        token_begin_ = cursor_ - 1;
+        if (token_begin_ >= limit_) {
+            cursor_ = token_begin_;
+            break;
+        }
 
         if (this->AnalyzeKey(c)
             || this->AnalyzeQuote(c)
@@ -280,9 +357,34 @@ list<struct Lexeme> *LexicalAnalyser::Analyze() {
         }
     }
 
+    bool is_token = output_ == nullptr;
+    if (is_token) {
+        token_end_ = cursor_;
+    }
+    output_ = nullptr;
+    return is_token;
+}
+
+unsigned LexicalAnalyser::offset() const {
+    return (unsigned) (min(cursor_, end_) - source_->data());
+}
+
+size_t LexicalAnalyser::token_end() const {
+    return (size_t) (token_end_ - source_->data());
+}
+
+// Lexes the whole source up front, for callers that want every token at once.
+vector<struct Lexeme> *LexicalAnalyser::Analyze() {
+    Lexeme lexeme;
+
+    // sources average about one token per three bytes, so this rarely reallocates
+    lexeme_list_.reserve((end_ - cursor_) / 3 + 16);
+    while (this->Next(lexeme)) {
+        lexeme_list_.push_back(lexeme);
+    }
+
     return &lexeme_list_;
 }
 
 void LexicalAnalyser::FileClose() {
-    testfile_.close();
 }
\ No newline at end of file
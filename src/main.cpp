@@ -1,39 +1,118 @@
-﻿#include <iostream>
-#include "lexical_analyser.h"
-#include "parse_analyser.h"
-#include "mips_generator.h"
+﻿#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include "compiler.h"
+#include "midcode_interpreter.h"
+#include "profiler.h"
 
 
-int main() {
-    const std::string testfile = "file/testfile.txt";
-    const std::string midcode = "file/midcode.txt";
+static void PrintUsage() {
+    std::cerr << "usage: mips_compiler [-O0|-O1|-O2] [--run-midcode] [-ftime-report] [--trace file]" << std::endl
+              << "                     [--syntax-dump file] [--midcode-dump file] [--save-midcode file]" << std::endl
+              << "                     [--load-midcode file] [--lex-jobs n] [--parse-jobs n] [source | -]" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::string testfile = "file/testfile.txt";
     const std::string mips = "file/mips.txt";
     const std::string error = "file/error.txt";
 
-    ErrorHanding error_handing = ErrorHanding(error);
-
-    LexicalAnalyser lexical_analyser = LexicalAnalyser(testfile, &error_handing);
-
-    ParseAnalyser parse_analyser = ParseAnalyser(midcode,
-                                                 lexical_analyser.Analyze(), &error_handing);
-    lexical_analyser.FileClose();
-    parse_analyser.AnalyzeParse();
-    parse_analyser.FileClose();
+    Profiler *profiler = Profiler::GetInstance();
+    bool is_run_midcode = false;
+    bool is_time_report = false;
+    std::string trace_file;
+    std::string syntax_file;
+    std::string midcode_file;
+    std::string save_file;
+    std::string load_file;
+    int optimize_level = 1;
+    int lex_job_count = 0;
+    int parse_job_count = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool is_value_option = argument == "--trace" || argument == "--syntax-dump" || argument == "--midcode-dump"
+                               || argument == "--save-midcode" || argument == "--load-midcode"
+                               || argument == "--lex-jobs" || argument == "--parse-jobs";
+        if (is_value_option && i + 1 == argc) {
+            std::cerr << "mips_compiler: " << argument << " needs an argument" << std::endl;
+            PrintUsage();
+            return 2;
+        }
+        if (argument == "--run-midcode") {
+            is_run_midcode = true;
+        } else if (argument == "-ftime-report") {
+            is_time_report = true;
+            profiler->Enable();
+        } else if (argument == "--trace") {
+            trace_file = argv[++i];
+            profiler->Enable();
+        } else if (argument == "-O0" || argument == "-O1" || argument == "-O2") {
+            optimize_level = argument[2] - '0';
+        } else if (argument == "--syntax-dump") {
+            syntax_file = argv[++i];
+        } else if (argument == "--midcode-dump") {
+            midcode_file = argv[++i];
+        } else if (argument == "--save-midcode") {
+            save_file = argv[++i];
+        } else if (argument == "--load-midcode") {
+            load_file = argv[++i];
+        } else if (argument == "--lex-jobs") {
+            lex_job_count = std::max(1, atoi(argv[++i]));
+        } else if (argument == "--parse-jobs") {
+            parse_job_count = std::max(1, atoi(argv[++i]));
+        } else if (argument == "-" || argument[0] != '-') {
+            testfile = argument;
+        } else {
+            std::cerr << "mips_compiler: unknown option " << argument << std::endl;
+            PrintUsage();
+            return 2;
+        }
+    }
 
-    if (error_handing.IsError()) {
-        error_handing.PrintError();
-        error_handing.FileClose();
-        return 0;
+    Compiler compiler(testfile, midcode_file, error);
+    compiler.set_lex_job_count(lex_job_count);
+    compiler.set_parse_job_count(parse_job_count);
+    compiler.set_syntax_file(syntax_file);
+    int status = 0;
+    bool is_valid = false;     // the backends have a program to run
+    if (!load_file.empty()) {
+        is_valid = compiler.Load(load_file);
+        if (!is_valid) {
+            std::cerr << "cannot load midcode image " << load_file << std::endl;
+            status = 1;
+        }
+    } else if (!compiler.Open()) {
+        std::cerr << "cannot open " << testfile << std::endl;
+        status = 1;
+    } else {
+        is_valid = compiler.Analyze();     // the errors are in file/error.txt, and the run still succeeds
+    }
+    if (is_valid && !save_file.empty() && !compiler.Save(save_file)) {
+        std::cerr << "cannot write " << save_file << std::endl;
+        status = 1;
     }
-    error_handing.FileClose();
 
-    MipsGenerator mips_generator = MipsGenerator(mips, parse_analyser.reg_count(),
-                                                 parse_analyser.string_table(), parse_analyser.check_table(),
-                                                 parse_analyser.symbol_table_map(),
-                                                 parse_analyser.midcode_list());
+    if (is_valid && is_run_midcode) {
+        MidcodeInterpreter midcode_interpreter = MidcodeInterpreter(compiler.string_table(),
+                                                                    compiler.symbol_table_map(),
+                                                                    compiler.frame_layout_map(),
+                                                                    compiler.Optimize(optimize_level));
+        if (!midcode_interpreter.Run(std::cin, std::cout)) {
+            std::cerr << "midcode: " << midcode_interpreter.error() << std::endl;
+            status = 1;
+        }
+    } else if (is_valid) {
+        compiler.GenerateMips(mips, optimize_level);
+    }
 
-    mips_generator.GenerateMips();
-    mips_generator.FileClose();
+    // whatever happened above: a run that stopped at errors is worth profiling too
+    if (is_time_report) {
+        profiler->Report(std::cerr);
+    }
+    if (!trace_file.empty() && !Profiler::WriteTrace(trace_file)) {
+        std::cerr << "cannot write " << trace_file << std::endl;
+        status = 1;
+    }
 
-    return 0;
+    return status;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 ﻿#include "midcode.h"
+#include "table.h"
 
 using namespace std;
 
@@ -103,6 +104,58 @@ void Midcode::Init() {
     temp1_ = 0;
     temp2_ = 0;
     temp_result_ = 0;
+
+    is_bound_ = false;
+    symbol1_ = nullptr;
+    symbol2_ = nullptr;
+    symbol_result_ = nullptr;
+}
+
+// Shifts a string numbered from the start of one function by the strings generated before it,
+// so separately generated functions can be concatenated.
+void Midcode::RebaseString(int string_base) {
+    if (instr_ == MidcodeInstr::PRINTF_STRING) {
+        count_ += string_base;
+    }
+}
+
+static Symbol *FindOperand(CheckTable *check_table, const string &value) {
+    if (value.empty() || !(isalpha(value[0]) || value[0] == '_')) {
+        return nullptr;
+    }
+    return check_table->FindSymbol(value);
+}
+
+// Resolves the operands naming a variable, array or const in the function check_table holds,
+// and a callee among the globals. Once bound, a midcode is not looked up again.
+void Midcode::BindSymbol(CheckTable *check_table) {
+    if (is_bound_) {
+        return;
+    }
+    is_bound_ = true;
+
+    switch (instr_) {
+        case MidcodeInstr::CALL:
+            symbol1_ = check_table->FindSymbol(label_, 0);
+            break;
+        case MidcodeInstr::SCANF_INT:
+        case MidcodeInstr::SCANF_CHAR:
+        case MidcodeInstr::PRINTF_INT:
+        case MidcodeInstr::PRINTF_CHAR:
+        case MidcodeInstr::RETURN:
+        case MidcodeInstr::PARA_INT:
+        case MidcodeInstr::PARA_CHAR:
+            symbol1_ = FindOperand(check_table, label_);
+            break;
+        case MidcodeInstr::PUSH:
+            symbol2_ = FindOperand(check_table, reg2_);
+            break;
+        default:
+            symbol1_ = FindOperand(check_table, reg1_);
+            symbol2_ = FindOperand(check_table, reg2_);
+            symbol_result_ = FindOperand(check_table, reg_result_);
+            break;
+    }
 }
 
 MidcodeInstr Midcode::instr() {
@@ -137,6 +190,18 @@ int Midcode::temp_result() {
     return temp_result_;
 }
 
+Symbol *Midcode::symbol1() {
+    return symbol1_;
+}
+
+Symbol *Midcode::symbol2() {
+    return symbol2_;
+}
+
+Symbol *Midcode::symbol_result() {
+    return symbol_result_;
+}
+
 string Midcode::GetTempReg1() {
     return "#" + to_string(temp1_);
 }
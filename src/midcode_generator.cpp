@@ -16,64 +16,182 @@ void MidcodeGenerator::AddMidcode(Midcode *midcode) {
     this->midcode_list_.push_back(midcode);
 }
 
+// The text form is rendered from the list when the file is closed, so midcode that was
+// generated elsewhere and appended (see ParseAnalyser's function jobs) is written the same way.
 void MidcodeGenerator::FileClose() {
+    if (this->midcode_.is_open()) {
+        for (Midcode *midcode : this->midcode_list_) {
+            this->WriteMidcode(midcode);
+        }
+    }
     this->midcode_.close();
 }
 
-void MidcodeGenerator::PrintParameter(TypeSymbol type, const string &name) {
-    string parameter_type = type == TypeSymbol::INT ? kIntType : kCharType;
-    this->midcode_ << "parameter " + parameter_type + " " + name << endl;
+void MidcodeGenerator::WriteMidcode(Midcode *midcode) {
+    string op;
+    switch (midcode->instr()) {
+        case MidcodeInstr::PARA_INT:
+            midcode_ << "parameter int " << midcode->label() << '\n';
+            break;
+        case MidcodeInstr::PARA_CHAR:
+            midcode_ << "parameter char " << midcode->label() << '\n';
+            break;
+        case MidcodeInstr::VAR_INT:
+            midcode_ << "variable int " << midcode->label() << '\n';
+            break;
+        case MidcodeInstr::VAR_CHAR:
+            midcode_ << "variable char " << midcode->label() << '\n';
+            break;
+        case MidcodeInstr::INT_FUNC_DECLARE:
+            midcode_ << "\nint " << midcode->label() << "()\n";
+            break;
+        case MidcodeInstr::CHAR_FUNC_DECLARE:
+            midcode_ << "\nchar " << midcode->label() << "()\n";
+            break;
+        case MidcodeInstr::VOID_FUNC_DECLARE:
+            midcode_ << "\nvoid " << midcode->label() << "()\n";
+            break;
+        case MidcodeInstr::RETURN:
+            midcode_ << "return " << midcode->label() << '\n';
+            break;
+        case MidcodeInstr::RETURN_NON:
+            midcode_ << "return\n";
+            break;
+        case MidcodeInstr::LABEL:
+            midcode_ << midcode->GetLabel() << ":\n";
+            break;
+        case MidcodeInstr::JUMP:
+            midcode_ << "jump " << midcode->GetJumpLabel() << ":\n";
+            break;
+        case MidcodeInstr::BEZ:
+            midcode_ << "bez " << midcode->reg1() << " Label_:" << midcode->count() << '\n';
+            break;
+        case MidcodeInstr::BNZ:
+            midcode_ << "bnz " << midcode->reg1() << " Label_:" << midcode->count() << '\n';
+            break;
+        case MidcodeInstr::BEQ:
+        case MidcodeInstr::BNE:
+        case MidcodeInstr::BGE:
+        case MidcodeInstr::BLT:
+        case MidcodeInstr::BGT:
+        case MidcodeInstr::BLE: {
+            static const char *judge_list[] = {"bgt", "bge", "blt", "ble", "beq", "bne"};
+            midcode_ << judge_list[(int) midcode->instr() - (int) MidcodeInstr::BGT] << " " << midcode->reg1()
+                     << " " << midcode->reg2() << " " << midcode->GetLabel() << '\n';
+            break;
+        }
+        case MidcodeInstr::PRINTF_STRING:
+            midcode_ << "printf " << midcode->GetString() << '\n';
+            break;
+        case MidcodeInstr::PRINTF_INT:
+            midcode_ << "printf int " << midcode->label() << '\n';
+            break;
+        case MidcodeInstr::PRINTF_CHAR:
+            midcode_ << "printf char " << midcode->label() << '\n';
+            break;
+        case MidcodeInstr::PRINTF_END:
+            midcode_ << "printf_end\n";
+            break;
+        case MidcodeInstr::SCANF_INT:
+            midcode_ << "scanf int " << midcode->label() << '\n';
+            break;
+        case MidcodeInstr::SCANF_CHAR:
+            midcode_ << "scanf char " << midcode->label() << '\n';
+            break;
+        case MidcodeInstr::ASSIGN:
+            midcode_ << midcode->reg_result() << " = " << midcode->reg1() << '\n';
+            break;
+        case MidcodeInstr::ASSIGN_ARRAY:
+            midcode_ << midcode->reg_result() << "[" << midcode->reg1() << "] = " << midcode->reg2() << '\n';
+            break;
+        case MidcodeInstr::LOAD:
+            midcode_ << midcode->GetTempReg() << " = " << midcode->reg1() << '\n';
+            break;
+        case MidcodeInstr::LOAD_ARRAY:
+            midcode_ << midcode->GetTempReg() << " = " << midcode->reg1() << "[" << midcode->reg2() << "]\n";
+            break;
+        case MidcodeInstr::PUSH:
+            midcode_ << "push " << midcode->reg2() << '\n';
+            break;
+        case MidcodeInstr::CALL:
+            midcode_ << "call " << midcode->label() << '\n';
+            break;
+        case MidcodeInstr::SAVE:
+            midcode_ << "save " << midcode->label() << '\n';
+            break;
+        case MidcodeInstr::FUNCTION_END:
+            midcode_ << "function end\n";
+            break;
+        case MidcodeInstr::ASSIGN_RETURN:
+            midcode_ << midcode->GetTempReg() << " = RET\n";
+            break;
+        case MidcodeInstr::NEG:
+            midcode_ << midcode->GetTempReg() << " = -" << midcode->reg1() << '\n';
+            break;
+        case MidcodeInstr::ADD:
+        case MidcodeInstr::SUB:
+        case MidcodeInstr::MUL:
+        case MidcodeInstr::DIV:
+            op = " " + midcodeinstr::GetOperatorString(midcode->instr()) + " ";
+            switch (midcode->opera_member()) {
+                case OperaMember::REG_OP_REG:
+                    midcode_ << midcode->GetTempRegResult() << " = " << midcode->GetTempReg1() << op
+                             << midcode->GetTempReg2() << '\n';
+                    break;
+                case OperaMember::REG_OP_NUMBER:
+                    midcode_ << midcode->GetTempRegResult() << " = " << midcode->GetTempReg1() << op
+                             << midcode->reg2() << '\n';
+                    break;
+                case OperaMember::NUMBER_OP_REG:
+                    midcode_ << midcode->GetTempRegResult() << " = " << midcode->reg2() << op
+                             << midcode->GetTempReg1() << '\n';
+                    break;
+                case OperaMember::NUMBER_OP_NUMBER:    // a for step names its result
+                    midcode_ << (midcode->reg_result().empty() ? midcode->GetTempRegResult() : midcode->reg_result())
+                             << " = " << midcode->reg1() << op << midcode->reg2() << '\n';
+                    break;
+            }
+            break;
+        default:    // LOOP and STEP only mark the loop for the backend
+            break;
+    }
+}
 
+void MidcodeGenerator::PrintParameter(TypeSymbol type, const string &name) {
     MidcodeInstr midcode_instr = type == TypeSymbol::INT
                                  ? MidcodeInstr::PARA_INT : MidcodeInstr::PARA_CHAR;
     this->AddMidcode(new Midcode(midcode_instr, name));
 }
 
 void MidcodeGenerator::PrintVariable(TypeSymbol type, const string &name) {
-    string variable_type = type == TypeSymbol::INT ? kIntType : kCharType;
-    this->midcode_ << "variable " + variable_type + " " + name << endl;
-
     MidcodeInstr midcode_instr = type == TypeSymbol::INT
                                  ? MidcodeInstr::VAR_INT : MidcodeInstr::VAR_CHAR;
     this->AddMidcode(new Midcode(midcode_instr, name));
 }
 
 void MidcodeGenerator::PrintFuncDeclare(Symbol *function) {
-    string type = function->type() == TypeSymbol::INT ? kIntType : kCharType;
-    this->midcode_ << endl << type + " " + function->name() + "()" << endl;
-
     MidcodeInstr midcode_instr = function->type() == TypeSymbol::INT
                                  ? MidcodeInstr::INT_FUNC_DECLARE : MidcodeInstr::CHAR_FUNC_DECLARE;
     this->AddMidcode(new Midcode(midcode_instr, function->name()));
 }
 
 void MidcodeGenerator::PrintVoidFuncDeclare(Symbol *function) {
-    this->midcode_ << endl << "void " + function->name() + "()" << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::VOID_FUNC_DECLARE, function->name()));
 }
 
 void MidcodeGenerator::PrintReturn(bool isVoid, const string &value) {
     if (isVoid) {
-        this->midcode_ << "return" << endl;
-
         this->AddMidcode(new Midcode(MidcodeInstr::RETURN_NON));
     } else {
-        this->midcode_ << "return " + value << endl;
-
         this->AddMidcode(new Midcode(MidcodeInstr::RETURN, value));
     }
 }
 
 void MidcodeGenerator::PrintLabel(int label) {
-    this->midcode_ << "Label_" << label << ":" << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::LABEL, label));
 }
 
 void MidcodeGenerator::PrintJump(int label) {
-    this->midcode_ << "jump Label_" << label << ":" << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::JUMP, label));
 }
 
@@ -82,22 +200,16 @@ void MidcodeGenerator::PrintLoop() {
 }
 
 void MidcodeGenerator::PrintStep(const string &name1, const string &name2, const string &op, int step) {
-    midcode_ << name1 << " = " << name2 << " " + op + " " << step << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::STEP));
     this->AddMidcode(new Midcode(midcodeinstr::GetOperatorInstr(op),
                                  OperaMember::NUMBER_OP_NUMBER, name1, name2, to_string(step)));
 }
 
 void MidcodeGenerator::PrintBez(int label, const string &expression) {
-    this->midcode_ << "bez " << expression << " Label_" << ":" << label << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::BEZ, expression, label));
 }
 
 void MidcodeGenerator::PrintBnz(int label, const string &expression) {
-    this->midcode_ << "bnz " << expression << " Label_" << ":" << label << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::BNZ, expression, label));
 }
 
@@ -110,16 +222,10 @@ void MidcodeGenerator::PrintBezOrBnz(int label, const string &expression, bool i
 }
 
 void MidcodeGenerator::PrintBeq(int label, const string &expression1, const string &expression2) {
-    this->midcode_ << "beq " + expression1
-                   << " " + expression2 << " Label_" << label << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::BEQ, expression1, expression2, label));
 }
 
 void MidcodeGenerator::PrintBne(int label, const string &expression1, const string &expression2) {
-    this->midcode_ << "bne " + expression1
-                   << " " + expression2 << " Label_" << label << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::BNE, expression1, expression2, label));
 }
 
@@ -142,16 +248,10 @@ MidcodeGenerator::PrintBeqOrBne(int label, const string &expression1, const stri
 }
 
 void MidcodeGenerator::PrintBge(int label, const string &expression1, const string &expression2) {
-    this->midcode_ << "bge " + expression1
-                   << " " + expression2 << " Label_" << label << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::BGE, expression1, expression2, label));
 }
 
 void MidcodeGenerator::PrintBlt(int label, const string &expression1, const string &expression2) {
-    this->midcode_ << "blt " + expression1
-                   << " " + expression2 << " Label_" << label << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::BLT, expression1, expression2, label));
 }
 
@@ -174,16 +274,10 @@ MidcodeGenerator::PrintBgeOrBlt(int label, const string &expression1, const stri
 }
 
 void MidcodeGenerator::PrintBgt(int label, const string &expression1, const string &expression2) {
-    this->midcode_ << "bgt " + expression1
-                   << " " + expression2 << " Label_" << label << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::BGT, expression1, expression2, label));
 }
 
 void MidcodeGenerator::PrintBle(int label, const string &expression1, const string &expression2) {
-    this->midcode_ << "ble " + expression1
-                   << " " + expression2 << " Label_" << label << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::BLE, expression1, expression2, label));
 }
 
@@ -206,32 +300,22 @@ MidcodeGenerator::PrintBgtOrBle(int label, const string &expression1, const stri
 }
 
 void MidcodeGenerator::PrintString(int string_number) {
-    midcode_ << "printf str_" << string_number << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::PRINTF_STRING, string_number));
 }
 
 void MidcodeGenerator::PrintInteger(const string &number) {
-    midcode_ << "printf int " + number << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::PRINTF_INT, number));
 }
 
 void MidcodeGenerator::PrintChar(const string &c) {
-    midcode_ << "printf char " + c << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::PRINTF_CHAR, c));
 }
 
 void MidcodeGenerator::PrintEnd() {
-    midcode_ << "printf_end" << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::PRINTF_END));
 }
 
 void MidcodeGenerator::PrintScanf(const string &type, const string &identifier) {
-    midcode_ << "scanf " + type << " " + identifier << endl;
-
     MidcodeInstr midcode_instr = type == "int" ? MidcodeInstr::SCANF_INT : MidcodeInstr::SCANF_CHAR;
 
     this->AddMidcode(new Midcode(midcode_instr, identifier));
@@ -239,90 +323,58 @@ void MidcodeGenerator::PrintScanf(const string &type, const string &identifier)
 
 void MidcodeGenerator::PrintAssignValue(const string &name, const string &array_index, const string &value) {
     if (array_index.empty()) {
-        midcode_ << name + " = " + value << endl;
-
         this->AddMidcode(new Midcode(MidcodeInstr::ASSIGN, name, value));
     } else {
-        midcode_ << name + "[" + array_index + "] = " + value << endl;
-
         this->AddMidcode(new Midcode(MidcodeInstr::ASSIGN_ARRAY, name, array_index, value));
     }
 }
 
 void MidcodeGenerator::PrintLoadToTempReg(const string &name, const string &array_index, int temp_reg_count) {
     if (array_index.empty()) {
-        midcode_ << "#" << temp_reg_count << " = " << name << endl;
-
         this->AddMidcode(new Midcode(MidcodeInstr::LOAD, temp_reg_count, name));
     } else {
-        midcode_ << "#" << temp_reg_count << " = " << name + "[" + array_index + "]" << endl;
-
         this->AddMidcode(new Midcode(MidcodeInstr::LOAD_ARRAY, name, array_index, temp_reg_count));
     }
 }
 
 void MidcodeGenerator::PrintPushParameter(const string &function, const string &value, int count) {
 
-    midcode_ << "push " + value << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::PUSH, function, value, count));
 }
 
 void MidcodeGenerator::PrintCallFunction(const string &name) {
-    midcode_ << "call " + name << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::CALL, name));
 }
 
 void MidcodeGenerator::PrintFuncEnd() {
-    midcode_ << "function end" << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::FUNCTION_END));
 }
 
 void MidcodeGenerator::PrintSave(const string &function_name) {
-    midcode_ << "save " + function_name << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::SAVE, function_name));
 }
 
 void MidcodeGenerator::PrintAssignReturn(int temp_reg_count) {
-    midcode_ << "#" << temp_reg_count << " = RET" << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::ASSIGN_RETURN, temp_reg_count));
 }
 
-void MidcodeGenerator::PrintRegOpReg(int result_reg, int op_reg1, int op_reg2, const string &op) {
-    midcode_ << "#" << result_reg << " = #" << op_reg1 << " " + op + " #" << op_reg2 << endl;
-
-    this->AddMidcode(new Midcode(midcodeinstr::GetOperatorInstr(op),
-                                 OperaMember::REG_OP_REG, result_reg, op_reg1, op_reg2));
-}
-
-void MidcodeGenerator::PrintRegOpNumber(int result_reg, int op_reg, const string &number, const string &op) {
-    midcode_ << "#" << result_reg << " = #" << op_reg << " " + op + " " + number << endl;
-
-    this->AddMidcode(new Midcode(midcodeinstr::GetOperatorInstr(op),
-                                 OperaMember::REG_OP_NUMBER, result_reg, op_reg, number));
-}
-
-void MidcodeGenerator::PrintNumberOpReg(int result_reg, const string &number, int op_reg, const string &op) {
-    midcode_ << "#" << result_reg << " = " + number + " " + op + " #" << op_reg << endl;
-
-    this->AddMidcode(new Midcode(midcodeinstr::GetOperatorInstr(op),
-                                 OperaMember::NUMBER_OP_REG, result_reg, op_reg, number));
-}
-
-void
-MidcodeGenerator::PrintNumberOpNumber(int result_reg, const string &number1, const string &number2, const string &op) {
-    midcode_ << "#" << result_reg << " = " + number1 + " " + op + " " + number2 << endl;
-
-    this->AddMidcode(new Midcode(midcodeinstr::GetOperatorInstr(op),
-                                 OperaMember::NUMBER_OP_NUMBER, result_reg, number1, number2));
+// value1 and value2 are temporaries "#n", names or literals; the operand kinds pick the form.
+void MidcodeGenerator::PrintOperate(int result_reg, const string &value1, const string &value2, const string &op) {
+    MidcodeInstr instr = midcodeinstr::GetOperatorInstr(op);
+    bool is_reg1 = !value1.empty() && value1[0] == '#';
+    bool is_reg2 = !value2.empty() && value2[0] == '#';
+    if (is_reg1 && is_reg2) {
+        this->AddMidcode(new Midcode(instr, OperaMember::REG_OP_REG, result_reg,
+                                     stoi(value1.substr(1)), stoi(value2.substr(1))));
+    } else if (is_reg1) {
+        this->AddMidcode(new Midcode(instr, OperaMember::REG_OP_NUMBER, result_reg, stoi(value1.substr(1)), value2));
+    } else if (is_reg2) {
+        this->AddMidcode(new Midcode(instr, OperaMember::NUMBER_OP_REG, result_reg, stoi(value2.substr(1)), value1));
+    } else {
+        this->AddMidcode(new Midcode(instr, OperaMember::NUMBER_OP_NUMBER, result_reg, value1, value2));
+    }
 }
 
 void MidcodeGenerator::PrintNeg(int result_reg, const string &number) {
-    midcode_ << "#" << result_reg << " = -" + number << endl;
-
     this->AddMidcode(new Midcode(MidcodeInstr::NEG, result_reg, number));
 }
\ No newline at end of file
@@ -0,0 +1,609 @@
+﻿#include "midcode_image.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include "source_buffer.h"
+
+using namespace std;
+
+MidcodeImage::MidcodeImage() {
+    symbol_arena_ = new SymbolArena();
+    string_table_ = new StringTable();
+    check_table_ = nullptr;
+}
+
+MidcodeImage::~MidcodeImage() {
+    for (Midcode *midcode : midcode_list_) {
+        delete midcode;
+    }
+    delete check_table_;
+    for (SymbolTable *symbol_table : symbol_table_list_) {
+        delete symbol_table;
+    }
+    delete string_table_;
+    delete symbol_arena_;
+}
+
+// Accepts only the spelling to_string would give back, so the operand round-trips exactly.
+bool MidcodeImage::ParseInteger(const string &spelling, int &value) {
+    size_t begin = !spelling.empty() && spelling[0] == '-' ? 1 : 0;
+    size_t size = spelling.size() - begin;
+    if (size == 0 || size > 10 || (spelling[begin] == '0' && size > 1)) {
+        return false;
+    }
+    long long number = 0;
+    for (size_t i = begin; i < spelling.size(); i++) {
+        if (!isdigit(spelling[i])) {
+            return false;
+        }
+        number = number * 10 + (spelling[i] - '0');
+    }
+    number = begin == 1 ? -number : number;
+    if (number < INT_MIN || number > INT_MAX || (begin == 1 && number == 0)) {
+        return false;
+    }
+    value = (int) number;
+    return true;
+}
+
+void MidcodeImage::EncodeOperand(const string &spelling, map<string, uint32_t> &text_map,
+                                 vector<string> &text_list, MidcodeRecord &record, int k) {
+    OperandKind kind;
+    int value = 0;
+    if (spelling.empty()) {
+        kind = OperandKind::NONE;
+    } else if (ParseInteger(spelling, value)) {
+        kind = OperandKind::INT;
+    } else if (spelling.size() == 3 && spelling[0] == '\'' && spelling[2] == '\'') {
+        kind = OperandKind::CHAR;
+        value = (unsigned char) spelling[1];
+    } else if (spelling[0] == '#' && spelling[1] != '-' && ParseInteger(spelling.substr(1), value)) {
+        kind = OperandKind::TEMP;
+    } else {
+        auto iter = text_map.find(spelling);
+        if (iter == text_map.end()) {
+            iter = text_map.insert(make_pair(spelling, (uint32_t) text_list.size())).first;
+            text_list.push_back(spelling);
+        }
+        kind = OperandKind::TEXT;
+        value = (int) iter->second;
+    }
+    record.operand_kind[k] = (uint8_t) kind;
+    record.operand[k] = value;
+}
+
+string MidcodeImage::DecodeOperand(const MidcodeRecord &record, int k, const vector<string> &text_list) {
+    int value = record.operand[k];
+    switch ((OperandKind) record.operand_kind[k]) {
+        case OperandKind::INT:
+            return to_string(value);
+        case OperandKind::CHAR:
+            return string("'") + (char) value + "'";
+        case OperandKind::TEMP:
+            return "#" + to_string(value);
+        case OperandKind::TEXT:
+            return text_list[value];
+        default:
+            return "";
+    }
+}
+
+static bool IsFunctionDeclare(MidcodeInstr instr) {
+    return instr == MidcodeInstr::INT_FUNC_DECLARE
+           || instr == MidcodeInstr::CHAR_FUNC_DECLARE
+           || instr == MidcodeInstr::VOID_FUNC_DECLARE;
+}
+
+// What MipsGenerator::GenerateBody handles between a function's declare and its FUNCTION_END.
+static bool IsBodyInstr(MidcodeInstr instr) {
+    switch (instr) {
+        case MidcodeInstr::LOAD:
+        case MidcodeInstr::ADDI:
+        case MidcodeInstr::SUBI:
+        case MidcodeInstr::INT_FUNC_DECLARE:
+        case MidcodeInstr::CHAR_FUNC_DECLARE:
+        case MidcodeInstr::VOID_FUNC_DECLARE:
+        case MidcodeInstr::FUNCTION_END:
+        case MidcodeInstr::CONST_INT:
+        case MidcodeInstr::CONST_CHAR:
+            return false;
+        default:
+            return true;
+    }
+}
+
+template<typename T>
+static void AppendArray(string &payload, const vector<T> &array) {
+    payload.append((const char *) array.data(), array.size() * sizeof(T));
+}
+
+// FNV-1a, as StringRef hashes; enough to tell a damaged image from the one that was written.
+static uint32_t HashPayload(const char *data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ (unsigned char) data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool MidcodeImage::Write(const string &file_name, const Interner *interner, StringTable *string_table,
+                         const map<string, SymbolTable *> &symbol_table_map,
+                         const map<string, FrameLayout> &frame_layout_map,
+                         const list<Midcode *> &midcode_list) {
+    vector<string> text_list;
+    map<string, uint32_t> text_map;
+    for (int id = 0; id < interner->size(); id++) {
+        text_list.push_back(interner->Name(id));
+        text_map.insert(make_pair(interner->Name(id), (uint32_t) id));
+    }
+    auto add_text = [&text_map, &text_list](const string &text) {
+        auto iter = text_map.find(text);
+        if (iter == text_map.end()) {
+            iter = text_map.insert(make_pair(text, (uint32_t) text_list.size())).first;
+            text_list.push_back(text);
+        }
+        return iter->second;
+    };
+
+    vector<uint32_t> string_list;
+    for (int i = 0; i < string_table->GetStringCount(); i++) {
+        string_list.push_back(add_text(string_table->GetString(i)));
+    }
+
+    // the globals' midcode runs up to the first function; a function's, up to the next one
+    vector<string> unit_name_list = {"global"};
+    vector<uint32_t> unit_midcode_begin = {0};
+    vector<MidcodeRecord> midcode_record_list;
+    for (Midcode *midcode : midcode_list) {
+        if (IsFunctionDeclare(midcode->instr_)) {
+            unit_name_list.push_back(midcode->label_);
+            unit_midcode_begin.push_back((uint32_t) midcode_record_list.size());
+        }
+        MidcodeRecord record;
+        memset(&record, 0, sizeof(record));
+        record.instr = (uint8_t) midcode->instr_;
+        record.opera_member = (uint8_t) midcode->opera_member_;
+        record.count = midcode->count_;
+        record.temp1 = midcode->temp1_;
+        record.temp2 = midcode->temp2_;
+        record.temp_result = midcode->temp_result_;
+        EncodeOperand(midcode->label_, text_map, text_list, record, 0);
+        EncodeOperand(midcode->reg1_, text_map, text_list, record, 1);
+        EncodeOperand(midcode->reg2_, text_map, text_list, record, 2);
+        EncodeOperand(midcode->reg_result_, text_map, text_list, record, 3);
+        midcode_record_list.push_back(record);
+    }
+    unit_midcode_begin.push_back((uint32_t) midcode_record_list.size());
+    for (const auto &table : symbol_table_map) {
+        if (find(unit_name_list.begin(), unit_name_list.end(), table.first) == unit_name_list.end()) {
+            unit_name_list.push_back(table.first);
+            unit_midcode_begin.push_back((uint32_t) midcode_record_list.size());
+        }
+    }
+
+    vector<Symbol *> symbol_list;
+    for (const auto &table : symbol_table_map) {
+        symbol_list.insert(symbol_list.end(), table.second->symbol_list().begin(),
+                           table.second->symbol_list().end());
+    }
+    sort(symbol_list.begin(), symbol_list.end(), [](Symbol *symbol_1, Symbol *symbol_2) {
+        return symbol_1->index() < symbol_2->index();
+    });
+    map<Symbol *, uint32_t> symbol_number_map;
+    vector<SymbolRecord> symbol_record_list;
+    vector<uint8_t> parameter_list;
+    for (Symbol *symbol : symbol_list) {
+        symbol_number_map[symbol] = (uint32_t) symbol_record_list.size();
+        SymbolRecord record;
+        memset(&record, 0, sizeof(record));
+        record.id = (uint32_t) symbol->id();
+        record.kind = (uint8_t) symbol->kind();
+        record.type = (uint8_t) symbol->type();
+        record.level = (uint8_t) symbol->level();
+        record.has_const_value = symbol->has_const_value() ? 1 : 0;
+        record.const_value = symbol->const_value();
+        record.array_length = symbol->array_length();
+        record.offset = symbol->offset();
+        record.parameter_begin = (uint32_t) parameter_list.size();
+        record.parameter_count = (uint32_t) symbol->GetParameterCount();
+        for (TypeSymbol type : symbol->parameter_list()) {
+            parameter_list.push_back((uint8_t) type);
+        }
+        symbol_record_list.push_back(record);
+    }
+    while (parameter_list.size() % 4 != 0) {
+        parameter_list.push_back(0);
+    }
+
+    vector<UnitRecord> unit_record_list;
+    vector<uint32_t> unit_symbol_list;
+    for (size_t i = 0; i < unit_name_list.size(); i++) {
+        const string &name = unit_name_list[i];
+        UnitRecord record;
+        memset(&record, 0, sizeof(record));
+        record.name = add_text(name);
+        record.symbol_begin = (uint32_t) unit_symbol_list.size();
+        auto table = symbol_table_map.find(name);
+        if (table != symbol_table_map.end()) {
+            for (Symbol *symbol : table->second->symbol_list()) {
+                unit_symbol_list.push_back(symbol_number_map.at(symbol));
+            }
+        }
+        record.symbol_count = (uint32_t) unit_symbol_list.size() - record.symbol_begin;
+        record.midcode_begin = unit_midcode_begin[i];
+        record.midcode_count = i + 1 < unit_midcode_begin.size() ? unit_midcode_begin[i + 1] - unit_midcode_begin[i] : 0;
+        auto layout = frame_layout_map.find(name);
+        if (layout != frame_layout_map.end()) {
+            record.variable_size = layout->second.variable_size();
+            record.temp_count = layout->second.temp_count();
+        }
+        unit_record_list.push_back(record);
+    }
+
+    vector<TextRecord> text_record_list;
+    string blob;
+    for (const string &text : text_list) {
+        text_record_list.push_back({(uint32_t) blob.size(), (uint32_t) text.size()});
+        blob += text;
+    }
+
+    string payload;
+    AppendArray(payload, text_record_list);
+    AppendArray(payload, string_list);
+    AppendArray(payload, unit_record_list);
+    AppendArray(payload, unit_symbol_list);
+    AppendArray(payload, symbol_record_list);
+    AppendArray(payload, parameter_list);
+    AppendArray(payload, midcode_record_list);
+    payload += blob;
+
+    ImageHeader header;
+    header.magic = MIDCODE_IMAGE_MAGIC;
+    header.version = MIDCODE_IMAGE_VERSION;
+    header.identifier_count = (uint32_t) interner->size();
+    header.text_count = (uint32_t) text_record_list.size();
+    header.string_count = (uint32_t) string_list.size();
+    header.unit_count = (uint32_t) unit_record_list.size();
+    header.unit_symbol_count = (uint32_t) unit_symbol_list.size();
+    header.symbol_count = (uint32_t) symbol_record_list.size();
+    header.parameter_count = (uint32_t) parameter_list.size();
+    header.midcode_count = (uint32_t) midcode_record_list.size();
+    header.blob_size = (uint32_t) blob.size();
+    header.checksum = HashPayload(payload.data(), payload.size());
+
+    ofstream output(file_name, ios::binary);
+    output.write((const char *) &header, sizeof(header));
+    output.write(payload.data(), (streamsize) payload.size());
+    output.close();
+    return !output.fail();
+}
+
+// Hands out the arrays of the image in file order, refusing to run past its end.
+class ImageReader {
+private:
+    const char *data_;
+    size_t size_;
+    size_t position_;
+
+public:
+    ImageReader(const char *data, size_t size) {
+        data_ = data;
+        size_ = size;
+        position_ = 0;
+    }
+
+    template<typename T>
+    bool Read(vector<T> &array, size_t count) {
+        if (count > (size_ - position_) / sizeof(T)) {
+            return false;
+        }
+        array.resize(count);
+        memcpy((void *) array.data(), data_ + position_, count * sizeof(T));
+        position_ += count * sizeof(T);
+        return true;
+    }
+
+    bool IsEnd() const {
+        return position_ == size_;
+    }
+};
+
+// The backends tell a name from a number or a temporary by its first character.
+bool MidcodeImage::IsIdentifier(const string &text) {
+    if (text.empty() || !(isalpha(text[0]) || text[0] == '_')) {
+        return false;
+    }
+    for (char letter : text) {
+        if (!isalnum(letter) && letter != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MidcodeImage::IsTemporaryValid(int temp, const UnitRecord &unit) {
+    return temp >= 0 && temp <= unit.temp_count;
+}
+
+// The backends trust their midcode, so a unit is taken only in the shape the parser gives it: the
+// globals declare variables; a function opens with its own declare, closes with FUNCTION_END and
+// holds in between only what the backends handle, with every temporary inside its frame, every
+// string in the string table and every name among the unit's symbols or the globals.
+// scope_list holds the Scope bits of every identifier.
+bool MidcodeImage::IsUnitValid(const UnitRecord &unit, bool is_global,
+                               const vector<MidcodeRecord> &midcode_record_list,
+                               const vector<uint8_t> &scope_list, uint32_t string_count) {
+    if (unit.variable_size < 0 || unit.temp_count < 0) {
+        return false;
+    }
+    uint32_t begin = unit.midcode_begin;
+    uint32_t end = unit.midcode_begin + unit.midcode_count;
+    for (uint32_t i = begin; i < end; i++) {
+        const MidcodeRecord &record = midcode_record_list[i];
+        if (record.instr > (uint8_t) MidcodeInstr::VAR_CHAR
+            || record.opera_member > (uint8_t) OperaMember::NUMBER_OP_NUMBER) {
+            return false;
+        }
+        auto instr = (MidcodeInstr) record.instr;
+        if (is_global) {
+            if (instr != MidcodeInstr::VAR_INT && instr != MidcodeInstr::VAR_CHAR) {
+                return false;
+            }
+        } else if (i == begin) {
+            if (!IsFunctionDeclare(instr) || record.operand_kind[0] != (uint8_t) OperandKind::TEXT
+                || (uint32_t) record.operand[0] != unit.name || unit.name >= scope_list.size()
+                || (scope_list[unit.name] & GLOBAL_SCOPE) == 0) {
+                return false;
+            }
+        } else if (i == end - 1) {
+            if (instr != MidcodeInstr::FUNCTION_END) {
+                return false;
+            }
+        } else if (!IsBodyInstr(instr)) {
+            return false;
+        }
+
+        switch (instr) {
+            case MidcodeInstr::STEP: {
+                auto next = (MidcodeInstr) midcode_record_list[i + 1].instr;
+                if (next != MidcodeInstr::ADD && next != MidcodeInstr::SUB) {
+                    return false;
+                }
+                break;
+            }
+            case MidcodeInstr::ADD:
+            case MidcodeInstr::SUB:
+            case MidcodeInstr::MUL:
+            case MidcodeInstr::DIV:
+                if (!IsTemporaryValid(record.temp1, unit) || !IsTemporaryValid(record.temp2, unit)
+                    || !IsTemporaryValid(record.temp_result, unit)) {
+                    return false;
+                }
+                break;
+            case MidcodeInstr::ASSIGN_RETURN:
+            case MidcodeInstr::LOAD_ARRAY:
+            case MidcodeInstr::NEG:
+                if (!IsTemporaryValid(record.count, unit)) {
+                    return false;
+                }
+                break;
+            case MidcodeInstr::PRINTF_STRING:
+                if (record.count < 0 || (uint32_t) record.count >= string_count) {
+                    return false;
+                }
+                break;
+            case MidcodeInstr::SCANF_INT:
+            case MidcodeInstr::SCANF_CHAR:
+            case MidcodeInstr::PARA_INT:
+            case MidcodeInstr::PARA_CHAR:
+            case MidcodeInstr::CALL:
+                if (record.operand_kind[0] != (uint8_t) OperandKind::TEXT) {
+                    return false;
+                }
+                break;
+            default:
+                break;
+        }
+
+        for (int k = 0; k < 4; k++) {
+            switch ((OperandKind) record.operand_kind[k]) {
+                case OperandKind::NONE:
+                case OperandKind::INT:
+                case OperandKind::CHAR:
+                    break;
+                case OperandKind::TEMP:
+                    if (!IsTemporaryValid(record.operand[k], unit)) {
+                        return false;
+                    }
+                    break;
+                case OperandKind::TEXT: {
+                    auto id = (uint32_t) record.operand[k];
+                    uint8_t scope = GLOBAL_SCOPE | (instr == MidcodeInstr::CALL ? 0 : LOCAL_SCOPE);
+                    if (id >= scope_list.size() || (scope_list[id] & scope) == 0) {
+                        return false;
+                    }
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+    }
+    return is_global || unit.midcode_count == 0 || unit.midcode_count >= 2;
+}
+
+bool MidcodeImage::Load(const string &file_name, Interner *interner) {
+    SourceBuffer file;
+    if (!file.Open(file_name)) {
+        return false;
+    }
+    ImageReader reader(file.data(), file.size());
+    vector<ImageHeader> header_list;
+    if (!reader.Read(header_list, 1)) {
+        return false;
+    }
+    const ImageHeader &header = header_list[0];
+    if (header.magic != MIDCODE_IMAGE_MAGIC || header.version != MIDCODE_IMAGE_VERSION
+        || header.identifier_count > header.text_count || interner->size() != 0
+        || header.checksum != HashPayload(file.data() + sizeof(ImageHeader), file.size() - sizeof(ImageHeader))) {
+        return false;
+    }
+    vector<TextRecord> text_record_list;
+    vector<uint32_t> string_list;
+    vector<UnitRecord> unit_record_list;
+    vector<uint32_t> unit_symbol_list;
+    vector<SymbolRecord> symbol_record_list;
+    vector<uint8_t> parameter_list;
+    vector<MidcodeRecord> midcode_record_list;
+    vector<char> blob;
+    if (!reader.Read(text_record_list, header.text_count)
+        || !reader.Read(string_list, header.string_count)
+        || !reader.Read(unit_record_list, header.unit_count)
+        || !reader.Read(unit_symbol_list, header.unit_symbol_count)
+        || !reader.Read(symbol_record_list, header.symbol_count)
+        || !reader.Read(parameter_list, header.parameter_count)
+        || !reader.Read(midcode_record_list, header.midcode_count)
+        || !reader.Read(blob, header.blob_size)
+        || !reader.IsEnd()) {
+        return false;
+    }
+
+    vector<string> text_list;
+    for (const TextRecord &record : text_record_list) {
+        if (record.offset > blob.size() || record.size > blob.size() - record.offset) {
+            return false;
+        }
+        text_list.emplace_back(blob.data() + record.offset, record.size);
+    }
+    for (uint32_t id = 0; id < header.identifier_count; id++) {
+        if (!IsIdentifier(text_list[id])) {
+            return false;
+        }
+    }
+    for (uint32_t id = 0; id < header.identifier_count; id++) {
+        if (interner->Intern(StringRef(text_list[id].data(), text_list[id].size())) != (int) id) {
+            return false;    // the same identifier twice
+        }
+    }
+    for (uint32_t text : string_list) {
+        if (text >= text_list.size()) {
+            return false;
+        }
+        string_table_->AddString(text_list[text]);
+    }
+
+    vector<Symbol *> symbol_list;
+    for (const SymbolRecord &record : symbol_record_list) {
+        if (record.id >= header.identifier_count
+            || record.kind > (uint8_t) KindSymbol::PARAMETER || record.type > (uint8_t) TypeSymbol::VOID
+            || record.parameter_begin + (size_t) record.parameter_count > parameter_list.size()) {
+            return false;
+        }
+        for (uint32_t i = 0; i < record.parameter_count; i++) {
+            if (parameter_list[record.parameter_begin + i] > (uint8_t) TypeSymbol::VOID) {
+                return false;
+            }
+        }
+        Symbol *symbol = symbol_arena_->NewSymbol();
+        symbol->SetProperty((int) record.id, &interner->Name((int) record.id),
+                            (KindSymbol) record.kind, (TypeSymbol) record.type);
+        symbol->set_level(record.level);
+        if (record.has_const_value != 0) {
+            symbol->set_const_value(record.const_value);
+        }
+        symbol->set_array_length(record.array_length);
+        symbol->set_offset(record.offset);
+        for (uint32_t i = 0; i < record.parameter_count; i++) {
+            symbol->AddParameter((TypeSymbol) parameter_list[record.parameter_begin + i]);
+        }
+        symbol_list.push_back(symbol);
+    }
+
+    for (uint32_t symbol : unit_symbol_list) {
+        if (symbol >= symbol_list.size()) {
+            return false;
+        }
+    }
+    vector<uint8_t> scope_list(header.identifier_count, 0);
+    for (const UnitRecord &record : unit_record_list) {
+        if (record.name >= text_list.size()
+            || record.symbol_begin + (size_t) record.symbol_count > unit_symbol_list.size()
+            || record.midcode_begin + (size_t) record.midcode_count > midcode_record_list.size()) {
+            return false;
+        }
+        if (text_list[record.name] == "global") {
+            for (uint32_t i = record.symbol_begin; i < record.symbol_begin + record.symbol_count; i++) {
+                scope_list[symbol_list[unit_symbol_list[i]]->id()] |= GLOBAL_SCOPE;
+            }
+        }
+    }
+
+    check_table_ = new CheckTable(interner, symbol_arena_);
+    for (const UnitRecord &record : unit_record_list) {
+        const string &name = text_list[record.name];
+        bool is_global = name == "global";
+        for (uint32_t i = record.symbol_begin; i < record.symbol_begin + record.symbol_count; i++) {
+            scope_list[symbol_list[unit_symbol_list[i]]->id()] |= LOCAL_SCOPE;
+        }
+        bool is_valid = IsUnitValid(record, is_global, midcode_record_list, scope_list, header.string_count);
+        for (uint32_t i = record.symbol_begin; i < record.symbol_begin + record.symbol_count; i++) {
+            scope_list[symbol_list[unit_symbol_list[i]]->id()] &= (uint8_t) ~LOCAL_SCOPE;
+        }
+        if (!is_valid) {
+            return false;
+        }
+
+        auto symbol_table = new SymbolTable();
+        symbol_table_list_.push_back(symbol_table);
+        for (uint32_t i = record.symbol_begin; i < record.symbol_begin + record.symbol_count; i++) {
+            symbol_table->AddSymbol(symbol_list[unit_symbol_list[i]]);
+        }
+        symbol_table_map_[name] = symbol_table;
+        if (name == "global") {
+            check_table_->SetTable(0, symbol_table);
+        } else {
+            check_table_->AddFunctionVariableNumber(name, record.temp_count);
+        }
+        if (name == "global" || record.midcode_count > 0) {
+            frame_layout_map_[name] = FrameLayout(record.variable_size, record.temp_count);
+        }
+
+        for (uint32_t i = record.midcode_begin; i < record.midcode_begin + record.midcode_count; i++) {
+            const MidcodeRecord &midcode_record = midcode_record_list[i];
+            auto midcode = new Midcode((MidcodeInstr) midcode_record.instr);
+            midcode->opera_member_ = (OperaMember) midcode_record.opera_member;
+            midcode->count_ = midcode_record.count;
+            midcode->temp1_ = midcode_record.temp1;
+            midcode->temp2_ = midcode_record.temp2;
+            midcode->temp_result_ = midcode_record.temp_result;
+            midcode->label_ = DecodeOperand(midcode_record, 0, text_list);
+            midcode->reg1_ = DecodeOperand(midcode_record, 1, text_list);
+            midcode->reg2_ = DecodeOperand(midcode_record, 2, text_list);
+            midcode->reg_result_ = DecodeOperand(midcode_record, 3, text_list);
+            midcode_list_.push_back(midcode);
+        }
+    }
+    return symbol_table_map_.count("global") > 0;
+}
+
+StringTable *MidcodeImage::string_table() {
+    return string_table_;
+}
+
+CheckTable *MidcodeImage::check_table() {
+    return check_table_;
+}
+
+const map<string, SymbolTable *> &MidcodeImage::symbol_table_map() const {
+    return symbol_table_map_;
+}
+
+const map<string, FrameLayout> &MidcodeImage::frame_layout_map() const {
+    return frame_layout_map_;
+}
+
+const list<Midcode *> &MidcodeImage::midcode_list() const {
+    return midcode_list_;
+}
\ No newline at end of file
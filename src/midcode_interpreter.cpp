@@ -0,0 +1,501 @@
+﻿#include "midcode_interpreter.h"
+
+#include <utility>
+
+using namespace std;
+
+MidcodeInterpreter::MidcodeInterpreter(StringTable *string_table,
+                                       map<string, SymbolTable *> symbol_table_map,
+                                       map<string, FrameLayout> frame_layout_map,
+                                       list<Midcode *> midcode_list) {
+    string_table_ = string_table;
+    symbol_table_map_ = std::move(symbol_table_map);
+    frame_layout_map_ = std::move(frame_layout_map);
+    midcode_list_ = std::move(midcode_list);
+
+    step_limit_ = 0;
+    step_count_ = 0;
+    return_value_ = 0;
+    base_ = 0;
+}
+
+bool MidcodeInterpreter::IsInteger(const string &str) {
+    if (str.empty()) {
+        return false;
+    }
+    for (char i : str) {
+        if (!isdigit(i) && i != '+' && i != '-') {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MidcodeInterpreter::IsChar(const string &str) {
+    return str[0] == '\'';
+}
+
+bool MidcodeInterpreter::IsTemporary(const string &str) {
+    return str[0] == '#' && isdigit(str[1]);
+}
+
+string MidcodeInterpreter::UnescapeString(const string &str) {
+    string result;
+    for (size_t i = 0; i < str.length(); i++) {
+        result.push_back(str[i]);
+        if (str[i] == '\\' && i + 1 < str.length() && str[i + 1] == '\\') {
+            i++;
+        }
+    }
+    return result;
+}
+
+// Slots are words at the offsets the FrameLayout gave the variables; temporaries follow.
+int MidcodeInterpreter::LayoutTable(const string &name, map<string, Slot> &slot_map, OperandType type) {
+    slot_map.clear();
+    for (Symbol *symbol : symbol_table_map_.at(name)->symbol_list()) {
+        Slot slot = {{type, symbol->offset() / 4}, 0};
+
+        switch (symbol->kind()) {
+            case KindSymbol::ARRAY:
+                slot.length = symbol->array_length();
+                break;
+            case KindSymbol::VARIABLE:
+            case KindSymbol::PARAMETER:
+                break;
+            default:
+                continue;
+        }
+        slot_map.insert(pair<string, Slot>(symbol->name(), slot));
+    }
+    return frame_layout_map_.at(name).variable_size() / 4;
+}
+
+MidcodeInterpreter::Slot MidcodeInterpreter::DecodeName(const string &name) {
+    auto iter = local_map_.find(name);
+    if (iter != local_map_.end()) {
+        return iter->second;
+    }
+    iter = global_map_.find(name);
+    if (iter != global_map_.end()) {
+        return iter->second;
+    }
+    error_ = "undefined identifier " + name;
+    return {{OperandType::NONE, 0}, 0};
+}
+
+MidcodeInterpreter::Operand MidcodeInterpreter::DecodeOperand(const string &value, int &frame_size) {
+    if (IsInteger(value)) {
+        return {OperandType::IMMEDIATE, stoi(value)};
+    } else if (IsChar(value)) {
+        return {OperandType::IMMEDIATE, (int) value[1]};
+    } else if (IsTemporary(value)) {
+        auto iter = local_map_.find(value);
+        if (iter == local_map_.end()) {
+            Slot slot = {{OperandType::LOCAL, frame_size++}, 0};
+            iter = local_map_.insert(pair<string, Slot>(value, slot)).first;
+        }
+        return iter->second.operand;
+    } else {
+        return DecodeName(value).operand;
+    }
+}
+
+void MidcodeInterpreter::DecodeFunction(list<Midcode *>::iterator &iter) {
+    Function function;
+    function.name = (*iter)->label();
+    function.entry = code_.size();
+    function.frame_size = LayoutTable(function.name, local_map_, OperandType::LOCAL);
+    label_map_.clear();
+
+    int &frame_size = function.frame_size;
+    vector<pair<int, int>> jump_list;
+    iter++;
+
+    while (iter != midcode_list_.end()) {
+        Midcode *midcode = *iter;
+        Instruction instruction = {midcode->instr(), {OperandType::NONE, 0},
+                                   {OperandType::NONE, 0}, {OperandType::NONE, 0}, 0};
+
+        switch (midcode->instr()) {
+            case MidcodeInstr::SCANF_INT:
+            case MidcodeInstr::SCANF_CHAR:
+                instruction.result = DecodeOperand(midcode->label(), frame_size);
+                break;
+            case MidcodeInstr::PRINTF_INT:
+            case MidcodeInstr::PRINTF_CHAR:
+            case MidcodeInstr::RETURN:
+                instruction.operand1 = DecodeOperand(midcode->label(), frame_size);
+                break;
+            case MidcodeInstr::PRINTF_STRING:
+                instruction.target = midcode->count();
+                break;
+            case MidcodeInstr::LABEL:
+                label_map_[midcode->count()] = code_.size();
+                iter++;
+                continue;
+            case MidcodeInstr::JUMP:
+                jump_list.emplace_back(code_.size(), midcode->count());
+                break;
+            case MidcodeInstr::ASSIGN:
+                instruction.result = DecodeOperand(midcode->reg_result(), frame_size);
+                instruction.operand1 = DecodeOperand(midcode->reg1(), frame_size);
+                break;
+            case MidcodeInstr::ASSIGN_ARRAY: {
+                Slot array = DecodeName(midcode->reg_result());
+                instruction.result = array.operand;
+                instruction.target = array.length;
+                instruction.operand1 = DecodeOperand(midcode->reg1(), frame_size);
+                instruction.operand2 = DecodeOperand(midcode->reg2(), frame_size);
+                break;
+            }
+            case MidcodeInstr::ASSIGN_RETURN:
+                instruction.result = DecodeOperand(midcode->GetTempReg(), frame_size);
+                break;
+            case MidcodeInstr::LOAD:
+                instruction.result = DecodeOperand(midcode->GetTempReg(), frame_size);
+                instruction.operand1 = DecodeOperand(midcode->reg1(), frame_size);
+                break;
+            case MidcodeInstr::LOAD_ARRAY: {
+                Slot array = DecodeName(midcode->reg1());
+                instruction.result = DecodeOperand(midcode->GetTempReg(), frame_size);
+                instruction.operand1 = array.operand;
+                instruction.target = array.length;
+                instruction.operand2 = DecodeOperand(midcode->reg2(), frame_size);
+                break;
+            }
+            case MidcodeInstr::ADD:
+            case MidcodeInstr::SUB:
+            case MidcodeInstr::MUL:
+            case MidcodeInstr::DIV:
+                instruction.result = midcode->reg_result().empty()
+                                     ? DecodeOperand(midcode->GetTempRegResult(), frame_size)
+                                     : DecodeOperand(midcode->reg_result(), frame_size);
+                switch (midcode->opera_member()) {
+                    case OperaMember::REG_OP_REG:
+                        instruction.operand1 = DecodeOperand(midcode->GetTempReg1(), frame_size);
+                        instruction.operand2 = DecodeOperand(midcode->GetTempReg2(), frame_size);
+                        break;
+                    case OperaMember::REG_OP_NUMBER:
+                        instruction.operand1 = DecodeOperand(midcode->GetTempReg1(), frame_size);
+                        instruction.operand2 = DecodeOperand(midcode->reg2(), frame_size);
+                        break;
+                    case OperaMember::NUMBER_OP_REG:
+                        instruction.operand1 = DecodeOperand(midcode->reg2(), frame_size);
+                        instruction.operand2 = DecodeOperand(midcode->GetTempReg1(), frame_size);
+                        break;
+                    case OperaMember::NUMBER_OP_NUMBER:
+                        instruction.operand1 = DecodeOperand(midcode->reg1(), frame_size);
+                        instruction.operand2 = DecodeOperand(midcode->reg2(), frame_size);
+                        break;
+                }
+                break;
+            case MidcodeInstr::NEG:
+                instruction.result = DecodeOperand(midcode->GetTempReg(), frame_size);
+                instruction.operand1 = DecodeOperand(midcode->reg1(), frame_size);
+                break;
+            case MidcodeInstr::BGT:
+            case MidcodeInstr::BGE:
+            case MidcodeInstr::BLT:
+            case MidcodeInstr::BLE:
+            case MidcodeInstr::BEQ:
+            case MidcodeInstr::BNE:
+                instruction.operand2 = DecodeOperand(midcode->reg2(), frame_size);
+                // fall through
+            case MidcodeInstr::BEZ:
+            case MidcodeInstr::BNZ:
+                instruction.operand1 = DecodeOperand(midcode->reg1(), frame_size);
+                jump_list.emplace_back(code_.size(), midcode->count());
+                break;
+            case MidcodeInstr::PUSH:
+                instruction.operand1 = DecodeOperand(midcode->reg2(), frame_size);
+                break;
+            case MidcodeInstr::CALL:
+                call_list_.emplace_back(code_.size(), midcode->label());
+                break;
+            case MidcodeInstr::PARA_INT:
+            case MidcodeInstr::PARA_CHAR:
+                function.parameter_slot.push_back(DecodeOperand(midcode->label(), frame_size).value);
+                iter++;
+                continue;
+            case MidcodeInstr::FUNCTION_END:
+            case MidcodeInstr::RETURN_NON:
+            case MidcodeInstr::PRINTF_END:
+                break;
+            default:
+                iter++;
+                continue;
+        }
+
+        code_.push_back(instruction);
+        if (midcode->instr() == MidcodeInstr::FUNCTION_END) {
+            iter++;
+            break;
+        }
+        iter++;
+    }
+
+    for (auto &jump : jump_list) {
+        auto label = label_map_.find(jump.second);
+        if (label == label_map_.end()) {
+            error_ = "undefined label " + to_string(jump.second) + " in " + function.name;
+        } else {
+            code_[jump.first].target = label->second;
+        }
+    }
+
+    function_index_map_[function.name] = function_list_.size();
+    function_list_.push_back(function);
+}
+
+void MidcodeInterpreter::Decode() {
+    global_.assign(LayoutTable("global", global_map_, OperandType::GLOBAL), 0);
+    for (int i = 0; i < string_table_->GetStringCount(); i++) {
+        string_list_.push_back(UnescapeString(string_table_->GetString(i)));
+    }
+
+    auto iter = midcode_list_.begin();
+    while (iter != midcode_list_.end()) {
+        switch ((*iter)->instr()) {
+            case MidcodeInstr::INT_FUNC_DECLARE:
+            case MidcodeInstr::CHAR_FUNC_DECLARE:
+            case MidcodeInstr::VOID_FUNC_DECLARE:
+                DecodeFunction(iter);
+                break;
+            default:
+                iter++;
+                break;
+        }
+    }
+
+    for (auto &call : call_list_) {
+        auto function = function_index_map_.find(call.second);
+        if (function == function_index_map_.end()) {
+            error_ = "undefined function " + call.second;
+        } else {
+            code_[call.first].target = function->second;
+        }
+    }
+    if (function_index_map_.find("main") == function_index_map_.end()) {
+        error_ = "undefined function main";
+    }
+}
+
+int &MidcodeInterpreter::Access(const Operand &operand) {
+    return operand.type == OperandType::GLOBAL ? global_[operand.value] : stack_[base_ + operand.value];
+}
+
+int MidcodeInterpreter::Read(const Operand &operand) {
+    return operand.type == OperandType::IMMEDIATE ? operand.value : Access(operand);
+}
+
+int *MidcodeInterpreter::Element(const Operand &array, int length, int index) {
+    if (index < 0 || index >= length) {
+        Trap("array index " + to_string(index) + " out of range");
+        return nullptr;
+    }
+    return &Access(array) + index;
+}
+
+bool MidcodeInterpreter::Trap(const string &error) {
+    error_ = error;
+    return false;
+}
+
+bool MidcodeInterpreter::Call(int function, int return_pc, int &pc) {
+    if (frame_list_.size() >= MAX_CALL_DEPTH) {
+        return Trap("call depth exceeded");
+    }
+
+    Function &callee = function_list_[function];
+    int base = stack_.size();
+    stack_.resize(base + callee.frame_size, 0);
+
+    int parameter_count = callee.parameter_slot.size();
+    int parameter_base = parameter_stack_.size() - parameter_count;
+    for (int i = 0; i < parameter_count; i++) {
+        stack_[base + callee.parameter_slot[i]] = parameter_stack_[parameter_base + i];
+    }
+    parameter_stack_.resize(parameter_base);
+
+    frame_list_.push_back({function, return_pc, base});
+    base_ = base;
+    pc = callee.entry;
+    return true;
+}
+
+bool MidcodeInterpreter::Execute(istream &input, ostream &output) {
+    int pc = 0;
+    int value;
+    int *element;
+
+    if (!Call(function_index_map_.at("main"), -1, pc)) {
+        return false;
+    }
+
+    while (true) {
+        const Instruction &instruction = code_[pc++];
+
+        if (++step_count_ > step_limit_ && step_limit_ > 0) {
+            return Trap("step limit exceeded");
+        }
+
+        switch (instruction.instr) {
+            case MidcodeInstr::SCANF_INT:
+                input >> value;
+                Access(instruction.result) = input ? value : 0;
+                break;
+            case MidcodeInstr::SCANF_CHAR: {
+                char c;
+                input >> c;
+                Access(instruction.result) = input ? (int) c : 0;
+                break;
+            }
+            case MidcodeInstr::PRINTF_INT:
+                output << Read(instruction.operand1);
+                break;
+            case MidcodeInstr::PRINTF_CHAR:
+                output << (char) Read(instruction.operand1);
+                break;
+            case MidcodeInstr::PRINTF_STRING:
+                output << string_list_[instruction.target];
+                break;
+            case MidcodeInstr::PRINTF_END:
+                output << '\n';
+                break;
+            case MidcodeInstr::JUMP:
+                pc = instruction.target;
+                break;
+            case MidcodeInstr::ASSIGN:
+            case MidcodeInstr::LOAD:
+                Access(instruction.result) = Read(instruction.operand1);
+                break;
+            case MidcodeInstr::ASSIGN_ARRAY:
+                element = Element(instruction.result, instruction.target, Read(instruction.operand1));
+                if (element == nullptr) {
+                    return false;
+                }
+                *element = Read(instruction.operand2);
+                break;
+            case MidcodeInstr::ASSIGN_RETURN:
+                Access(instruction.result) = return_value_;
+                break;
+            case MidcodeInstr::LOAD_ARRAY:
+                element = Element(instruction.operand1, instruction.target, Read(instruction.operand2));
+                if (element == nullptr) {
+                    return false;
+                }
+                Access(instruction.result) = *element;
+                break;
+            case MidcodeInstr::ADD:
+                Access(instruction.result) = (int) ((unsigned) Read(instruction.operand1)
+                                                  + (unsigned) Read(instruction.operand2));
+                break;
+            case MidcodeInstr::SUB:
+                Access(instruction.result) = (int) ((unsigned) Read(instruction.operand1)
+                                                  - (unsigned) Read(instruction.operand2));
+                break;
+            case MidcodeInstr::MUL:
+                Access(instruction.result) = (int) ((unsigned) Read(instruction.operand1)
+                                                  * (unsigned) Read(instruction.operand2));
+                break;
+            case MidcodeInstr::DIV:
+                value = Read(instruction.operand2);
+                if (value == 0) {
+                    return Trap("division by zero");
+                }
+                Access(instruction.result) = value == -1
+                                           ? (int) (0u - (unsigned) Read(instruction.operand1))
+                                           : Read(instruction.operand1) / value;
+                break;
+            case MidcodeInstr::NEG:
+                Access(instruction.result) = (int) (0u - (unsigned) Read(instruction.operand1));
+                break;
+            case MidcodeInstr::BGT:
+                if (Read(instruction.operand1) > Read(instruction.operand2)) {
+                    pc = instruction.target;
+                }
+                break;
+            case MidcodeInstr::BGE:
+                if (Read(instruction.operand1) >= Read(instruction.operand2)) {
+                    pc = instruction.target;
+                }
+                break;
+            case MidcodeInstr::BLT:
+                if (Read(instruction.operand1) < Read(instruction.operand2)) {
+                    pc = instruction.target;
+                }
+                break;
+            case MidcodeInstr::BLE:
+                if (Read(instruction.operand1) <= Read(instruction.operand2)) {
+                    pc = instruction.target;
+                }
+                break;
+            case MidcodeInstr::BEQ:
+                if (Read(instruction.operand1) == Read(instruction.operand2)) {
+                    pc = instruction.target;
+                }
+                break;
+            case MidcodeInstr::BNE:
+                if (Read(instruction.operand1) != Read(instruction.operand2)) {
+                    pc = instruction.target;
+                }
+                break;
+            case MidcodeInstr::BEZ:
+                if (Read(instruction.operand1) == 0) {
+                    pc = instruction.target;
+                }
+                break;
+            case MidcodeInstr::BNZ:
+                if (Read(instruction.operand1) != 0) {
+                    pc = instruction.target;
+                }
+                break;
+            case MidcodeInstr::PUSH:
+                parameter_stack_.push_back(Read(instruction.operand1));
+                break;
+            case MidcodeInstr::CALL:
+                if (!Call(instruction.target, pc, pc)) {
+                    return false;
+                }
+                break;
+            case MidcodeInstr::RETURN:
+                return_value_ = Read(instruction.operand1);
+                // fall through
+            case MidcodeInstr::RETURN_NON:
+            case MidcodeInstr::FUNCTION_END: {
+                Frame frame = frame_list_.back();
+                frame_list_.pop_back();
+                stack_.resize(frame.base);
+                if (frame_list_.empty()) {
+                    return true;
+                }
+                base_ = frame_list_.back().base;
+                pc = frame.return_pc;
+                break;
+            }
+            default:
+                return Trap("unexpected midcode");
+        }
+    }
+}
+
+void MidcodeInterpreter::set_step_limit(long long step_limit) {
+    step_limit_ = step_limit;
+}
+
+bool MidcodeInterpreter::Run(istream &input, ostream &output) {
+    Decode();
+    if (!error_.empty()) {
+        return false;
+    }
+    return Execute(input, output);
+}
+
+long long MidcodeInterpreter::step_count() const {
+    return step_count_;
+}
+
+string MidcodeInterpreter::error() const {
+    return error_;
+}
\ No newline at end of file
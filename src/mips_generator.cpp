@@ -1,23 +1,28 @@
 ﻿#include "mips_generator.h"
 
+#include <climits>
 #include <utility>
+#include "profiler.h"
 
 using namespace std;
 
-MipsGenerator::MipsGenerator(const string &outputFileName, int temp_count,
+MipsGenerator::MipsGenerator(const string &outputFileName,
                              StringTable *stringTable, CheckTable *check_table,
-                             map<string, SymbolTable *> symbolTableMap, list<Midcode *> midcode_list) {
+                             map<string, SymbolTable *> symbolTableMap,
+                             map<string, FrameLayout> frame_layout_map, list<Midcode *> midcode_list,
+                             int optimize_level) {
 
     objcode_ = new Objcode(outputFileName);
 
     string_table_ = stringTable;
     check_table_ = check_table;
     symbol_table_map_ = std::move(symbolTableMap);
+    frame_layout_map_ = std::move(frame_layout_map);
     midcode_list_ = std::move(midcode_list);
 
-    temp_count_ = temp_count;
-    dm_offset_ = 0;
-    temp_offset_ = 0;
+    optimize_level_ = optimize_level;
+    frame_layout_ = nullptr;
+    function_ = nullptr;
 }
 
 void MipsGenerator::LoadTable(int level, const string &name) {
@@ -36,37 +41,10 @@ void MipsGenerator::InitConstString() {
     }
 }
 
-void MipsGenerator::InitVariable(const string &function) {
-    auto table = symbol_table_map_.at(function)->symbol_map();
-    auto iter = table.begin();
-
-    dm_offset_ = 0;
-    while (iter != table.end()) {
-        if (iter->second->kind() == KindSymbol::ARRAY) {
-            iter->second->set_offset(dm_offset_);
-            dm_offset_ += 4 * iter->second->array_length();
-        } else if (iter->second->kind() == KindSymbol::VARIABLE
-                   || iter->second->kind() == KindSymbol::PARAMETER) {
-            iter->second->set_offset(dm_offset_);
-            dm_offset_ += 4;
-        }
-        iter++;
-    }
-    function_offset_map_.insert(pair<string, int>(function, dm_offset_));
-    temp_offset_ = dm_offset_;
-}
-
+// The variables already have their offsets (FrameLayout); the globals sit at the stack base.
 void MipsGenerator::InitData() {
-
-    auto iter = symbol_table_map_.begin();
-    while (iter != symbol_table_map_.end()) {
-        InitVariable(iter->first);
-        iter++;
-    }
-
     objcode_->Output(MipsInstr::data);
     LoadTable(0, "global");
-    InitVariable("global");
     InitConstString();
 
     objcode_->Output(MipsInstr::data_align, 4);
@@ -86,7 +64,7 @@ void MipsGenerator::InitStack() {
     objcode_->Output(MipsInstr::la, FUNC_POINT, FUNC_SPACE);
     objcode_->Output(MipsInstr::la, RA_POINT, RA_SPACE);
     objcode_->Output(MipsInstr::la, PARA_POINT, PARA_SPACE);
-    objcode_->Output(MipsInstr::addi, FUNC_POINT, FUNC_POINT, dm_offset_);
+    objcode_->Output(MipsInstr::addi, FUNC_POINT, FUNC_POINT, frame_layout_map_.at("global").variable_size());
     objcode_->Output();
 }
 
@@ -99,24 +77,20 @@ void MipsGenerator::InitText() {
     objcode_->Output(MipsInstr::syscall);
 }
 
-void MipsGenerator::SaveVariable(const string &name, Reg reg) {
-
-    int offset = check_table_->FindSymbol(name)->offset();
-
-    if (check_table_->GetSymbolLevel(name) == 0) {
-        objcode_->Output(MipsInstr::sw, reg, GLOBAL_POINT, offset);
+void MipsGenerator::SaveVariable(Symbol *symbol, Reg reg) {
+    if (symbol->level() == 0) {
+        objcode_->Output(MipsInstr::sw, reg, GLOBAL_POINT, symbol->offset());
     } else {
-        objcode_->Output(MipsInstr::sw, reg, FUNC_POINT, offset);
+        objcode_->Output(MipsInstr::sw, reg, FUNC_POINT, symbol->offset());
     }
 }
 
-void MipsGenerator::LoadVariable(const string &name, Reg reg) {
-    int offset = check_table_->FindSymbol(name)->offset();
-
-    if (check_table_->GetSymbolLevel(name) == 0) {
-        objcode_->Output(MipsInstr::lw, reg, GLOBAL_POINT, offset);
+void MipsGenerator::LoadVariable(Symbol *symbol, Reg reg) {
+    assert(symbol->kind() != KindSymbol::CONST);    // the parser emits consts as immediates
+    if (symbol->level() == 0) {
+        objcode_->Output(MipsInstr::lw, reg, GLOBAL_POINT, symbol->offset());
     } else {
-        objcode_->Output(MipsInstr::lw, reg, FUNC_POINT, offset);
+        objcode_->Output(MipsInstr::lw, reg, FUNC_POINT, symbol->offset());
     }
 }
 
@@ -137,64 +111,39 @@ bool MipsGenerator::IsTemporary(const string &str) {
     return str[0] == '#' && isdigit(str[1]);
 }
 
-void MipsGenerator::LoadValue(const string &value, Reg reg) {
+// symbol is the operand's cached symbol (Midcode::BindSymbol), nullptr unless value is a name.
+void MipsGenerator::LoadValue(const string &value, Symbol *symbol, Reg reg) {
     if (IsInteger(value)) {
         objcode_->Output(MipsInstr::li, reg, stoi(value));
     } else if (IsChar(value)) {
         objcode_->Output(MipsInstr::li, reg, (int) value[1]);
     } else if (IsTemporary(value)) {
         LoadTemporary(value, reg);
-    } else if (IsConstVariable(value)) {
-        objcode_->Output(MipsInstr::li, reg, GetConstVariable(value));
     } else {
-        LoadVariable(value, reg);
-    }
-}
-
-void MipsGenerator::SaveTemporary(const string &name, Reg reg) {
-    if (temporary_offset_map_.find(name) == temporary_offset_map_.end()) {
-        temp_offset_ += 4;
-        temporary_offset_map_.insert(pair<string, int>(name, temp_offset_));
+        LoadVariable(symbol, reg);
     }
-
-    int offset = temporary_offset_map_.at(name);
-    objcode_->Output(MipsInstr::sw, reg, FUNC_POINT, offset);
 }
 
-void MipsGenerator::LoadTemporary(const string &name, Reg reg) {
-    if (temporary_offset_map_.find(name) == temporary_offset_map_.end()) {
-        temp_offset_ += 4;
-        temporary_offset_map_.insert(pair<string, int>(name, temp_offset_));
-    }
-
-    int offset = temporary_offset_map_.at(name);
-    objcode_->Output(MipsInstr::lw, reg, FUNC_POINT, offset);
+// Temporaries are numbered from 1 in each function, so #n has a fixed slot after the locals.
+int MipsGenerator::GetTemporaryOffset(const string &name) {
+    int offset = frame_layout_->variable_size() + 4 * stoi(name.substr(1));
+    assert(offset < frame_layout_->frame_size());
+    return offset;
 }
 
-bool MipsGenerator::IsConstVariable(const string &name) {
-    Symbol *symbol = check_table_->FindSymbol(name);
-    if (symbol != nullptr && symbol->kind() == KindSymbol::CONST) {
-        return true;
-    } else {
-        return false;
-    }
+void MipsGenerator::SaveTemporary(const string &name, Reg reg) {
+    objcode_->Output(MipsInstr::sw, reg, FUNC_POINT, GetTemporaryOffset(name));
 }
 
-int MipsGenerator::GetConstVariable(const string &name) {
-    Symbol *symbol = check_table_->FindSymbol(name);
-
-    if (symbol->type() == TypeSymbol::INT) {
-        return stoi(symbol->const_value());
-    } else {
-        return symbol->const_value()[1];
-    }
+void MipsGenerator::LoadTemporary(const string &name, Reg reg) {
+    objcode_->Output(MipsInstr::lw, reg, FUNC_POINT, GetTemporaryOffset(name));
 }
 
-void MipsGenerator::GenerateScanf(const string &variable_name, int type) {
+void MipsGenerator::GenerateScanf(Symbol *variable, int type) {
     objcode_->Output(MipsInstr::li, Reg::v0, type);
     objcode_->Output(MipsInstr::syscall);
 
-    SaveVariable(variable_name, Reg::v0);
+    SaveVariable(variable, Reg::v0);
 }
 
 void MipsGenerator::GeneratePrintfIntChar(Midcode *midcode, int type) {
@@ -202,13 +151,11 @@ void MipsGenerator::GeneratePrintfIntChar(Midcode *midcode, int type) {
     if (IsInteger(value)) {
         objcode_->Output(MipsInstr::li, Reg::a0, midcode->GetInteger());
     } else if (IsChar(value)) {
-        objcode_->Output(MipsInstr::li, Reg::v0, midcode->GetChar());
+        objcode_->Output(MipsInstr::li, Reg::a0, midcode->GetChar());
     } else if (IsTemporary(value)) {
         LoadTemporary(value, Reg::a0);
-    } else if (IsConstVariable(value)) {
-        objcode_->Output(MipsInstr::li, Reg::a0, GetConstVariable(value));
     } else {
-        LoadVariable(value, Reg::a0);
+        LoadVariable(midcode->symbol1(), Reg::a0);
     }
 
     objcode_->Output(MipsInstr::li, Reg::v0, type);
@@ -227,6 +174,11 @@ void MipsGenerator::GeneratePrintfEnd() {
     objcode_->Output(MipsInstr::syscall);
 }
 
+// Labels are numbered per function, so they are qualified by it in the assembly.
+string MipsGenerator::GetLabel(Midcode *midcode) {
+    return midcode->GetLabel() + "_" + function_name_;
+}
+
 void MipsGenerator::GenerateLabel(const string &label) {
     objcode_->Output(MipsInstr::label, label);
 }
@@ -235,7 +187,9 @@ void MipsGenerator::GenerateJump(const string &label) {
     objcode_->Output(MipsInstr::j, label);
 }
 
-void MipsGenerator::GenerateAssign(const string &result, const string &value) {
+void MipsGenerator::GenerateAssign(Midcode *midcode) {
+    string result = midcode->reg_result();
+    string value = midcode->reg1();
 
     if (IsInteger(value)) {
         objcode_->Output(MipsInstr::li, RD, stoi(value));
@@ -244,17 +198,15 @@ void MipsGenerator::GenerateAssign(const string &result, const string &value) {
     } else if (IsTemporary(value)) {
         LoadTemporary(value, RS);
         objcode_->Output(MipsInstr::move, RD, RS);
-    } else if (IsConstVariable(value)) {
-        objcode_->Output(MipsInstr::li, RD, GetConstVariable(value));
     } else {
-        LoadVariable(value, RS);
+        LoadVariable(midcode->symbol1(), RS);
         objcode_->Output(MipsInstr::move, RD, RS);
     }
 
     if (IsTemporary(result)) {
         SaveTemporary(result, RD);
     } else {
-        SaveVariable(result, RD);
+        SaveVariable(midcode->symbol_result(), RD);
     }
 }
 
@@ -263,7 +215,7 @@ void MipsGenerator::GenerateAssignReturn(const string &temp) {
     SaveTemporary(temp, RD);
 }
 
-void MipsGenerator::SetArrayIndex(const string &index, Reg base, int &offset, bool &is_use_temp) {
+void MipsGenerator::SetArrayIndex(const string &index, Symbol *symbol, Reg base, int &offset, bool &is_use_temp) {
     if (IsInteger(index)) {
         offset += 4 * stoi(index);
     } else if (IsChar(index)) {
@@ -274,14 +226,8 @@ void MipsGenerator::SetArrayIndex(const string &index, Reg base, int &offset, bo
         objcode_->Output(MipsInstr::addi, TEMP, TEMP, offset);
         objcode_->Output(MipsInstr::add, TEMP, base, TEMP);
         is_use_temp = true;
-    } else if (IsConstVariable(index)) {
-        objcode_->Output(MipsInstr::li, TEMP, GetConstVariable(index));
-        objcode_->Output(MipsInstr::sll, TEMP, TEMP, 2);
-        objcode_->Output(MipsInstr::addi, TEMP, TEMP, offset);
-        objcode_->Output(MipsInstr::add, TEMP, base, TEMP);
-        is_use_temp = true;
     } else {
-        LoadVariable(index, TEMP);
+        LoadVariable(symbol, TEMP);
         objcode_->Output(MipsInstr::sll, TEMP, TEMP, 2);
         objcode_->Output(MipsInstr::addi, TEMP, TEMP, offset);
         objcode_->Output(MipsInstr::add, TEMP, base, TEMP);
@@ -289,15 +235,15 @@ void MipsGenerator::SetArrayIndex(const string &index, Reg base, int &offset, bo
     }
 }
 
-void MipsGenerator::GenerateAssignArray(const string &array, const string &index, const string &value) {
+void MipsGenerator::GenerateAssignArray(Midcode *midcode) {
 
     bool is_use_temp = false;
-    int offset = check_table_->FindSymbol(array)->offset();
-    int level = check_table_->GetSymbolLevel(array);
-    Reg base = level == 0 ? GLOBAL_POINT : FUNC_POINT;
+    Symbol *array = midcode->symbol_result();
+    int offset = array->offset();
+    Reg base = array->level() == 0 ? GLOBAL_POINT : FUNC_POINT;
 
-    SetArrayIndex(index, base, offset, is_use_temp);
-    LoadValue(value, RT);
+    SetArrayIndex(midcode->reg1(), midcode->symbol1(), base, offset, is_use_temp);
+    LoadValue(midcode->reg2(), midcode->symbol2(), RT);
 
     if (is_use_temp) {
         objcode_->Output(MipsInstr::sw, RT, TEMP, 0);
@@ -306,14 +252,14 @@ void MipsGenerator::GenerateAssignArray(const string &array, const string &index
     }
 }
 
-void MipsGenerator::GenerateLoadArray(const string &temp, const string &array, const string &index) {
+void MipsGenerator::GenerateLoadArray(Midcode *midcode) {
 
     bool is_use_temp = false;
-    int offset = check_table_->FindSymbol(array)->offset();
-    int level = check_table_->GetSymbolLevel(array);
-    Reg base = level == 0 ? GLOBAL_POINT : FUNC_POINT;
+    Symbol *array = midcode->symbol1();
+    int offset = array->offset();
+    Reg base = array->level() == 0 ? GLOBAL_POINT : FUNC_POINT;
 
-    SetArrayIndex(index, base, offset, is_use_temp);
+    SetArrayIndex(midcode->reg2(), midcode->symbol2(), base, offset, is_use_temp);
 
     if (is_use_temp) {
         objcode_->Output(MipsInstr::lw, RT, TEMP, 0);
@@ -321,44 +267,44 @@ void MipsGenerator::GenerateLoadArray(const string &temp, const string &array, c
         objcode_->Output(MipsInstr::lw, RT, base, offset);
     }
 
-    SaveTemporary(temp, RT);
+    SaveTemporary(midcode->GetTempReg(), RT);
 }
 
-void MipsGenerator::SetOperand(const string &value, Reg reg, bool &is_immediate, int &immediate) {
+void MipsGenerator::SetOperand(const string &value, Symbol *symbol, Reg reg, bool &is_immediate, int &immediate) {
     if (IsInteger(value)) {
         is_immediate = true;
         immediate = stoi(value);
     } else if (IsChar(value)) {
         is_immediate = true;
         immediate = (int) value[1];
-    } else if (IsConstVariable(value)) {
-        is_immediate = true;
-        immediate = GetConstVariable(value);
+    } else if (IsTemporary(value)) {
+        LoadTemporary(value, reg);
     } else {
-        LoadVariable(value, reg);
+        LoadVariable(symbol, reg);
     }
 }
 
-void MipsGenerator::DealNumberOpNumber(const string &value_1, const string &value_2,
+void MipsGenerator::DealNumberOpNumber(const string &value_1, Symbol *symbol_1,
+                                       const string &value_2, Symbol *symbol_2,
                                        int &immediate_1, bool &is_immediate_1,
                                        int &immediate_2, bool &is_immediate_2) {
 
-    SetOperand(value_1, RS, is_immediate_1, immediate_1);
-    SetOperand(value_2, RT, is_immediate_2, immediate_2);
+    SetOperand(value_1, symbol_1, RS, is_immediate_1, immediate_1);
+    SetOperand(value_2, symbol_2, RT, is_immediate_2, immediate_2);
 }
 
-void MipsGenerator::DealNumberOpReg(const string &value_1, const string &temp_2,
+void MipsGenerator::DealNumberOpReg(const string &value_1, Symbol *symbol_1, const string &temp_2,
                                     int &immediate_1, bool &is_immediate_1) {
 
-    SetOperand(value_1, RS, is_immediate_1, immediate_1);
+    SetOperand(value_1, symbol_1, RS, is_immediate_1, immediate_1);
     LoadTemporary(temp_2, RT);
 }
 
-void MipsGenerator::DealRegOpNumber(const string &temp_1, const string &value_2,
+void MipsGenerator::DealRegOpNumber(const string &temp_1, const string &value_2, Symbol *symbol_2,
                                     int &immediate_2, bool &is_immediate_2) {
 
     LoadTemporary(temp_1, RS);
-    SetOperand(value_2, RT, is_immediate_2, immediate_2);
+    SetOperand(value_2, symbol_2, RT, is_immediate_2, immediate_2);
 }
 
 void MipsGenerator::DealRegOpReg(const string &temp_1, const string &temp_2) {
@@ -366,7 +312,7 @@ void MipsGenerator::DealRegOpReg(const string &temp_1, const string &temp_2) {
     LoadTemporary(temp_2, RT);
 }
 
-void MipsGenerator::GenerateOperate(Midcode *midcode, const string &result,
+void MipsGenerator::GenerateOperate(Midcode *midcode, const string &result, Symbol *result_symbol,
                                     MidcodeInstr op, OperaMember member_type) {
 
     bool is_immediate_1 = false;
@@ -379,15 +325,15 @@ void MipsGenerator::GenerateOperate(Midcode *midcode, const string &result,
             DealRegOpReg(midcode->GetTempReg1(), midcode->GetTempReg2());
             break;
         case OperaMember::REG_OP_NUMBER:
-            DealRegOpNumber(midcode->GetTempReg1(), midcode->reg2(),
+            DealRegOpNumber(midcode->GetTempReg1(), midcode->reg2(), midcode->symbol2(),
                             immediate_2, is_immediate_2);
             break;
         case OperaMember::NUMBER_OP_REG:
-            DealNumberOpReg(midcode->reg2(), midcode->GetTempReg1(),
+            DealNumberOpReg(midcode->reg2(), midcode->symbol2(), midcode->GetTempReg1(),
                             immediate_1, is_immediate_1);
             break;
         case OperaMember::NUMBER_OP_NUMBER:
-            DealNumberOpNumber(midcode->reg1(), midcode->reg2(),
+            DealNumberOpNumber(midcode->reg1(), midcode->symbol1(), midcode->reg2(), midcode->symbol2(),
                                immediate_1, is_immediate_1,
                                immediate_2, is_immediate_2);
             break;
@@ -395,6 +341,7 @@ void MipsGenerator::GenerateOperate(Midcode *midcode, const string &result,
             assert(0);
     }
 
+    int folded;     // case 3: both operands are immediates
     int flag;
     if (is_immediate_1 && is_immediate_2) {
         flag = 3;
@@ -419,7 +366,8 @@ void MipsGenerator::GenerateOperate(Midcode *midcode, const string &result,
                     objcode_->Output(MipsInstr::addi, RD, RS, immediate_2);
                     break;
                 case 3:
-                    objcode_->Output(MipsInstr::li, RD, immediate_1 + immediate_2);
+                    midcodeinstr::Calculate(op, immediate_1, immediate_2, folded);
+                    objcode_->Output(MipsInstr::li, RD, folded);
                     break;
                 default:
                     assert(0);
@@ -438,7 +386,8 @@ void MipsGenerator::GenerateOperate(Midcode *midcode, const string &result,
                     objcode_->Output(MipsInstr::subi, RD, RS, immediate_2);
                     break;
                 case 3:
-                    objcode_->Output(MipsInstr::li, RD, immediate_1 - immediate_2);
+                    midcodeinstr::Calculate(op, immediate_1, immediate_2, folded);
+                    objcode_->Output(MipsInstr::li, RD, folded);
                     break;
                 default:
                     assert(0);
@@ -456,7 +405,8 @@ void MipsGenerator::GenerateOperate(Midcode *midcode, const string &result,
                     objcode_->Output(MipsInstr::mul, RD, RS, immediate_2);
                     break;
                 case 3:
-                    objcode_->Output(MipsInstr::li, RD, immediate_1 * immediate_2);
+                    midcodeinstr::Calculate(op, immediate_1, immediate_2, folded);
+                    objcode_->Output(MipsInstr::li, RD, folded);
                     break;
                 default:
                     assert(0);
@@ -475,7 +425,12 @@ void MipsGenerator::GenerateOperate(Midcode *midcode, const string &result,
                     objcode_->Output(MipsInstr::div, RD, RS, immediate_2);
                     break;
                 case 3:
-                    objcode_->Output(MipsInstr::li, RD, immediate_1 / immediate_2);
+                    if (immediate_2 == 0 || (immediate_1 == INT_MIN && immediate_2 == -1)) {
+                        objcode_->Output(MipsInstr::li, RS, immediate_1);    // traps at run time
+                        objcode_->Output(MipsInstr::div, RD, RS, immediate_2);
+                    } else {
+                        objcode_->Output(MipsInstr::li, RD, immediate_1 / immediate_2);
+                    }
                     break;
                 default:
                     assert(0);
@@ -488,36 +443,39 @@ void MipsGenerator::GenerateOperate(Midcode *midcode, const string &result,
     if (IsTemporary(result)) {
         SaveTemporary(result, RD);
     } else {
-        SaveVariable(result, RD);
+        SaveVariable(result_symbol, RD);
     }
 }
 
 void MipsGenerator::GenerateOperate(list<Midcode *>::iterator &iter, Midcode *midcode) {
     Midcode *next_midcode = *(++iter);
 
-    if (next_midcode->instr() == MidcodeInstr::ASSIGN
+    if (optimize_level_ >= 1
+        && next_midcode->instr() == MidcodeInstr::ASSIGN
         && next_midcode->reg1() == midcode->GetTempRegResult()) {
 
-        GenerateOperate(midcode, next_midcode->reg_result(),
+        next_midcode->BindSymbol(check_table_);
+        GenerateOperate(midcode, next_midcode->reg_result(), next_midcode->symbol_result(),
                         midcode->instr(), midcode->opera_member());
     } else {
         iter--;
-        GenerateOperate(midcode, midcode->GetTempRegResult(),
+        GenerateOperate(midcode, midcode->GetTempRegResult(), nullptr,
                         midcode->instr(), midcode->opera_member());
     }
 }
 
 void MipsGenerator::GenerateStep(list<Midcode *>::iterator &iter, Midcode *&midcode) {
     midcode = *(++iter);
-    GenerateOperate(midcode, midcode->reg_result(),
+    midcode->BindSymbol(check_table_);
+    GenerateOperate(midcode, midcode->reg_result(), midcode->symbol_result(),
                     midcode->instr(), midcode->opera_member());
 }
 
-void MipsGenerator::GenerateNeg(const string &temp_result, const string &value) {
+void MipsGenerator::GenerateNeg(const string &temp_result, const string &value, Symbol *symbol) {
 
     bool is_immediate = false;
     int immediate = 0;
-    SetOperand(value, RS, is_immediate, immediate);
+    SetOperand(value, symbol, RS, is_immediate, immediate);
 
     if (is_immediate) {
         objcode_->Output(MipsInstr::li, RD, -immediate);
@@ -525,24 +483,18 @@ void MipsGenerator::GenerateNeg(const string &temp_result, const string &value)
         objcode_->Output(MipsInstr::sub, RD, Reg::zero, RS);
     }
 
-    if (IsTemporary(temp_result)) {
-        SaveTemporary(temp_result, RD);
-    } else {
-        SaveVariable(temp_result, RD);
-    }
+    SaveTemporary(temp_result, RD);
 }
 
-void MipsGenerator::SetJudgeReg(const string &value, Reg reg) {
+void MipsGenerator::SetJudgeReg(const string &value, Symbol *symbol, Reg reg) {
     if (IsInteger(value)) {
         objcode_->Output(MipsInstr::li, reg, stoi(value));
     } else if (IsChar(value)) {
         objcode_->Output(MipsInstr::li, reg, (int) value[1]);
-    } else if (IsConstVariable(value)) {
-        objcode_->Output(MipsInstr::li, reg, GetConstVariable(value));
     } else if (IsTemporary(value)) {
         LoadTemporary(value, reg);
     } else {
-        LoadVariable(value, reg);
+        LoadVariable(symbol, reg);
     }
 }
 
@@ -553,42 +505,42 @@ void MipsGenerator::GenerateJudge(Midcode *midcode, MidcodeInstr judge) {
     switch (judge) {
         case MidcodeInstr::BGT:
             mips_instr = MipsInstr::bgt;
-            SetJudgeReg(midcode->reg1(), RS);
-            SetJudgeReg(midcode->reg2(), RT);
+            SetJudgeReg(midcode->reg1(), midcode->symbol1(), RS);
+            SetJudgeReg(midcode->reg2(), midcode->symbol2(), RT);
             break;
         case MidcodeInstr::BGE:
             mips_instr = MipsInstr::bge;
-            SetJudgeReg(midcode->reg1(), RS);
-            SetJudgeReg(midcode->reg2(), RT);
+            SetJudgeReg(midcode->reg1(), midcode->symbol1(), RS);
+            SetJudgeReg(midcode->reg2(), midcode->symbol2(), RT);
             break;
         case MidcodeInstr::BLT:
             mips_instr = MipsInstr::blt;
-            SetJudgeReg(midcode->reg1(), RS);
-            SetJudgeReg(midcode->reg2(), RT);
+            SetJudgeReg(midcode->reg1(), midcode->symbol1(), RS);
+            SetJudgeReg(midcode->reg2(), midcode->symbol2(), RT);
             break;
         case MidcodeInstr::BLE:
             mips_instr = MipsInstr::ble;
-            SetJudgeReg(midcode->reg1(), RS);
-            SetJudgeReg(midcode->reg2(), RT);
+            SetJudgeReg(midcode->reg1(), midcode->symbol1(), RS);
+            SetJudgeReg(midcode->reg2(), midcode->symbol2(), RT);
             break;
         case MidcodeInstr::BEQ:
             mips_instr = MipsInstr::beq;
-            SetJudgeReg(midcode->reg1(), RS);
-            SetJudgeReg(midcode->reg2(), RT);
+            SetJudgeReg(midcode->reg1(), midcode->symbol1(), RS);
+            SetJudgeReg(midcode->reg2(), midcode->symbol2(), RT);
             break;
         case MidcodeInstr::BNE:
             mips_instr = MipsInstr::bne;
-            SetJudgeReg(midcode->reg1(), RS);
-            SetJudgeReg(midcode->reg2(), RT);
+            SetJudgeReg(midcode->reg1(), midcode->symbol1(), RS);
+            SetJudgeReg(midcode->reg2(), midcode->symbol2(), RT);
             break;
         case MidcodeInstr::BEZ:
             mips_instr = MipsInstr::beq;
-            SetJudgeReg(midcode->reg1(), RS);
+            SetJudgeReg(midcode->reg1(), midcode->symbol1(), RS);
             is_two_judge = false;
             break;
         case MidcodeInstr::BNZ:
             mips_instr = MipsInstr::bne;
-            SetJudgeReg(midcode->reg1(), RS);
+            SetJudgeReg(midcode->reg1(), midcode->symbol1(), RS);
             is_two_judge = false;
             break;
         default:
@@ -596,28 +548,29 @@ void MipsGenerator::GenerateJudge(Midcode *midcode, MidcodeInstr judge) {
     }
 
     if (is_two_judge) {
-        objcode_->Output(mips_instr, RS, RT, midcode->GetLabel());
+        objcode_->Output(mips_instr, RS, RT, GetLabel(midcode));
     } else {
-        objcode_->Output(mips_instr, RS, Reg::zero, midcode->GetLabel());
+        objcode_->Output(mips_instr, RS, Reg::zero, GetLabel(midcode));
     }
 
 }
 
-void MipsGenerator::GeneratePush(const string &value) {
-    LoadValue(value, RT);
+void MipsGenerator::GeneratePush(const string &value, Symbol *symbol) {
+    LoadValue(value, symbol, RT);
     objcode_->Output(MipsInstr::sw, RT, PARA_POINT, 0);
     objcode_->Output(MipsInstr::addi, PARA_POINT, PARA_POINT, 4);
 }
 
-void MipsGenerator::GenerateCall(const string &prev_name, const string &call_name) {
+// The callee's frame starts right after the caller's.
+void MipsGenerator::GenerateCall(Symbol *function) {
 
-    objcode_->Output(MipsInstr::addi, FUNC_POINT, FUNC_POINT, 2000);
+    objcode_->Output(MipsInstr::addi, FUNC_POINT, FUNC_POINT, frame_layout_->frame_size());
 
-    objcode_->Output(MipsInstr::jal, call_name);
+    objcode_->Output(MipsInstr::jal, function->name());
 
-    objcode_->Output(MipsInstr::subi, FUNC_POINT, FUNC_POINT, 2000);
+    objcode_->Output(MipsInstr::subi, FUNC_POINT, FUNC_POINT, frame_layout_->frame_size());
 
-    int length = check_table_->FindSymbol(call_name, 0)->GetParameterCount();
+    int length = function->GetParameterCount();
     objcode_->Output(MipsInstr::subi, PARA_POINT, PARA_POINT, 4 * length);
 
     objcode_->Output(MipsInstr::subi, RA_POINT, RA_POINT, 4);
@@ -643,11 +596,8 @@ void MipsGenerator::GenerateReturn(Midcode *midcode, bool is_return_value) {
         } else if (IsTemporary(midcode->label())) {
             LoadTemporary(midcode->label(), RS);
             objcode_->Output(MipsInstr::move, Reg::v0, RS);
-        } else if (IsConstVariable(midcode->label())) {
-            objcode_->Output(MipsInstr::li, Reg::v0,
-                             GetConstVariable(midcode->label()));
         } else {
-            LoadVariable(midcode->label(), RS);
+            LoadVariable(midcode->symbol1(), RS);
             objcode_->Output(MipsInstr::move, Reg::v0, RS);
         }
     }
@@ -655,30 +605,30 @@ void MipsGenerator::GenerateReturn(Midcode *midcode, bool is_return_value) {
     objcode_->Output(MipsInstr::jr, Reg::ra);
 }
 
-void MipsGenerator::GenerateParameter(const string &function_name, const string &value, int count) {
+void MipsGenerator::GenerateParameter(Symbol *parameter, int count) {
 
-    int parameter_count = check_table_->FindSymbol(
-            function_name, 0)->GetParameterCount();
+    int parameter_count = function_->GetParameterCount();
     int para_offset = 4 * (count - parameter_count);
-    int func_offset = check_table_->FindSymbol(value)->offset();
+    int func_offset = parameter->offset();
 
     objcode_->Output(MipsInstr::lw, RT, PARA_POINT, para_offset);
     objcode_->Output(MipsInstr::sw, RT, FUNC_POINT, func_offset);
 }
 
-void MipsGenerator::GenerateBody(const string &function_name, list<Midcode *>::iterator &iter) {
+void MipsGenerator::GenerateBody(list<Midcode *>::iterator &iter) {
     Midcode *midcode;
     int parameter_count = 0;
 
     while (iter != midcode_list_.end()) {
         midcode = *iter;
+        midcode->BindSymbol(check_table_);
 
         switch (midcode->instr()) {
             case MidcodeInstr::SCANF_INT:
-                GenerateScanf(midcode->label(), 5);
+                GenerateScanf(midcode->symbol1(), 5);
                 break;
             case MidcodeInstr::SCANF_CHAR:
-                GenerateScanf(midcode->label(), 12);
+                GenerateScanf(midcode->symbol1(), 12);
                 break;
             case MidcodeInstr::PRINTF_INT:
                 GeneratePrintfIntChar(midcode, 1);
@@ -693,23 +643,22 @@ void MipsGenerator::GenerateBody(const string &function_name, list<Midcode *>::i
                 GeneratePrintfEnd();
                 break;
             case MidcodeInstr::LABEL:
-                GenerateLabel(midcode->GetLabel());
+                GenerateLabel(GetLabel(midcode));
                 break;
             case MidcodeInstr::JUMP:
-                GenerateJump(midcode->GetJumpLabel());
+                GenerateJump(GetLabel(midcode));
                 break;
             case MidcodeInstr::ASSIGN:
-                GenerateAssign(midcode->reg_result(), midcode->reg1());
+                GenerateAssign(midcode);
                 break;
             case MidcodeInstr::ASSIGN_RETURN:
                 GenerateAssignReturn(midcode->GetTempReg());
                 break;
             case MidcodeInstr::ASSIGN_ARRAY:
-                GenerateAssignArray(midcode->reg_result(),
-                                    midcode->reg1(), midcode->reg2());
+                GenerateAssignArray(midcode);
                 break;
             case MidcodeInstr::LOAD_ARRAY:
-                GenerateLoadArray(midcode->GetTempReg(), midcode->reg1(), midcode->reg2());
+                GenerateLoadArray(midcode);
                 break;
             case MidcodeInstr::ADD:
                 GenerateOperate(iter, midcode);
@@ -727,7 +676,7 @@ void MipsGenerator::GenerateBody(const string &function_name, list<Midcode *>::i
                 GenerateStep(iter, midcode);
                 break;
             case MidcodeInstr::NEG:
-                GenerateNeg("#" + to_string(midcode->count()), midcode->reg1());
+                GenerateNeg(midcode->GetTempReg(), midcode->reg1(), midcode->symbol1());
                 break;
             case MidcodeInstr::BGT:
                 GenerateJudge(midcode, MidcodeInstr::BGT);
@@ -754,10 +703,10 @@ void MipsGenerator::GenerateBody(const string &function_name, list<Midcode *>::i
                 GenerateJudge(midcode, MidcodeInstr::BNZ);
                 break;
             case MidcodeInstr::PUSH:
-                GeneratePush(midcode->reg2());
+                GeneratePush(midcode->reg2(), midcode->symbol2());
                 break;
             case MidcodeInstr::CALL:
-                GenerateCall(function_name, midcode->label());
+                GenerateCall(midcode->symbol1());
                 break;
             case MidcodeInstr::SAVE:
                 GenerateSave();
@@ -771,10 +720,10 @@ void MipsGenerator::GenerateBody(const string &function_name, list<Midcode *>::i
                 GenerateReturn(midcode, false);
                 break;
             case MidcodeInstr::PARA_INT:
-                GenerateParameter(function_name, midcode->label(), parameter_count++);
+                GenerateParameter(midcode->symbol1(), parameter_count++);
                 break;
             case MidcodeInstr::PARA_CHAR:
-                GenerateParameter(function_name, midcode->label(), parameter_count++);
+                GenerateParameter(midcode->symbol1(), parameter_count++);
                 break;
             case MidcodeInstr::VAR_INT:
                 break;
@@ -793,11 +742,16 @@ void MipsGenerator::GenerateBody(const string &function_name, list<Midcode *>::i
 void MipsGenerator::GenerateFunction(const string &function_name,
                                      list<Midcode *>::iterator &iter) {
 
+    Profiler *profiler = Profiler::GetInstance();
+    profiler->Begin("function", function_name);
     LoadTable(1, function_name);
-    InitVariable(function_name);
+    function_name_ = function_name;
+    function_ = check_table_->FindSymbol(function_name, 0);
+    frame_layout_ = &frame_layout_map_.at(function_name);
     objcode_->Output(MipsInstr::label, function_name);
     iter++;
-    GenerateBody(function_name, iter);
+    GenerateBody(iter);
+    profiler->End();
 }
 
 void MipsGenerator::Generate() {
@@ -835,6 +789,10 @@ void MipsGenerator::GenerateMips() {
     Generate();
 }
 
+int MipsGenerator::instruction_count() const {
+    return objcode_->instruction_count();
+}
+
 void MipsGenerator::FileClose() {
     objcode_->FileClose();
 }
\ No newline at end of file
@@ -0,0 +1,514 @@
+﻿#include "mips_simulator.h"
+
+#include <cstring>
+#include <sstream>
+#include <utility>
+
+using namespace std;
+
+MipsSimulator::MipsSimulator() {
+    memset(reg_, 0, sizeof(reg_));
+    lo_ = 0;
+    data_cursor_ = 0;
+    step_limit_ = 0;
+    step_count_ = 0;
+}
+
+vector<string> MipsSimulator::Split(const string &line) {
+    vector<string> token;
+    string current;
+
+    for (char c : line) {
+        if (isspace(c) || c == ',') {
+            if (!current.empty()) {
+                token.push_back(current);
+                current.clear();
+            }
+        } else if (c == '#') {
+            break;
+        } else {
+            current.push_back(c);
+        }
+    }
+    if (!current.empty()) {
+        token.push_back(current);
+    }
+    return token;
+}
+
+int MipsSimulator::ParseReg(const string &str) {
+    for (int i = 0; i < 32; i++) {
+        if (reg::RegToString(reg::NumberToReg(i)) == str) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+string MipsSimulator::ParseString(const string &str) {
+    string result;
+    size_t begin = str.find('"');
+    size_t end = str.rfind('"');
+
+    for (size_t i = begin + 1; i < end; i++) {
+        if (str[i] == '\\' && i + 1 < end) {
+            i++;
+            switch (str[i]) {
+                case 'n':
+                    result.push_back('\n');
+                    break;
+                case 't':
+                    result.push_back('\t');
+                    break;
+                case '0':
+                    result.push_back('\0');
+                    break;
+                default:
+                    result.push_back(str[i]);
+                    break;
+            }
+        } else {
+            result.push_back(str[i]);
+        }
+    }
+    return result;
+}
+
+bool MipsSimulator::ParseData(const string &line) {
+    string rest = line;
+    size_t colon = line.find(':');
+    size_t quote = line.find('"');
+
+    int &cursor = data_cursor_;
+
+    if (colon != string::npos && (quote == string::npos || colon < quote)) {
+        vector<string> label = Split(line.substr(0, colon));
+        if (label.size() != 1) {
+            return Trap("bad data label: " + line);
+        }
+        data_label_map_[label[0]] = DATA_BASE + cursor;
+        rest = line.substr(colon + 1);
+    }
+
+    vector<string> token = Split(rest);
+    if (token.empty()) {
+        return true;
+    }
+    if (token[0] == ".asciiz") {
+        string str = ParseString(rest);
+        if (cursor + (int) str.length() + 1 > DATA_SIZE) {
+            return Trap("data segment overflow");
+        }
+        memcpy(&data_[cursor], str.c_str(), str.length() + 1);
+        cursor += str.length() + 1;
+    } else if (token[0] == ".space" && token.size() == 2) {
+        cursor += stoi(token[1]);
+    } else if (token[0] == ".align" && token.size() == 2) {
+        int align = 1 << stoi(token[1]);
+        cursor = (cursor + align - 1) / align * align;
+    } else if (token[0] == ".word") {
+        for (size_t i = 1; i < token.size(); i++) {
+            int value = stoi(token[i]);
+            memcpy(&data_[cursor], &value, 4);
+            cursor += 4;
+        }
+    } else {
+        return Trap("unknown directive: " + line);
+    }
+    if (cursor > DATA_SIZE) {
+        return Trap("data segment overflow");
+    }
+    return true;
+}
+
+bool MipsSimulator::ParseMemory(const string &str, Instruction &instruction) {
+    size_t left = str.find('(');
+    size_t right = str.find(')');
+    if (left == string::npos || right == string::npos) {
+        return false;
+    }
+
+    string offset = str.substr(0, left);
+    instruction.rs = ParseReg(str.substr(left + 1, right - left - 1));
+    if (offset.empty()) {
+        instruction.immediate = 0;
+    } else if (isdigit(offset[0]) || offset[0] == '-' || offset[0] == '+') {
+        instruction.immediate = stoi(offset);
+    } else {
+        instruction.label = offset;
+    }
+    return instruction.rs >= 0;
+}
+
+bool MipsSimulator::ParseText(const vector<string> &token) {
+    Instruction instruction = {Opcode::nop, 0, 0, 0, 0, ""};
+    const string &name = token[0];
+    size_t count = token.size();
+    bool is_valid = true;
+
+    auto reg = [&](size_t i) {
+        int number = i < count ? ParseReg(token[i]) : -1;
+        if (number < 0) {
+            is_valid = false;
+            return 0;
+        }
+        return number;
+    };
+    auto is_reg = [&](size_t i) {
+        return i < count && token[i][0] == '$';
+    };
+    auto immediate = [&](size_t i) {
+        if (i >= count) {
+            is_valid = false;
+            return 0;
+        }
+        return stoi(token[i]);
+    };
+    auto label = [&](size_t i) {
+        if (i >= count) {
+            is_valid = false;
+            return string();
+        }
+        return token[i];
+    };
+
+    if (name == "add" || name == "sub" || name == "mul" || name == "addi" || name == "sll") {
+        instruction.rd = reg(1);
+        instruction.rs = reg(2);
+        if (name == "addi" || name == "sll" || !is_reg(3)) {
+            instruction.opcode = name == "add" || name == "addi" ? Opcode::addi
+                                 : name == "sll" ? Opcode::sll : Opcode::muli;
+            instruction.immediate = immediate(3);
+            is_valid = is_valid && name != "sub";
+        } else {
+            instruction.opcode = name == "add" ? Opcode::add : name == "sub" ? Opcode::sub : Opcode::mul;
+            instruction.rt = reg(3);
+        }
+    } else if (name == "div") {
+        if (count == 3) {
+            instruction.opcode = Opcode::div;
+            instruction.rs = reg(1);
+            instruction.rt = reg(2);
+        } else if (is_reg(3)) {
+            instruction.opcode = Opcode::div;
+            instruction.rd = reg(1);
+            instruction.rs = reg(2);
+            instruction.rt = reg(3);
+        } else {
+            instruction.opcode = Opcode::divi;
+            instruction.rd = reg(1);
+            instruction.rs = reg(2);
+            instruction.immediate = immediate(3);
+        }
+    } else if (name == "mflo") {
+        instruction.opcode = Opcode::mflo;
+        instruction.rd = reg(1);
+    } else if (name == "lw" || name == "sw") {
+        instruction.opcode = name == "lw" ? Opcode::lw : Opcode::sw;
+        instruction.rt = reg(1);
+        is_valid = is_valid && count == 3 && ParseMemory(token[2], instruction);
+    } else if (name == "bgt" || name == "bge" || name == "blt"
+               || name == "ble" || name == "beq" || name == "bne") {
+        instruction.opcode = name == "bgt" ? Opcode::bgt : name == "bge" ? Opcode::bge
+                             : name == "blt" ? Opcode::blt : name == "ble" ? Opcode::ble
+                             : name == "beq" ? Opcode::beq : Opcode::bne;
+        instruction.rs = reg(1);
+        if (is_reg(2)) {
+            instruction.rt = reg(2);
+        } else {
+            is_valid = false;
+        }
+        instruction.label = label(3);
+    } else if (name == "j" || name == "jal") {
+        instruction.opcode = name == "j" ? Opcode::j : Opcode::jal;
+        instruction.label = label(1);
+    } else if (name == "jr") {
+        instruction.opcode = Opcode::jr;
+        instruction.rs = reg(1);
+    } else if (name == "la") {
+        instruction.opcode = Opcode::la;
+        instruction.rd = reg(1);
+        instruction.label = label(2);
+    } else if (name == "li") {
+        instruction.opcode = Opcode::li;
+        instruction.rd = reg(1);
+        instruction.immediate = immediate(2);
+    } else if (name == "move") {
+        instruction.opcode = Opcode::move;
+        instruction.rd = reg(1);
+        instruction.rs = reg(2);
+    } else if (name == "syscall") {
+        instruction.opcode = Opcode::syscall;
+    } else if (name == "nop") {
+        instruction.opcode = Opcode::nop;
+    } else {
+        is_valid = false;
+    }
+
+    if (!is_valid) {
+        string line = name;
+        for (size_t i = 1; i < count; i++) {
+            line += " " + token[i];
+        }
+        return Trap("bad instruction: " + line);
+    }
+    text_.push_back(instruction);
+    return true;
+}
+
+bool MipsSimulator::Link() {
+    for (auto &instruction : text_) {
+        if (instruction.label.empty()) {
+            continue;
+        }
+        switch (instruction.opcode) {
+            case Opcode::la:
+            case Opcode::lw:
+            case Opcode::sw: {
+                auto iter = data_label_map_.find(instruction.label);
+                if (iter == data_label_map_.end()) {
+                    return Trap("undefined data label " + instruction.label);
+                }
+                instruction.immediate += iter->second;
+                break;
+            }
+            default: {
+                auto iter = text_label_map_.find(instruction.label);
+                if (iter == text_label_map_.end()) {
+                    return Trap("undefined label " + instruction.label);
+                }
+                instruction.immediate = iter->second;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+bool MipsSimulator::Load(istream &mips) {
+    string line;
+    bool is_data = false;
+
+    data_.assign(DATA_SIZE, 0);
+    data_cursor_ = 0;
+    while (getline(mips, line)) {
+        vector<string> token = Split(line);
+        if (token.empty()) {
+            continue;
+        }
+        if (token[0] == ".data") {
+            is_data = true;
+        } else if (token[0] == ".text") {
+            is_data = false;
+        } else if (is_data) {
+            if (!ParseData(line)) {
+                return false;
+            }
+        } else if (token.size() == 1 && token[0].back() == ':') {
+            text_label_map_[token[0].substr(0, token[0].length() - 1)] = text_.size();
+        } else if (!ParseText(token)) {
+            return false;
+        }
+    }
+    return Link();
+}
+
+bool MipsSimulator::Trap(const string &error) {
+    error_ = error;
+    return false;
+}
+
+bool MipsSimulator::LoadWord(int address, int &value) {
+    unsigned offset = (unsigned) address - DATA_BASE;
+    if (offset > DATA_SIZE - 4 || offset % 4 != 0) {
+        return Trap("bad load address " + to_string(address));
+    }
+    memcpy(&value, &data_[offset], 4);
+    return true;
+}
+
+bool MipsSimulator::StoreWord(int address, int value) {
+    unsigned offset = (unsigned) address - DATA_BASE;
+    if (offset > DATA_SIZE - 4 || offset % 4 != 0) {
+        return Trap("bad store address " + to_string(address));
+    }
+    memcpy(&data_[offset], &value, 4);
+    return true;
+}
+
+bool MipsSimulator::Syscall(istream &input, ostream &output, bool &is_exit) {
+    int &v0 = reg_[reg::RegToNumber(Reg::v0)];
+    int a0 = reg_[reg::RegToNumber(Reg::a0)];
+
+    switch (v0) {
+        case 1:
+            output << a0;
+            break;
+        case 4: {
+            unsigned offset = (unsigned) a0 - DATA_BASE;
+            while (offset < DATA_SIZE && data_[offset] != 0) {
+                output << (char) data_[offset++];
+            }
+            break;
+        }
+        case 5: {
+            int value;
+            input >> value;
+            v0 = input ? value : 0;
+            break;
+        }
+        case 10:
+            is_exit = true;
+            break;
+        case 11:
+            output << (char) a0;
+            break;
+        case 12: {
+            char c;
+            input >> c;
+            v0 = input ? (int) c : 0;
+            break;
+        }
+        default:
+            return Trap("unknown syscall " + to_string(v0));
+    }
+    return true;
+}
+
+void MipsSimulator::set_step_limit(long long step_limit) {
+    step_limit_ = step_limit;
+}
+
+bool MipsSimulator::Run(istream &input, ostream &output) {
+    int pc = 0;
+    int *r = reg_;
+    int value;
+    long long result;
+    bool is_exit = false;
+
+    if (!error_.empty()) {
+        return false;
+    }
+
+    while (!is_exit) {
+        if (pc < 0 || pc >= (int) text_.size()) {
+            return pc == (int) text_.size() ? true : Trap("pc out of text segment");
+        }
+        if (++step_count_ > step_limit_ && step_limit_ > 0) {
+            return Trap("step limit exceeded");
+        }
+
+        const Instruction &instruction = text_[pc++];
+        switch (instruction.opcode) {
+            case Opcode::add:
+            case Opcode::addi:
+            case Opcode::sub:
+                value = instruction.opcode == Opcode::addi ? instruction.immediate : r[instruction.rt];
+                result = instruction.opcode == Opcode::sub
+                         ? (long long) r[instruction.rs] - value
+                         : (long long) r[instruction.rs] + value;
+                if (result != (int) result) {
+                    return Trap("arithmetic overflow");
+                }
+                r[instruction.rd] = (int) result;
+                break;
+            case Opcode::mul:
+                r[instruction.rd] = (int) ((unsigned) r[instruction.rs] * (unsigned) r[instruction.rt]);
+                break;
+            case Opcode::muli:
+                r[instruction.rd] = (int) ((unsigned) r[instruction.rs] * (unsigned) instruction.immediate);
+                break;
+            case Opcode::div:
+            case Opcode::divi:
+                value = instruction.opcode == Opcode::divi ? instruction.immediate : r[instruction.rt];
+                if (value == 0) {
+                    return Trap("division by zero");
+                }
+                lo_ = value == -1 ? (int) (0u - (unsigned) r[instruction.rs]) : r[instruction.rs] / value;
+                if (instruction.opcode == Opcode::divi || instruction.rd != 0) {
+                    r[instruction.rd] = lo_;
+                }
+                break;
+            case Opcode::mflo:
+                r[instruction.rd] = lo_;
+                break;
+            case Opcode::sll:
+                r[instruction.rd] = (int) ((unsigned) r[instruction.rs] << (instruction.immediate & 31));
+                break;
+            case Opcode::lw:
+                if (!LoadWord(r[instruction.rs] + instruction.immediate, r[instruction.rt])) {
+                    return false;
+                }
+                break;
+            case Opcode::sw:
+                if (!StoreWord(r[instruction.rs] + instruction.immediate, r[instruction.rt])) {
+                    return false;
+                }
+                break;
+            case Opcode::bgt:
+                if (r[instruction.rs] > r[instruction.rt]) {
+                    pc = instruction.immediate;
+                }
+                break;
+            case Opcode::bge:
+                if (r[instruction.rs] >= r[instruction.rt]) {
+                    pc = instruction.immediate;
+                }
+                break;
+            case Opcode::blt:
+                if (r[instruction.rs] < r[instruction.rt]) {
+                    pc = instruction.immediate;
+                }
+                break;
+            case Opcode::ble:
+                if (r[instruction.rs] <= r[instruction.rt]) {
+                    pc = instruction.immediate;
+                }
+                break;
+            case Opcode::beq:
+                if (r[instruction.rs] == r[instruction.rt]) {
+                    pc = instruction.immediate;
+                }
+                break;
+            case Opcode::bne:
+                if (r[instruction.rs] != r[instruction.rt]) {
+                    pc = instruction.immediate;
+                }
+                break;
+            case Opcode::jal:
+                r[reg::RegToNumber(Reg::ra)] = pc;
+                pc = instruction.immediate;
+                break;
+            case Opcode::jr:
+                pc = r[instruction.rs];
+                break;
+            case Opcode::j:
+                pc = instruction.immediate;
+                break;
+            case Opcode::la:
+            case Opcode::li:
+                r[instruction.rd] = instruction.immediate;
+                break;
+            case Opcode::move:
+                r[instruction.rd] = r[instruction.rs];
+                break;
+            case Opcode::syscall:
+                if (!Syscall(input, output, is_exit)) {
+                    return false;
+                }
+                break;
+            case Opcode::nop:
+                break;
+        }
+        r[0] = 0;
+    }
+    return true;
+}
+
+long long MipsSimulator::step_count() const {
+    return step_count_;
+}
+
+string MipsSimulator::error() const {
+    return error_;
+}
\ No newline at end of file
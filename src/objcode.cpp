@@ -4,6 +4,7 @@ using namespace std;
 
 Objcode::Objcode(const string &mipsFile) {
     this->mips_.open(mipsFile);
+    this->instruction_count_ = 0;
 }
 
 void Objcode::Output() {
@@ -13,9 +14,11 @@ void Objcode::Output() {
 void Objcode::Output(MipsInstr instr) {
     switch (instr) {
         case (MipsInstr::syscall):
+            instruction_count_++;
             mips_ << "syscall" << endl;
             break;
         case (MipsInstr::nop):
+            instruction_count_++;
             mips_ << "nop" << endl;
             break;
         case (MipsInstr::data):
@@ -30,6 +33,7 @@ void Objcode::Output(MipsInstr instr) {
 }
 
 void Objcode::Output(MipsInstr instr, Reg t0) {
+    instruction_count_++;
     switch (instr) {
         case (MipsInstr::jr):
             mips_ << "jr " << reg::RegToString(t0) << endl;
@@ -52,9 +56,11 @@ void Objcode::Output(MipsInstr instr, int value) {
 void Objcode::Output(MipsInstr instr, const string &label) {
     switch (instr) {
         case (MipsInstr::jal):
+            instruction_count_++;
             mips_ << "jal " << label << endl;
             break;
         case (MipsInstr::j):
+            instruction_count_++;
             mips_ << "j " << label << endl;
             break;
         case (MipsInstr::label):
@@ -69,6 +75,7 @@ void Objcode::Output(MipsInstr instr, const string &label) {
 }
 
 void Objcode::Output(MipsInstr instr, Reg t0, Reg t1) {
+    instruction_count_++;
     switch (instr) {
         case (MipsInstr::move):
             mips_ << "move " << reg::RegToString(t0) << " " << reg::RegToString(t1) << endl;
@@ -79,6 +86,7 @@ void Objcode::Output(MipsInstr instr, Reg t0, Reg t1) {
 }
 
 void Objcode::Output(MipsInstr instr, Reg t0, int value) {
+    instruction_count_++;
     switch (instr) {
         case (MipsInstr::li):
             mips_ << "li " << reg::RegToString(t0) << " " << value << endl;
@@ -89,6 +97,7 @@ void Objcode::Output(MipsInstr instr, Reg t0, int value) {
 }
 
 void Objcode::Output(MipsInstr instr, Reg t0, const string &label) {
+    instruction_count_++;
     switch (instr) {
         case (MipsInstr::la):
             mips_ << "la " << reg::RegToString(t0) << " " << label << endl;
@@ -99,6 +108,7 @@ void Objcode::Output(MipsInstr instr, Reg t0, const string &label) {
 }
 
 void Objcode::Output(MipsInstr instr, Reg t0, Reg t1, Reg t2) {
+    instruction_count_++;
     switch (instr) {
         case (MipsInstr::add):
             mips_ << "add " << reg::RegToString(t0) << " " << reg::RegToString(t1)
@@ -132,6 +142,7 @@ void Objcode::Output(MipsInstr instr, const string &label, int value) {
 }
 
 void Objcode::Output(MipsInstr instr, Reg t0, Reg t1, int value) {
+    instruction_count_++;
     switch (instr) {
         case (MipsInstr::addi):
             mips_ << "addi " << reg::RegToString(t0) << " " << reg::RegToString(t1)
@@ -167,6 +178,7 @@ void Objcode::Output(MipsInstr instr, Reg t0, Reg t1, int value) {
 }
 
 void Objcode::Output(MipsInstr instr, Reg t0, Reg t1, const string &label) {
+    instruction_count_++;
     switch (instr) {
         case (MipsInstr::lw):
             mips_ << "lw " << reg::RegToString(t0) << " " << label << "("
@@ -205,6 +217,10 @@ void Objcode::Output(MipsInstr instr, Reg t0, Reg t1, const string &label) {
     }
 }
 
+int Objcode::instruction_count() const {
+    return instruction_count_;
+}
+
 void Objcode::FileClose() {
     this->mips_.close();
 }
\ No newline at end of file
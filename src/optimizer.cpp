@@ -0,0 +1,334 @@
+﻿#include "optimizer.h"
+#include "profiler.h"
+
+#include <set>
+#include <utility>
+
+using namespace std;
+
+Optimizer::Optimizer(list<Midcode *> midcode_list) {
+    midcode_list_ = std::move(midcode_list);
+}
+
+Optimizer::~Optimizer() {
+    for (Midcode *midcode : created_list_) {
+        delete midcode;
+    }
+}
+
+bool Optimizer::IsInteger(const string &str) {
+    if (str.empty()) {
+        return false;
+    }
+    for (char i : str) {
+        if (!isdigit(i) && i != '+' && i != '-') {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Optimizer::IsChar(const string &str) {
+    return !str.empty() && str[0] == '\'';
+}
+
+bool Optimizer::IsTemporary(const string &str) {
+    return str.length() > 1 && str[0] == '#' && isdigit(str[1]);
+}
+
+int Optimizer::GetValue(const string &str) {
+    return IsChar(str) ? (int) str[1] : stoi(str);
+}
+
+string Optimizer::Replace(const string &value, const map<string, string> &constant_map) {
+    if (!IsTemporary(value)) {
+        return value;
+    }
+    auto iter = constant_map.find(value);
+    return iter == constant_map.end() ? value : iter->second;
+}
+
+void Optimizer::GetOperand(Midcode *midcode, string &value1, string &value2) {
+    switch (midcode->opera_member()) {
+        case OperaMember::REG_OP_REG:
+            value1 = midcode->GetTempReg1();
+            value2 = midcode->GetTempReg2();
+            break;
+        case OperaMember::REG_OP_NUMBER:
+            value1 = midcode->GetTempReg1();
+            value2 = midcode->reg2();
+            break;
+        case OperaMember::NUMBER_OP_REG:
+            value1 = midcode->reg2();
+            value2 = midcode->GetTempReg1();
+            break;
+        case OperaMember::NUMBER_OP_NUMBER:
+            value1 = midcode->reg1();
+            value2 = midcode->reg2();
+            break;
+    }
+}
+
+vector<string> Optimizer::GetUseList(Midcode *midcode) {
+    string value1;
+    string value2;
+
+    switch (midcode->instr()) {
+        case MidcodeInstr::PRINTF_INT:
+        case MidcodeInstr::PRINTF_CHAR:
+        case MidcodeInstr::RETURN:
+            return {midcode->label()};
+        case MidcodeInstr::ASSIGN:
+        case MidcodeInstr::NEG:
+        case MidcodeInstr::BEZ:
+        case MidcodeInstr::BNZ:
+            return {midcode->reg1()};
+        case MidcodeInstr::LOAD_ARRAY:
+        case MidcodeInstr::PUSH:
+            return {midcode->reg2()};
+        case MidcodeInstr::ASSIGN_ARRAY:
+        case MidcodeInstr::BGT:
+        case MidcodeInstr::BGE:
+        case MidcodeInstr::BLT:
+        case MidcodeInstr::BLE:
+        case MidcodeInstr::BEQ:
+        case MidcodeInstr::BNE:
+            return {midcode->reg1(), midcode->reg2()};
+        case MidcodeInstr::ADD:
+        case MidcodeInstr::SUB:
+        case MidcodeInstr::MUL:
+        case MidcodeInstr::DIV:
+            GetOperand(midcode, value1, value2);
+            return {value1, value2};
+        default:
+            return {};
+    }
+}
+
+string Optimizer::GetDefine(Midcode *midcode) {
+    switch (midcode->instr()) {
+        case MidcodeInstr::ASSIGN:
+            return IsTemporary(midcode->reg_result()) ? midcode->reg_result() : "";
+        case MidcodeInstr::NEG:
+        case MidcodeInstr::LOAD:
+        case MidcodeInstr::LOAD_ARRAY:
+            return midcode->GetTempReg();
+        case MidcodeInstr::ADD:
+        case MidcodeInstr::SUB:
+        case MidcodeInstr::MUL:
+        case MidcodeInstr::DIV:
+            return midcode->reg_result().empty() ? midcode->GetTempRegResult() : "";
+        default:
+            return "";
+    }
+}
+
+Midcode *Optimizer::BuildOperate(MidcodeInstr instr, int temp_result, const string &value1, const string &value2) {
+    if (IsTemporary(value1) && IsTemporary(value2)) {
+        return new Midcode(instr, OperaMember::REG_OP_REG, temp_result,
+                           stoi(value1.substr(1)), stoi(value2.substr(1)));
+    } else if (IsTemporary(value1)) {
+        return new Midcode(instr, OperaMember::REG_OP_NUMBER, temp_result, stoi(value1.substr(1)), value2);
+    } else if (IsTemporary(value2)) {
+        return new Midcode(instr, OperaMember::NUMBER_OP_REG, temp_result, stoi(value2.substr(1)), value1);
+    } else {
+        return new Midcode(instr, OperaMember::NUMBER_OP_NUMBER, temp_result, value1, value2);
+    }
+}
+
+Midcode *Optimizer::FoldMidcode(Midcode *midcode, map<string, string> &constant_map) {
+    string value1;
+    string value2;
+
+    switch (midcode->instr()) {
+        case MidcodeInstr::PRINTF_INT:
+        case MidcodeInstr::PRINTF_CHAR:
+        case MidcodeInstr::RETURN:
+            value1 = Replace(midcode->label(), constant_map);
+            return value1 == midcode->label() ? midcode : new Midcode(midcode->instr(), value1);
+        case MidcodeInstr::ASSIGN:
+            value1 = Replace(midcode->reg1(), constant_map);
+            if (IsTemporary(midcode->reg_result()) && (IsInteger(value1) || IsChar(value1))) {
+                constant_map[midcode->reg_result()] = value1;
+            }
+            return value1 == midcode->reg1() ? midcode
+                                             : new Midcode(MidcodeInstr::ASSIGN, midcode->reg_result(), value1);
+        case MidcodeInstr::ASSIGN_ARRAY:
+            value1 = Replace(midcode->reg1(), constant_map);
+            value2 = Replace(midcode->reg2(), constant_map);
+            return value1 == midcode->reg1() && value2 == midcode->reg2()
+                   ? midcode : new Midcode(MidcodeInstr::ASSIGN_ARRAY, midcode->reg_result(), value1, value2);
+        case MidcodeInstr::LOAD_ARRAY:
+            value2 = Replace(midcode->reg2(), constant_map);
+            return value2 == midcode->reg2()
+                   ? midcode : new Midcode(MidcodeInstr::LOAD_ARRAY, midcode->reg1(), value2, midcode->count());
+        case MidcodeInstr::PUSH:
+            value2 = Replace(midcode->reg2(), constant_map);
+            return value2 == midcode->reg2()
+                   ? midcode : new Midcode(MidcodeInstr::PUSH, midcode->reg1(), value2, midcode->count());
+        case MidcodeInstr::BEZ:
+        case MidcodeInstr::BNZ:
+            value1 = Replace(midcode->reg1(), constant_map);
+            return value1 == midcode->reg1() ? midcode : new Midcode(midcode->instr(), value1, midcode->count());
+        case MidcodeInstr::BGT:
+        case MidcodeInstr::BGE:
+        case MidcodeInstr::BLT:
+        case MidcodeInstr::BLE:
+        case MidcodeInstr::BEQ:
+        case MidcodeInstr::BNE:
+            value1 = Replace(midcode->reg1(), constant_map);
+            value2 = Replace(midcode->reg2(), constant_map);
+            return value1 == midcode->reg1() && value2 == midcode->reg2()
+                   ? midcode : new Midcode(midcode->instr(), value1, value2, midcode->count());
+        case MidcodeInstr::NEG:
+            value1 = Replace(midcode->reg1(), constant_map);
+            if (IsInteger(value1) || IsChar(value1)) {
+                string result = to_string((int) (0u - (unsigned) GetValue(value1)));
+                constant_map[midcode->GetTempReg()] = result;
+                return new Midcode(MidcodeInstr::ASSIGN, midcode->GetTempReg(), result);
+            }
+            return value1 == midcode->reg1() ? midcode : new Midcode(MidcodeInstr::NEG, midcode->count(), value1);
+        case MidcodeInstr::ADD:
+        case MidcodeInstr::SUB:
+        case MidcodeInstr::MUL:
+        case MidcodeInstr::DIV: {
+            if (!midcode->reg_result().empty()) {
+                return midcode;
+            }
+            GetOperand(midcode, value1, value2);
+            string new_value1 = Replace(value1, constant_map);
+            string new_value2 = Replace(value2, constant_map);
+            int result;
+            if ((IsInteger(new_value1) || IsChar(new_value1))
+                && (IsInteger(new_value2) || IsChar(new_value2))
+                && midcodeinstr::Calculate(midcode->instr(), GetValue(new_value1), GetValue(new_value2), result)) {
+                constant_map[midcode->GetTempRegResult()] = to_string(result);
+                return new Midcode(MidcodeInstr::ASSIGN, midcode->GetTempRegResult(), to_string(result));
+            }
+            if (new_value1 == value1 && new_value2 == value2) {
+                return midcode;
+            }
+            return BuildOperate(midcode->instr(), midcode->temp_result(), new_value1, new_value2);
+        }
+        case MidcodeInstr::LABEL:
+        case MidcodeInstr::INT_FUNC_DECLARE:
+        case MidcodeInstr::CHAR_FUNC_DECLARE:
+        case MidcodeInstr::VOID_FUNC_DECLARE:
+            constant_map.clear();
+            return midcode;
+        default:
+            return midcode;
+    }
+}
+
+// A temporary can be defined again later in its function, so a definition that does not fold
+// to a constant drops whatever constant the temporary held before.
+void Optimizer::FoldConstant() {
+    map<string, string> constant_map;
+
+    for (auto &midcode : midcode_list_) {
+        string define = GetDefine(midcode);
+        Midcode *folded = FoldMidcode(midcode, constant_map);
+        if (folded != midcode) {
+            created_list_.push_back(folded);
+            midcode = folded;
+        }
+        if (!define.empty() && !(midcode->instr() == MidcodeInstr::ASSIGN
+                                 && (IsInteger(midcode->reg1()) || IsChar(midcode->reg1())))) {
+            constant_map.erase(define);
+        }
+    }
+}
+
+bool Optimizer::IsFunctionDeclare(Midcode *midcode) {
+    return midcode->instr() == MidcodeInstr::INT_FUNC_DECLARE
+           || midcode->instr() == MidcodeInstr::CHAR_FUNC_DECLARE
+           || midcode->instr() == MidcodeInstr::VOID_FUNC_DECLARE;
+}
+
+// begin is a function declaration (or the first global), which is never removed. A temporary
+// is reused once its value is consumed but never lives across a label or jump, so walking the
+// function backwards, a definition is dead when no use of it has been seen since its next one.
+void Optimizer::RemoveDeadTemporary(list<Midcode *>::iterator begin, list<Midcode *>::iterator end) {
+    set<string> live_set;
+
+    auto iter = end;
+    while (iter != begin) {
+        iter--;
+        string define = GetDefine(*iter);
+        if (!define.empty()) {
+            if (live_set.erase(define) == 0) {
+                iter = midcode_list_.erase(iter);
+                continue;
+            }
+        }
+        for (auto &value : GetUseList(*iter)) {
+            if (IsTemporary(value)) {
+                live_set.insert(value);
+            }
+        }
+    }
+}
+
+// Temporaries are numbered per function, so their uses are counted one function at a time.
+void Optimizer::RemoveDeadTemporary() {
+    auto begin = midcode_list_.begin();
+    while (begin != midcode_list_.end()) {
+        auto end = begin;
+        for (end++; end != midcode_list_.end() && !IsFunctionDeclare(*end); end++) {
+        }
+        RemoveDeadTemporary(begin, end);
+        begin = end;
+    }
+}
+
+void Optimizer::RemoveRedundantJump() {
+    auto iter = midcode_list_.begin();
+
+    while (iter != midcode_list_.end()) {
+        if ((*iter)->instr() != MidcodeInstr::JUMP) {
+            iter++;
+            continue;
+        }
+
+        bool is_redundant = false;
+        auto next = iter;
+        for (next++; next != midcode_list_.end(); next++) {
+            if ((*next)->instr() == MidcodeInstr::LABEL) {
+                if ((*next)->count() == (*iter)->count()) {
+                    is_redundant = true;
+                    break;
+                }
+            } else if ((*next)->instr() != MidcodeInstr::LOOP) {
+                break;
+            }
+        }
+
+        if (is_redundant) {
+            iter = midcode_list_.erase(iter);
+        } else {
+            iter++;
+        }
+    }
+}
+
+void Optimizer::Optimize(int optimize_level) {
+    if (optimize_level < 2) {
+        return;
+    }
+    Profiler *profiler = Profiler::GetInstance();
+
+    profiler->Begin("FoldConstant");
+    FoldConstant();
+    profiler->End();
+    profiler->Begin("RemoveDeadTemporary");
+    RemoveDeadTemporary();
+    profiler->End();
+    profiler->Begin("RemoveRedundantJump");
+    RemoveRedundantJump();
+    profiler->End();
+}
+
+list<Midcode *> Optimizer::midcode_list() {
+    return midcode_list_;
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+﻿#include "parallel_lexer.h"
+
+#include <cstring>
+#include <thread>
+#include <utility>
+
+using namespace std;
+
+struct Chunk {
+    size_t begin;
+    size_t limit;
+    Interner interner;
+    ErrorHanding error_handing;
+    vector<Lexeme> lexeme_list;
+    size_t token_end;       // where the last token of the chunk ends
+};
+
+ParallelLexer::ParallelLexer(const SourceBuffer *source, Interner *interner, ErrorHanding *error_handing,
+                             int job_count) {
+    source_ = source;
+    interner_ = interner;
+    error_handing_ = error_handing;
+    job_count_ = job_count;
+}
+
+vector<struct Lexeme> *ParallelLexer::Analyze() {
+    size_t size = source_->size();
+    size_t chunk_size = max((size_t) PARALLEL_LEX_CHUNK, size / job_count_ + 1);
+
+    vector<size_t> cut_list = {0};
+    while (size - cut_list.back() > chunk_size) {
+        const char *from = source_->data() + cut_list.back() + chunk_size;
+        auto newline = (const char *) memchr(from, '\n', size - (from - source_->data()));
+        if (newline == nullptr) {
+            break;
+        }
+        cut_list.push_back(newline + 1 - source_->data());
+    }
+    cut_list.push_back(size);
+
+    vector<Chunk> chunk_list(cut_list.size() - 1);
+    vector<thread> worker_list;
+    for (size_t i = 0; i < chunk_list.size(); i++) {
+        chunk_list[i].begin = cut_list[i];
+        chunk_list[i].limit = cut_list[i + 1];
+        worker_list.emplace_back([this, &chunk_list, i]() {
+            Chunk &chunk = chunk_list[i];
+            LexicalAnalyser lexical_analyser(source_, chunk.begin, chunk.limit, &chunk.interner, &chunk.error_handing);
+            Lexeme lexeme;
+            chunk.lexeme_list.reserve((chunk.limit - chunk.begin) / 3 + 16);
+            while (lexical_analyser.Next(lexeme)) {
+                chunk.lexeme_list.push_back(lexeme);
+            }
+            chunk.token_end = lexical_analyser.token_end();
+        });
+    }
+    for (thread &worker : worker_list) {
+        worker.join();
+    }
+
+    bool is_safe = true;
+    size_t token_count = 0;
+    for (const Chunk &chunk : chunk_list) {
+        is_safe = is_safe && chunk.token_end <= chunk.limit;
+        token_count += chunk.lexeme_list.size();
+    }
+    if (!is_safe) {
+        LexicalAnalyser lexical_analyser(source_, interner_, error_handing_);
+        lexeme_list_ = move(*lexical_analyser.Analyze());
+        return &lexeme_list_;
+    }
+
+    // interning chunk by chunk keeps ids in first-seen order, as the serial lexer assigns them
+    lexeme_list_.reserve(token_count);
+    for (Chunk &chunk : chunk_list) {
+        vector<int> id_map(chunk.interner.size());
+        for (int id = 0; id < chunk.interner.size(); id++) {
+            id_map[id] = interner_->Intern(chunk.interner.Name(id));
+        }
+        for (Lexeme &lexeme : chunk.lexeme_list) {
+            if (lexeme.symbol_id != NO_IDENTIFIER) {
+                lexeme.symbol_id = id_map[lexeme.symbol_id];
+            }
+            lexeme_list_.push_back(lexeme);
+        }
+        error_handing_->Append(chunk.error_handing);
+    }
+    return &lexeme_list_;
+}
\ No newline at end of file
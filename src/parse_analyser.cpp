@@ -1,179 +1,263 @@
 ﻿#include "parse_analyser.h"
 
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
 #include <utility>
+#include "profiler.h"
 
 using namespace std;
 
-ParseAnalyser::ParseAnalyser(const string &fileName, list<struct Lexeme> *lexList, ErrorHanding *errorHanding) {
-    this->check_table_ = new CheckTable();
+static mutex interner_mutex;    // function jobs share the Interner with each other
+
+ParseAnalyser::ParseAnalyser(const string &fileName, const SourceBuffer *source, TokenStream *token_stream,
+                             Interner *interner, ErrorHanding *errorHanding) {
+    this->symbol_arena_ = new SymbolArena();
+    this->check_table_ = new CheckTable(interner, symbol_arena_);
+    this->check_table_->SetTable(0, this->NewSymbolTable());
     this->string_table_ = new StringTable();
     this->midcode_generator_ = new MidcodeGenerator();
 
     this->label_count_ = 0;
     this->reg_count_ = 1;
+    this->reg_max_ = 0;
+    this->temp_count_ = 0;
+    this->syntax_tree_ = nullptr;
+    this->syntax_node_count_ = 0;
     this->midcode_generator_->OpenMidcodeFile(fileName);
-    this->iter_ = lexList->begin();
-    this->iter_end_ = lexList->end();
+    this->source_ = source;
+    this->token_stream_ = token_stream;
+    this->interner_ = interner;
     this->error_handing_ = errorHanding;
+    this->job_list_ = nullptr;
+    this->function_order_ = nullptr;
+    this->function_limit_ = 0;
 }
 
-void ParseAnalyser::CountIterator(int step) {
-    if (step > 0) {
-        while (step--) {
-            iter_++;
-        }
-    } else {
-        while (step++) {
-            iter_--;
+// A worker for one function body: level 0 is the parent's global table, level 1 the table the
+// header was analysed into, and everything the body generates goes to the job.
+ParseAnalyser::ParseAnalyser(const ParseAnalyser &parent, FunctionJob &job, TokenStream *token_stream) {
+    this->symbol_arena_ = nullptr;
+    this->check_table_ = new CheckTable(parent.interner_, job.symbol_arena);
+    this->check_table_->SetTable(0, parent.check_table_->GetSymbolTable(0));
+    this->check_table_->SetTable(1, job.symbol_table);
+    this->string_table_ = job.string_table;
+    this->midcode_generator_ = job.midcode_generator;
+
+    this->label_count_ = 0;
+    this->reg_count_ = 1;
+    this->reg_max_ = 0;
+    this->temp_count_ = 0;
+    this->syntax_tree_ = nullptr;
+    this->syntax_node_count_ = 0;
+    this->source_ = parent.source_;
+    this->token_stream_ = token_stream;
+    this->interner_ = parent.interner_;
+    this->error_handing_ = job.error_handing;
+    this->job_list_ = nullptr;
+    this->function_order_ = &parent.function_order_map_;
+    this->function_limit_ = job.order;
+}
+
+// A worker's generator and string table belong to its job, which the merge frees.
+ParseAnalyser::~ParseAnalyser() {
+    if (symbol_arena_ != nullptr) {
+        for (Midcode *midcode : midcode_generator_->midcode_list()) {
+            delete midcode;
         }
+        delete midcode_generator_;
+        delete string_table_;
+    }
+    delete check_table_;
+    for (SymbolTable *symbol_table : symbol_table_list_) {
+        delete symbol_table;
+    }
+    delete symbol_arena_;
+}
+
+const Lexeme &ParseAnalyser::Peek(int k) {
+    return token_stream_->Peek(k);
+}
+
+int ParseAnalyser::LineNumber(int k) {
+    return source_->Line(Peek(k).offset);
+}
+
+void ParseAnalyser::Advance() {
+    token_stream_->Advance();
+}
+
+// Only IDENFR tokens are interned by the lexer; main is a keyword, and a malformed program
+// can declare any token, so those spellings are interned here on first declaration.
+int ParseAnalyser::SymbolId(bool is_declare) {
+    if (Peek().symbol_id != NO_IDENTIFIER) {
+        return Peek().symbol_id;
     }
+    if (is_declare) {
+        return interner_->Intern(Peek().value);
+    }
+    if (function_order_ == nullptr) {
+        return interner_->Find(Peek().value);
+    }
+    lock_guard<mutex> lock(interner_mutex);
+    return interner_->Find(Peek().value);
 }
 
 Symbol *ParseAnalyser::InsertIdentifier(KindSymbol kind, TypeSymbol type, int level) {
-    return check_table_->AddSymbol(iter_->value, kind, type, level);
+    if (function_order_ == nullptr) {
+        return check_table_->AddSymbol(this->SymbolId(true), kind, type, level);
+    }
+    lock_guard<mutex> lock(interner_mutex);    // AddSymbol reads the spelling back from the Interner
+    return check_table_->AddSymbol(this->SymbolId(true), kind, type, level);
 }
 
 void ParseAnalyser::InsertSymbolTable(const string & name, int level) {
     symbol_table_map_.insert(pair<string, SymbolTable *>(name, check_table_->GetSymbolTable(level)));
 }
 
-void ParseAnalyser::CleanLevel(int level) {
-    check_table_->ClearLevel(level);
+// Tables are created only by the serial parser (a job's table comes from the pre-scan) and
+// live as long as it does, since the backends read them through symbol_table_map.
+SymbolTable *ParseAnalyser::NewSymbolTable() {
+    auto symbol_table = new SymbolTable();
+    symbol_table_list_.push_back(symbol_table);
+    return symbol_table;
+}
+
+void ParseAnalyser::OpenFunctionScope() {
+    check_table_->SetTable(1, this->NewSymbolTable());
 }
 
 Symbol *ParseAnalyser::FindSymbol() {
-    return check_table_->FindSymbol(iter_->value);
+    return this->VisibleSymbol(check_table_->FindSymbol(this->SymbolId(false)));
 }
 
 Symbol *ParseAnalyser::FindSymbol(int level) {
-    return check_table_->FindSymbol(iter_->value, level);
+    return this->VisibleSymbol(check_table_->FindSymbol(this->SymbolId(false), level));
+}
+
+// The global table of a function job already holds every function; hide the ones declared
+// after it, which a serial parse would not have seen yet.
+Symbol *ParseAnalyser::VisibleSymbol(Symbol *symbol) {
+    if (symbol != nullptr && function_order_ != nullptr && symbol->kind() == KindSymbol::FUNCTION
+        && function_order_->at(symbol->id()) > function_limit_) {
+        return nullptr;
+    }
+    return symbol;
 }
 
-bool ParseAnalyser::IsThisIdentifier(const string &identifier) {
-    return iter_->identifier == identifier;
+bool ParseAnalyser::IsThisIdentifier(TokenKind kind, int k) {
+    return Peek(k).kind == kind;
 }
 
 bool ParseAnalyser::IsPlusOrMinu() {
-    return IsThisIdentifier(PLUS) || IsThisIdentifier(MINU);
+    return IsThisIdentifier(TokenKind::PLUS) || IsThisIdentifier(TokenKind::MINU);
 }
 
 bool ParseAnalyser::IsMultOrDiv() {
-    return IsThisIdentifier(MULT) || IsThisIdentifier(DIV);
+    return IsThisIdentifier(TokenKind::MULT) || IsThisIdentifier(TokenKind::DIV);
 }
 
 bool ParseAnalyser::IsVariableDefine() {
-    if (this->IsThisIdentifier(INTTK) || this->IsThisIdentifier(CHARTK)) {
-        this->CountIterator(+2);
-        if (this->IsThisIdentifier(LPARENT)) {
-            this->CountIterator(-2);
-            return false;
-        } else {
-            this->CountIterator(-2);
-            return true;
-        }
-    } else {
-        return false;
-    }
+    return (this->IsThisIdentifier(TokenKind::INTTK) || this->IsThisIdentifier(TokenKind::CHARTK))
+           && !this->IsThisIdentifier(TokenKind::LPARENT, 2);
 }
 
 void ParseAnalyser::AddChild(SyntaxNode *node) {
-    node->AddChild(new SyntaxNode(iter_->identifier, iter_->value));
-    this->CountIterator(+1);
+    if (syntax_tree_ != nullptr) {
+        syntax_tree_->AddToken(node, Peek());
+    }
+    this->Advance();
 }
 
 void ParseAnalyser::AddCommaChild(SyntaxNode *node) {
-    if (this->IsThisIdentifier(COMMA)) {
+    if (this->IsThisIdentifier(TokenKind::COMMA)) {
         this->AddChild(node);
     }
 }
 
 void ParseAnalyser::AddSemicnChild(SyntaxNode *node) {
-    if (this->IsThisIdentifier(SEMICN)) {
+    if (this->IsThisIdentifier(TokenKind::SEMICN)) {
         this->AddChild(node);    // SEMICN
     } else {
-        this->CountIterator(-1);
-        error_handing_->AddError(iter_->line_number, MISSING_SEMICN);
-        this->CountIterator(+1);
+        error_handing_->AddError(this->LineNumber(-1), MISSING_SEMICN);
     }
 }
 
 void ParseAnalyser::AddWhileChild(SyntaxNode *node) {
-    if (this->IsThisIdentifier(WHILETK)) {
+    if (this->IsThisIdentifier(TokenKind::WHILETK)) {
         this->AddChild(node);    // WHILETK
     } else {
-        this->CountIterator(-1);
-        error_handing_->AddError(iter_->line_number, MISSING_WHILE_IN_DO_WHILE);
-        this->CountIterator(+1);
+        error_handing_->AddError(this->LineNumber(-1), MISSING_WHILE_IN_DO_WHILE);
     }
 }
 
 void ParseAnalyser::AddRbrackChild(SyntaxNode *node) {
-    if (this->IsThisIdentifier(RBRACK)) {
+    if (this->IsThisIdentifier(TokenKind::RBRACK)) {
         this->AddChild(node);    // RBRACK
     } else {
-        this->CountIterator(-1);
-        error_handing_->AddError(iter_->line_number, MISSING_RBRACK);
-        this->CountIterator(+1);
+        error_handing_->AddError(this->LineNumber(-1), MISSING_RBRACK);
     }
 }
 
 void ParseAnalyser::AddRparentChild(SyntaxNode *node) {
-    if (this->IsThisIdentifier(RPARENT)) {
+    if (this->IsThisIdentifier(TokenKind::RPARENT)) {
         this->AddChild(node);    // RPARENT
     } else {
-        this->CountIterator(-1);
-        error_handing_->AddError(iter_->line_number, MISSING_RPARENT);
-        this->CountIterator(+1);
+        error_handing_->AddError(this->LineNumber(-1), MISSING_RPARENT);
     }
 }
 
-SyntaxNode *ParseAnalyser::AddSyntaxChild(const string & syntaxName, SyntaxNode *node) {
-    auto subRoot = new SyntaxNode(syntaxName);
-    node->AddChild(subRoot);
-    return subRoot;
+// Without a tree every node is nullptr and only the checks and midcode are produced.
+SyntaxNode *ParseAnalyser::AddSyntaxChild(SyntaxKind kind, SyntaxNode *node) {
+    return syntax_tree_ != nullptr ? syntax_tree_->AddSyntax(node, kind) : nullptr;
 }
 
 void ParseAnalyser::SetSymbolType(TypeSymbol &type) {
-    type = iter_->identifier == INTTK ? TypeSymbol::INT : TypeSymbol::CHAR;
+    type = Peek().kind == TokenKind::INTTK ? TypeSymbol::INT : TypeSymbol::CHAR;
 }
 
 int ParseAnalyser::AnalyzeInteger(SyntaxNode *node) {
     int op = 1;
     if (this->IsPlusOrMinu()) {
-        if (this->IsThisIdentifier(MINU)) {
+        if (this->IsThisIdentifier(TokenKind::MINU)) {
             op = -1;
         }
         this->AddChild(node);
     }
 
-    int integer = op * stoi(iter_->value);
-    this->AddChild(this->AddSyntaxChild(UNSIGNINT, node));        // INTCON
+    int integer = op * stoi(Peek().value);
+    this->AddChild(this->AddSyntaxChild(SyntaxKind::UNSIGNINT, node));        // INTCON
 
     return integer;
 }
 
 void ParseAnalyser::AnalyzeConstDefine(SyntaxNode *node, int level) {
-    auto symbol = new Symbol();
     TypeSymbol type;
     this->SetSymbolType(type);
     this->AddChild(node);    // INTTK or CHARTK
 
-    while (this->IsThisIdentifier(IDENFR)) {
+    while (this->IsThisIdentifier(TokenKind::IDENFR)) {
+        Symbol *symbol = nullptr;    // stays nullptr for a redefinition, whose value is dropped
         if (this->FindSymbol(level)) {
-            error_handing_->AddError(iter_->line_number, REDEFINITION);
+            error_handing_->AddError(this->LineNumber(), REDEFINITION);
         } else {
             symbol = this->InsertIdentifier(KindSymbol::CONST, type, level);
         }
         this->AddChild(node);    // IDENFR
         this->AddChild(node);    // ASDSIGN
-        if (this->IsThisIdentifier(CHARCON)) {
-            symbol->set_const_value("\'" + iter_->value + "\'");
+        if (this->IsThisIdentifier(TokenKind::CHARCON)) {
+            if (symbol != nullptr) {
+                symbol->set_const_value(Peek().value[0]);
+            }
             this->AddChild(node);    // CHARCON
-        } else if (this->IsThisIdentifier(INTCON) || this->IsPlusOrMinu()) {
-            int value = this->AnalyzeInteger(this->AddSyntaxChild(INTEGER, node));
-            symbol->set_const_value(to_string(value));
+        } else if (this->IsThisIdentifier(TokenKind::INTCON) || this->IsPlusOrMinu()) {
+            int value = this->AnalyzeInteger(this->AddSyntaxChild(SyntaxKind::INTEGER, node));
+            if (symbol != nullptr) {
+                symbol->set_const_value(value);
+            }
         } else {
-            error_handing_->AddError(iter_->line_number, DEFINE_CONST_OTHERS);
+            error_handing_->AddError(this->LineNumber(), DEFINE_CONST_OTHERS);
             this->AddChild(node);
         }
         this->AddCommaChild(node);    // COMMA
@@ -181,9 +265,9 @@ void ParseAnalyser::AnalyzeConstDefine(SyntaxNode *node, int level) {
 }
 
 void ParseAnalyser::AnalyzeConstDeclare(SyntaxNode *node, int level) {
-    while (this->IsThisIdentifier(CONSTTK)) {
+    while (this->IsThisIdentifier(TokenKind::CONSTTK)) {
         this->AddChild(node);    // CONSTTK
-        this->AnalyzeConstDefine(this->AddSyntaxChild(CONST_DEFINE, node), level);
+        this->AnalyzeConstDefine(this->AddSyntaxChild(SyntaxKind::CONST_DEFINE, node), level);
         this->AddSemicnChild(node);    // SEMICN
     }
 }
@@ -192,18 +276,18 @@ void ParseAnalyser::AnalyzeVariableDefine(SyntaxNode *node, int level) {
     TypeSymbol type;
     SetSymbolType(type);
     this->AddChild(node);    // INTTK or CHARTK
-    while (this->IsThisIdentifier(IDENFR)) {
+    while (this->IsThisIdentifier(TokenKind::IDENFR)) {
         if (this->FindSymbol(level)) {
-            error_handing_->AddError(iter_->line_number, REDEFINITION);
+            error_handing_->AddError(this->LineNumber(), REDEFINITION);
         }
         Symbol *symbol = this->InsertIdentifier(KindSymbol::VARIABLE, type, level);
-        this->midcode_generator_->PrintVariable(type, iter_->value);
+        this->midcode_generator_->PrintVariable(type, Peek().value);
         this->AddChild(node);    // IDENFR
 
-        if (this->IsThisIdentifier(LBRACK)) {
+        if (this->IsThisIdentifier(TokenKind::LBRACK)) {
             this->AddChild(node);    // LBRACK
-            int arrayLength = stoi(iter_->value);
-            this->AddChild(this->AddSyntaxChild(UNSIGNINT, node));    // INTCON
+            int arrayLength = stoi(Peek().value);
+            this->AddChild(this->AddSyntaxChild(SyntaxKind::UNSIGNINT, node));    // INTCON
             this->AddRbrackChild(node);
 
             symbol->set_kind(KindSymbol::ARRAY);
@@ -215,291 +299,229 @@ void ParseAnalyser::AnalyzeVariableDefine(SyntaxNode *node, int level) {
 
 void ParseAnalyser::AnalyzeVariableDeclare(SyntaxNode *node, int level) {
     while (this->IsVariableDefine()) {
-        this->AnalyzeVariableDefine(this->AddSyntaxChild(VARIABLE_DEFINE, node), level);
+        this->AnalyzeVariableDefine(this->AddSyntaxChild(SyntaxKind::VARIABLE_DEFINE, node), level);
         this->AddSemicnChild(node);    // SEMICN
     }
 }
 
 void ParseAnalyser::AnalyzeValuePrameterTable(SyntaxNode *node, Symbol *function) {
-    if (this->IsThisIdentifier(RPARENT)) {
+    if (this->IsThisIdentifier(TokenKind::RPARENT)) {
         if (function != nullptr && function->GetParameterCount() != 0) {
-            error_handing_->AddError(iter_->line_number, FUNCTION_PARAMETER_NUMBER_DONT_MATCH);
+            error_handing_->AddError(this->LineNumber(), FUNCTION_PARAMETER_NUMBER_DONT_MATCH);
         }
         return;
     }
 
-    string str;
+    vector<TypeSymbol> type_list;
     TypeSymbol type;
     int count = 0;
-    if (!this->IsThisIdentifier(RPARENT)) {
-        SyntaxNode *expressionNode;
-        expressionNode = this->AddSyntaxChild(EXPRESSION, node);
-        type = this->AnalyzeExpression(expressionNode);
-        str.push_back(type == TypeSymbol::INT ? '0' : '1');
-        midcode_generator_->PrintPushParameter(function->name(),
-                                               expressionNode->value(), count++);
-        while (this->IsThisIdentifier(COMMA)) {
+    if (!this->IsThisIdentifier(TokenKind::RPARENT)) {
+        string value;
+        type = this->AnalyzeExpression(this->AddSyntaxChild(SyntaxKind::EXPRESSION, node), value);
+        type_list.push_back(type == TypeSymbol::INT ? TypeSymbol::INT : TypeSymbol::CHAR);
+        midcode_generator_->PrintPushParameter(function->name(), value, count++);
+        while (this->IsThisIdentifier(TokenKind::COMMA)) {
             this->AddChild(node);    // COMMA
-            expressionNode = this->AddSyntaxChild(EXPRESSION, node);
-            type = this->AnalyzeExpression(expressionNode);
-            str.push_back(type == TypeSymbol::INT ? '0' : '1');
-            midcode_generator_->PrintPushParameter(function->name(),
-                                                   expressionNode->value(), count++);
+            type = this->AnalyzeExpression(this->AddSyntaxChild(SyntaxKind::EXPRESSION, node), value);
+            type_list.push_back(type == TypeSymbol::INT ? TypeSymbol::INT : TypeSymbol::CHAR);
+            midcode_generator_->PrintPushParameter(function->name(), value, count++);
         }
     }
 
-    if (function != nullptr && function->GetParameterCount() != str.length()) {
-        error_handing_->AddError(iter_->line_number, FUNCTION_PARAMETER_NUMBER_DONT_MATCH);
-    } else if (function != nullptr && function->parameter() != str) {
-        error_handing_->AddError(iter_->line_number, FUNCTION_PARAMETER_TYPE_DONT_MATCH);
+    if (function != nullptr && function->GetParameterCount() != (int) type_list.size()) {
+        error_handing_->AddError(this->LineNumber(), FUNCTION_PARAMETER_NUMBER_DONT_MATCH);
+    } else if (function != nullptr && function->parameter_list() != type_list) {
+        error_handing_->AddError(this->LineNumber(), FUNCTION_PARAMETER_TYPE_DONT_MATCH);
     }
 }
 
 void ParseAnalyser::AnalyzeReturnCallSentence(SyntaxNode *node) {
     if (this->FindSymbol(0) == nullptr) {
-        error_handing_->AddError(iter_->line_number, UNDEFINED);
+        error_handing_->AddError(this->LineNumber(), UNDEFINED);
     }
     Symbol *function = this->FindSymbol(0);
     midcode_generator_->PrintSave(function->name());
     this->AddChild(node);    // IDENFR
     this->AddChild(node);    // LPARENT
     this->AnalyzeValuePrameterTable(
-            this->AddSyntaxChild(VALUE_PARAMETER_TABLE, node), function);
+            this->AddSyntaxChild(SyntaxKind::VALUE_PARAMETER_TABLE, node), function);
     this->AddRparentChild(node);    // RPARENT
     midcode_generator_->PrintCallFunction(function->name());
 }
 
-TypeSymbol ParseAnalyser::AnalyzeFactor(SyntaxNode *node) {
+// Operands are spelled as in the midcode: a literal ("12", "'a'"), a name or a temporary "#n".
+bool ParseAnalyser::IsConstant(const string &value) {
+    return !value.empty() && (value[0] == '\'' || value[0] == '-' || isdigit(value[0]));
+}
+
+int ParseAnalyser::ConstantValue(const string &value) {
+    return value[0] == '\'' ? (int) value[1] : stoi(value);
+}
+
+// Temporaries are used like a stack: the operands of an operation are the topmost live ones, so
+// its result takes the lowest of them and everything above is free again.
+int ParseAnalyser::AllocateTemporary(const string &value1, const string &value2) {
+    int temp = reg_count_;
+    for (const string *value : {&value1, &value2}) {
+        if (!value->empty() && (*value)[0] == '#') {
+            temp = min(temp, stoi(value->substr(1)));
+        }
+    }
+    reg_count_ = temp + 1;
+    reg_max_ = max(reg_max_, temp);
+    return temp;
+}
+
+// Both operands constant: the result is computed here and no midcode is emitted.
+string ParseAnalyser::FoldOperate(const string &op, const string &value1, const string &value2) {
+    int result;
+    if (IsConstant(value1) && IsConstant(value2)
+        && midcodeinstr::Calculate(midcodeinstr::GetOperatorInstr(op),
+                                   ConstantValue(value1), ConstantValue(value2), result)) {
+        return to_string(result);
+    }
+    int temp = this->AllocateTemporary(value1, value2);
+    midcode_generator_->PrintOperate(temp, value1, value2, op);
+    return "#" + to_string(temp);
+}
+
+string ParseAnalyser::FoldNeg(const string &value) {
+    if (IsConstant(value)) {
+        return to_string((int) (0u - (unsigned) ConstantValue(value)));
+    }
+    int temp = this->AllocateTemporary(value, "");
+    midcode_generator_->PrintNeg(temp, value);
+    return "#" + to_string(temp);
+}
+
+// value is the factor's operand; a const symbol stands for its literal.
+TypeSymbol ParseAnalyser::AnalyzeFactor(SyntaxNode *node, string &value) {
     TypeSymbol type;
-    if (this->IsThisIdentifier(IDENFR)) {
+    if (this->IsThisIdentifier(TokenKind::IDENFR)) {
         if (this->FindSymbol(0) != nullptr
             && this->FindSymbol(0)->kind() == KindSymbol::FUNCTION
             && this->FindSymbol(0)->type() != TypeSymbol::VOID) {
             type = this->FindSymbol(0)->type();
-            this->AnalyzeReturnCallSentence(this->AddSyntaxChild(RETURN_CALL_SENTENCE, node));
-            midcode_generator_->PrintAssignReturn(reg_count_++);
+            int regCount = reg_count_;    // the arguments are pushed, so their temporaries are free
+            this->AnalyzeReturnCallSentence(this->AddSyntaxChild(SyntaxKind::RETURN_CALL_SENTENCE, node));
+            reg_count_ = regCount;
+            int temp = this->AllocateTemporary("", "");
+            midcode_generator_->PrintAssignReturn(temp);
+            value = "#" + to_string(temp);
         } else {
             Symbol *symbol = this->FindSymbol();
             if (symbol == nullptr) {
-                error_handing_->AddError(iter_->line_number, UNDEFINED);
+                error_handing_->AddError(this->LineNumber(), UNDEFINED);
                 type = TypeSymbol::INT;
             } else {
                 type = symbol->type();
             }
-            string name = iter_->value;
+            string name = Peek().value;
             this->AddChild(node);    // IDENFR
-            if (this->IsThisIdentifier(LBRACK)) {
+            if (this->IsThisIdentifier(TokenKind::LBRACK)) {
                 this->AddChild(node);    // LBRACK
-                SyntaxNode *expression = this->AddSyntaxChild(EXPRESSION, node);
-                TypeSymbol expressType = this->AnalyzeExpression(expression);
+                string index;
+                TypeSymbol expressType = this->AnalyzeExpression(
+                        this->AddSyntaxChild(SyntaxKind::EXPRESSION, node), index);
                 if (expressType != TypeSymbol::INT) {
-                    error_handing_->AddError(iter_->line_number, ILLEGAL_ARRAY_INDEX);
+                    error_handing_->AddError(this->LineNumber(), ILLEGAL_ARRAY_INDEX);
                 }
-                midcode_generator_->PrintLoadToTempReg(name,
-                                                       expression->value(), reg_count_++);
+                int temp = this->AllocateTemporary(index, "");
+                midcode_generator_->PrintLoadToTempReg(name, index, temp);
+                value = "#" + to_string(temp);
                 this->AddRbrackChild(node);    // RBRACK
+            } else if (symbol != nullptr && symbol->kind() == KindSymbol::CONST && symbol->has_const_value()) {
+                value = symbol->GetConstOperand();
             } else {
-                node->set_value(name);
+                value = name;
             }
         }
-    } else if (this->IsThisIdentifier(LPARENT)) {
+    } else if (this->IsThisIdentifier(TokenKind::LPARENT)) {
         this->AddChild(node);    // LPARENT
-        SyntaxNode *expression = this->AddSyntaxChild(EXPRESSION, node);
-        type = this->AnalyzeExpression(expression);
-        node->set_value(expression->value());
+        type = this->AnalyzeExpression(this->AddSyntaxChild(SyntaxKind::EXPRESSION, node), value);
         this->AddRparentChild(node);    // RPARENT
-    } else if (IsThisIdentifier(CHARCON)) {
+    } else if (IsThisIdentifier(TokenKind::CHARCON)) {
         type = TypeSymbol::CHAR;
-        string c = "\'" + iter_->value + "\'";
-        node->set_value(c);
+        value = "\'" + Peek().value + "\'";
         this->AddChild(node);
     } else {
         type = TypeSymbol::INT;
-        int integer = this->AnalyzeInteger(this->AddSyntaxChild(INTEGER, node));
-        node->set_value(to_string(integer));
+        int integer = this->AnalyzeInteger(this->AddSyntaxChild(SyntaxKind::INTEGER, node));
+        value = to_string(integer);
     }
     return type;
 }
 
-TypeSymbol ParseAnalyser::AnalyzeItem(SyntaxNode *node) {
-    TypeSymbol type;
-    string op;
-    int factorCount = 1;
-    SyntaxNode *factorRoot = nullptr;
-
-    while (true) {
-        SyntaxNode *anotherFactorRoot = this->AddSyntaxChild(FACTOR, node);
-        int regNumber = reg_count_;
-        type = this->AnalyzeFactor(anotherFactorRoot);
-
-        if (regNumber == reg_count_) {
-            if (factorCount == 1) {
-                factorRoot = anotherFactorRoot;
-            } else if (factorCount == 2) {
-                if (factorRoot == nullptr) {
-                    midcode_generator_->PrintRegOpNumber(reg_count_, regNumber - 1,
-                                                         anotherFactorRoot->value(), op);
-                    reg_count_++;
-                } else {
-                    midcode_generator_->PrintNumberOpNumber(reg_count_,
-                                                            factorRoot->value(),
-                                                            anotherFactorRoot->value(), op);
-                    reg_count_++;
-                }
-            } else {
-                midcode_generator_->PrintRegOpNumber(reg_count_, regNumber - 1,
-                                                     anotherFactorRoot->value(), op);
-                reg_count_++;
-            }
-        } else {
-            if (factorCount == 2 && factorRoot != nullptr) {
-                midcode_generator_->PrintNumberOpReg(reg_count_,
-                                                     factorRoot->value(), reg_count_ - 1, op);
-                reg_count_++;
-            } else if (factorCount != 1) {
-                midcode_generator_->PrintRegOpReg(reg_count_, regNumber - 1, reg_count_ - 1, op);
-                reg_count_++;
-            }
-        }
-
-        if (this->IsMultOrDiv()) {
-            op = iter_->value;
-            factorCount++;
-            this->AddChild(node);
-        } else {
-            break;
-        }
-    }
-
-    if (factorCount == 1) {
-        return type;
-    } else {
-        return TypeSymbol::INT;
+// Each operator is applied as soon as its right operand is parsed, so calls keep their source
+// order; a single factor keeps its type, anything computed is an int.
+TypeSymbol ParseAnalyser::AnalyzeItem(SyntaxNode *node, string &value) {
+    TypeSymbol type = this->AnalyzeFactor(this->AddSyntaxChild(SyntaxKind::FACTOR, node), value);
+    while (this->IsMultOrDiv()) {
+        string op = Peek().value;
+        this->AddChild(node);    // MULT or DIV
+        string operand;
+        this->AnalyzeFactor(this->AddSyntaxChild(SyntaxKind::FACTOR, node), operand);
+        value = this->FoldOperate(op, value, operand);
+        type = TypeSymbol::INT;
     }
+    return type;
 }
 
-TypeSymbol ParseAnalyser::AnalyzeExpression(SyntaxNode *node) {
-    TypeSymbol type;
-    string op;
-    SyntaxNode *itemRoot = nullptr;
-    int itemCount = 1;
-    int firstOpNumber = 1;
+TypeSymbol ParseAnalyser::AnalyzeExpression(SyntaxNode *node, string &value) {
+    bool isNegative = false;
     if (this->IsPlusOrMinu()) {
-        firstOpNumber = this->IsThisIdentifier(MINU) ? -1 : 1;
+        isNegative = this->IsThisIdentifier(TokenKind::MINU);
         this->AddChild(node);    // PLUS or MINU
     }
 
-    while (true) {
-        SyntaxNode *anotherItemRoot = this->AddSyntaxChild(ITEM, node);
-        int regNumber = reg_count_;
-        type = this->AnalyzeItem(anotherItemRoot);
-
-        if (regNumber == reg_count_) {
-            if (itemCount == 1) {
-                if (firstOpNumber == -1) {
-                    midcode_generator_->PrintNeg(reg_count_++,
-                                                 anotherItemRoot->GetFirstChildNumericalValue());
-                } else {
-                    itemRoot = anotherItemRoot;
-                }
-            } else if (itemCount == 2) {
-                if (itemRoot == nullptr) {
-                    midcode_generator_->PrintRegOpNumber(reg_count_, regNumber - 1,
-                                                         anotherItemRoot->GetFirstChildNumericalValue(), op);
-                    reg_count_++;
-                } else {
-                    midcode_generator_->PrintNumberOpNumber(reg_count_++,
-                                                            itemRoot->GetFirstChildNumericalValue(),
-                                                            anotherItemRoot->GetFirstChildNumericalValue(), op);
-                }
-            } else {
-                midcode_generator_->PrintRegOpNumber(reg_count_, regNumber - 1,
-                                                     anotherItemRoot->GetFirstChildNumericalValue(), op);
-                reg_count_++;
-            }
-        } else {
-            if (itemCount == 2 && itemRoot != nullptr) {
-                midcode_generator_->PrintNumberOpReg(reg_count_,
-                                                     itemRoot->GetFirstChildNumericalValue(), reg_count_ - 1, op);
-                reg_count_++;
-            } else if (itemCount != 1) {
-                midcode_generator_->PrintRegOpReg(reg_count_, regNumber - 1, reg_count_ - 1, op);
-                reg_count_++;
-            } else {
-                if (firstOpNumber == -1) {
-                    midcode_generator_->PrintNeg(reg_count_,
-                                                 anotherItemRoot->GetFirstChildNumericalValue());
-                    reg_count_++;
-                }
-            }
-        }
-
-        if (this->IsPlusOrMinu()) {
-            op = iter_->value;
-            itemCount++;
-            this->AddChild(node);
-        } else {
-            break;
-        }
-    }
-
-    if (itemCount == 1 && itemRoot != nullptr) {
-        node->set_value(itemRoot->GetFirstChildNumericalValue());
-    } else {
-        node->set_value("#" + to_string(reg_count_ - 1));
+    TypeSymbol type = this->AnalyzeItem(this->AddSyntaxChild(SyntaxKind::ITEM, node), value);
+    if (isNegative) {
+        value = this->FoldNeg(value);
     }
-
-    if (itemCount == 1) {
-        return type;
-    } else {
-        return TypeSymbol::INT;
+    while (this->IsPlusOrMinu()) {
+        string op = Peek().value;
+        this->AddChild(node);    // PLUS or MINU
+        string operand;
+        this->AnalyzeItem(this->AddSyntaxChild(SyntaxKind::ITEM, node), operand);
+        value = this->FoldOperate(op, value, operand);
+        type = TypeSymbol::INT;
     }
+    return type;
 }
 
 void ParseAnalyser::AnalyzeCondition(SyntaxNode *node, bool
 isFalseBranch, int label_count) {
-    SyntaxNode *expression1 = this->AddSyntaxChild(EXPRESSION, node);
-    if (this->AnalyzeExpression(expression1) != TypeSymbol::INT) {
-        this->CountIterator(-1);
-        error_handing_->AddError(iter_->line_number, ILLEGAL_TYPE_IN_IF);
-        this->CountIterator(+1);
-    }
-    if (this->IsThisIdentifier(LSS)
-        || this->IsThisIdentifier(LEQ)
-        || this->IsThisIdentifier(GRE)
-        || this->IsThisIdentifier(GEQ)
-        || this->IsThisIdentifier(EQL)
-        || this->IsThisIdentifier(NEQ)) {
-        string op = iter_->value;
+    string value1;
+    if (this->AnalyzeExpression(this->AddSyntaxChild(SyntaxKind::EXPRESSION, node), value1) != TypeSymbol::INT) {
+        error_handing_->AddError(this->LineNumber(-1), ILLEGAL_TYPE_IN_IF);
+    }
+    if (this->IsThisIdentifier(TokenKind::LSS)
+        || this->IsThisIdentifier(TokenKind::LEQ)
+        || this->IsThisIdentifier(TokenKind::GRE)
+        || this->IsThisIdentifier(TokenKind::GEQ)
+        || this->IsThisIdentifier(TokenKind::EQL)
+        || this->IsThisIdentifier(TokenKind::NEQ)) {
+        string op = Peek().value;
         this->AddChild(node);
-        SyntaxNode *expression2 = this->AddSyntaxChild(EXPRESSION, node);
-        if (this->AnalyzeExpression(expression2) != TypeSymbol::INT) {
-            this->CountIterator(-1);
-            error_handing_->AddError(iter_->line_number, ILLEGAL_TYPE_IN_IF);
-            this->CountIterator(+1);
+        string value2;
+        if (this->AnalyzeExpression(this->AddSyntaxChild(SyntaxKind::EXPRESSION, node), value2) != TypeSymbol::INT) {
+            error_handing_->AddError(this->LineNumber(-1), ILLEGAL_TYPE_IN_IF);
         }
         if (op == "==") {
-            midcode_generator_->PrintBeqOrBne(label_count, expression1->value(),
-                                              expression2->value(), Judge::BEQ, isFalseBranch);
+            midcode_generator_->PrintBeqOrBne(label_count, value1, value2, Judge::BEQ, isFalseBranch);
         } else if (op == "!=") {
-            midcode_generator_->PrintBeqOrBne(label_count, expression1->value(),
-                                              expression2->value(), Judge::BNE, isFalseBranch);
+            midcode_generator_->PrintBeqOrBne(label_count, value1, value2, Judge::BNE, isFalseBranch);
         } else if (op == "<") {
-            midcode_generator_->PrintBgeOrBlt(label_count, expression1->value(),
-                                              expression2->value(), Judge::BLT, isFalseBranch);
+            midcode_generator_->PrintBgeOrBlt(label_count, value1, value2, Judge::BLT, isFalseBranch);
         } else if (op == ">=") {
-            midcode_generator_->PrintBgeOrBlt(label_count, expression1->value(),
-                                              expression2->value(), Judge::BGE, isFalseBranch);
+            midcode_generator_->PrintBgeOrBlt(label_count, value1, value2, Judge::BGE, isFalseBranch);
         } else if (op == "<=") {
-            midcode_generator_->PrintBgtOrBle(label_count, expression1->value(),
-                                              expression2->value(), Judge::BLE, isFalseBranch);
+            midcode_generator_->PrintBgtOrBle(label_count, value1, value2, Judge::BLE, isFalseBranch);
         } else if (op == ">") {
-            midcode_generator_->PrintBgtOrBle(label_count, expression1->value(),
-                                              expression2->value(), Judge::BGT, isFalseBranch);
+            midcode_generator_->PrintBgtOrBle(label_count, value1, value2, Judge::BGT, isFalseBranch);
         }
     } else {
-        midcode_generator_->PrintBezOrBnz(label_count,
-                                          expression1->value(), isFalseBranch);
+        midcode_generator_->PrintBezOrBnz(label_count, value1, isFalseBranch);
     }
 }
 
@@ -508,17 +530,17 @@ bool ParseAnalyser::AnalyzeIfSentence(SyntaxNode *node, TypeSymbol returnType) {
     int elseLabel = ++label_count_;
 
     this->AddChild(node);    // LPARENT
-    this->AnalyzeCondition(this->AddSyntaxChild(CONDITION, node), true, elseLabel);
+    this->AnalyzeCondition(this->AddSyntaxChild(SyntaxKind::CONDITION, node), true, elseLabel);
     this->AddRparentChild(node);    // RPARENT
-    bool noReturn = this->AnalyzeSentence(this->AddSyntaxChild(SENTENCE, node), returnType);
+    bool noReturn = this->AnalyzeSentence(this->AddSyntaxChild(SyntaxKind::SENTENCE, node), returnType);
 
     int endifLabel = ++label_count_;
     midcode_generator_->PrintJump(endifLabel);
     midcode_generator_->PrintLabel(elseLabel);
 
-    if (this->IsThisIdentifier(ELSETK)) {
+    if (this->IsThisIdentifier(TokenKind::ELSETK)) {
         this->AddChild(node);    // ELSETK
-        noReturn = this->AnalyzeSentence(this->AddSyntaxChild(SENTENCE, node), returnType) && noReturn;
+        noReturn = this->AnalyzeSentence(this->AddSyntaxChild(SyntaxKind::SENTENCE, node), returnType) && noReturn;
     }
     midcode_generator_->PrintLabel(endifLabel);
 
@@ -526,8 +548,8 @@ bool ParseAnalyser::AnalyzeIfSentence(SyntaxNode *node, TypeSymbol returnType) {
 }
 
 int ParseAnalyser::AnalyzeStep(SyntaxNode *node) {
-    int step = stoi(iter_->value);
-    this->AddChild(this->AddSyntaxChild(UNSIGNINT, node));    // INTCON
+    int step = stoi(Peek().value);
+    this->AddChild(this->AddSyntaxChild(SyntaxKind::UNSIGNINT, node));    // INTCON
     return step;
 }
 
@@ -539,10 +561,10 @@ void ParseAnalyser::AnalyzeWhile(SyntaxNode *node, TypeSymbol returnType) {
 
     this->AddChild(node);    // LPARENT
     int endWhileLabel = ++label_count_;
-    this->AnalyzeCondition(this->AddSyntaxChild(CONDITION, node), true, endWhileLabel);
+    this->AnalyzeCondition(this->AddSyntaxChild(SyntaxKind::CONDITION, node), true, endWhileLabel);
     this->AddRparentChild(node);    // RPARENT
 
-    this->AnalyzeSentence(this->AddSyntaxChild(SENTENCE, node), returnType);
+    this->AnalyzeSentence(this->AddSyntaxChild(SyntaxKind::SENTENCE, node), returnType);
 
     midcode_generator_->PrintJump(whileLabel);
     midcode_generator_->PrintLabel(endWhileLabel);
@@ -555,11 +577,11 @@ void ParseAnalyser::AnalyzeDoWhile(SyntaxNode *node, bool &noReturn, TypeSymbol
     midcode_generator_->PrintLabel(doLabel);
     midcode_generator_->PrintLoop();
 
-    noReturn = this->AnalyzeSentence(this->AddSyntaxChild(SENTENCE, node), returnType);
+    noReturn = this->AnalyzeSentence(this->AddSyntaxChild(SyntaxKind::SENTENCE, node), returnType);
 
     this->AddWhileChild(node);    // WHILETK
     this->AddChild(node);    // LPARENT
-    this->AnalyzeCondition(this->AddSyntaxChild(CONDITION, node), false, doLabel);
+    this->AnalyzeCondition(this->AddSyntaxChild(SyntaxKind::CONDITION, node), false, doLabel);
     this->AddRparentChild(node);    // RPARENT
 }
 
@@ -567,15 +589,15 @@ void ParseAnalyser::AnalyzeFor(SyntaxNode *node, TypeSymbol returnType) {
     this->AddChild(node);    // FORTK
     this->AddChild(node);    // LPARENT
     if (this->FindSymbol() == nullptr) {
-        error_handing_->AddError(iter_->line_number, UNDEFINED);
+        error_handing_->AddError(this->LineNumber(), UNDEFINED);
     }
 
-    string name = iter_->value;
+    string name = Peek().value;
     this->AddChild(node);    // IDENFR
     this->AddChild(node);    // ASSIGN
-    SyntaxNode *expressionNode = this->AddSyntaxChild(EXPRESSION, node);
-    this->AnalyzeExpression(expressionNode);
-    midcode_generator_->PrintAssignValue(name, "", expressionNode->value());
+    string value;
+    this->AnalyzeExpression(this->AddSyntaxChild(SyntaxKind::EXPRESSION, node), value);
+    midcode_generator_->PrintAssignValue(name, "", value);
 
     int forLabel = ++label_count_;
     midcode_generator_->PrintLabel(forLabel);
@@ -584,26 +606,30 @@ void ParseAnalyser::AnalyzeFor(SyntaxNode *node, TypeSymbol returnType) {
     this->AddSemicnChild(node);    // SEMICN
 
     int endForLabel = ++label_count_;
-    this->AnalyzeCondition(this->AddSyntaxChild(CONDITION, node), true, endForLabel);
+    this->AnalyzeCondition(this->AddSyntaxChild(SyntaxKind::CONDITION, node), true, endForLabel);
 
     this->AddSemicnChild(node);    // SEMICN
 
     if (this->FindSymbol() == nullptr) {
-        error_handing_->AddError(iter_->line_number, UNDEFINED);
+        error_handing_->AddError(this->LineNumber(), UNDEFINED);
     }
-    string name1 = iter_->value;
+    string name1 = Peek().value;
     this->AddChild(node);    // IDENFR
     this->AddChild(node);    // ASSIGN
-    if (this->FindSymbol() == nullptr) {
-        error_handing_->AddError(iter_->line_number, UNDEFINED);
+    Symbol *symbol = this->FindSymbol();
+    if (symbol == nullptr) {
+        error_handing_->AddError(this->LineNumber(), UNDEFINED);
+    }
+    string name2 = Peek().value;
+    if (symbol != nullptr && symbol->kind() == KindSymbol::CONST && symbol->has_const_value()) {
+        name2 = symbol->GetConstOperand();
     }
-    string name2 = iter_->value;
     this->AddChild(node);    // IDENFR
-    string op = iter_->value;
+    string op = Peek().value;
     this->AddChild(node);    // PLUS or MINU
-    int step = this->AnalyzeStep(this->AddSyntaxChild(STEP, node));
+    int step = this->AnalyzeStep(this->AddSyntaxChild(SyntaxKind::STEP, node));
     this->AddRparentChild(node);    // RPARENT
-    this->AnalyzeSentence(this->AddSyntaxChild(SENTENCE, node), returnType);
+    this->AnalyzeSentence(this->AddSyntaxChild(SyntaxKind::SENTENCE, node), returnType);
     midcode_generator_->PrintStep(name1, name2, op, step);
 
     midcode_generator_->PrintJump(forLabel);
@@ -612,11 +638,11 @@ void ParseAnalyser::AnalyzeFor(SyntaxNode *node, TypeSymbol returnType) {
 
 bool ParseAnalyser::AnalyzeLoopSentence(SyntaxNode *node, TypeSymbol returnType) {
     bool noReturn = true;
-    if (this->IsThisIdentifier(WHILETK)) {
+    if (this->IsThisIdentifier(TokenKind::WHILETK)) {
         this->AnalyzeWhile(node, returnType);
-    } else if (this->IsThisIdentifier(DOTK)) {
+    } else if (this->IsThisIdentifier(TokenKind::DOTK)) {
         this->AnalyzeDoWhile(node, noReturn, returnType);
-    } else if (this->IsThisIdentifier(FORTK)) {
+    } else if (this->IsThisIdentifier(TokenKind::FORTK)) {
         this->AnalyzeFor(node, returnType);
     }
     return noReturn;
@@ -625,36 +651,34 @@ bool ParseAnalyser::AnalyzeLoopSentence(SyntaxNode *node, TypeSymbol returnType)
 void ParseAnalyser::AnalyzeAssignSentence(SyntaxNode *node) {
     KindSymbol kind;
     if (this->FindSymbol() == nullptr) {
-        error_handing_->AddError(iter_->line_number, UNDEFINED);
+        error_handing_->AddError(this->LineNumber(), UNDEFINED);
     } else {
         kind = this->FindSymbol()->kind();
         if (kind == KindSymbol::CONST) {
-            error_handing_->AddError(iter_->line_number, ASSIGN_TO_CONST);
+            error_handing_->AddError(this->LineNumber(), ASSIGN_TO_CONST);
         }
     }
-    string name = iter_->value;
+    string name = Peek().value;
     string arrayIndex;
     this->AddChild(node);    // IDENFR
 
-    SyntaxNode *expressionNode;
-    if (this->IsThisIdentifier(LBRACK)) {
+    if (this->IsThisIdentifier(TokenKind::LBRACK)) {
         this->AddChild(node);    // LBRACK
-        expressionNode = this->AddSyntaxChild(EXPRESSION, node);
-        if (this->AnalyzeExpression(expressionNode) == TypeSymbol::CHAR) {
-            error_handing_->AddError(iter_->line_number, ILLEGAL_ARRAY_INDEX);
+        if (this->AnalyzeExpression(this->AddSyntaxChild(SyntaxKind::EXPRESSION, node), arrayIndex)
+            == TypeSymbol::CHAR) {
+            error_handing_->AddError(this->LineNumber(), ILLEGAL_ARRAY_INDEX);
         }
-        arrayIndex = expressionNode->value();
         this->AddRbrackChild(node);    // RBRACK
     }
     this->AddChild(node);    // ASSIGN
-    expressionNode = this->AddSyntaxChild(EXPRESSION, node);
-    this->AnalyzeExpression(expressionNode);
-    midcode_generator_->PrintAssignValue(name, arrayIndex, expressionNode->value());
+    string value;
+    this->AnalyzeExpression(this->AddSyntaxChild(SyntaxKind::EXPRESSION, node), value);
+    midcode_generator_->PrintAssignValue(name, arrayIndex, value);
 }
 
 void ParseAnalyser::AnalyzeScanfIdentifier(SyntaxNode *node) {
     if (this->FindSymbol() == nullptr) {
-        error_handing_->AddError(iter_->line_number, UNDEFINED);
+        error_handing_->AddError(this->LineNumber(), UNDEFINED);
     } else {
         Symbol *symbol = this->FindSymbol(0) != nullptr ? this->FindSymbol(0) : this->FindSymbol(1);
         string type = symbol->type() == TypeSymbol::INT ? kIntType : kCharType;
@@ -668,7 +692,7 @@ void ParseAnalyser::AnalyzeScanfSentence(SyntaxNode *node) {
     this->AddChild(node);    // LPARENT
 
     this->AnalyzeScanfIdentifier(node);
-    while (this->IsThisIdentifier(COMMA)) {
+    while (this->IsThisIdentifier(TokenKind::COMMA)) {
         this->AddChild(node);    // COMMA
         this->AnalyzeScanfIdentifier(node);
     }
@@ -680,27 +704,35 @@ void ParseAnalyser::AnalyzePrintfSentence(SyntaxNode *node) {
     this->AddChild(node);    // PRINTFTK
     this->AddChild(node);    // LPARENT
 
-    if (this->IsThisIdentifier(STRCON)) {
-        int stringNumber = string_table_->AddString(iter_->value);
+    if (this->IsThisIdentifier(TokenKind::STRCON)) {
+        // the lexer keeps the raw spelling; the StringTable holds it escaped for .asciiz
+        string str;
+        for (size_t i = 0; i < Peek().value.size(); i++) {
+            str.push_back(Peek().value[i]);
+            if (Peek().value[i] == '\\') {
+                str.push_back('\\');
+            }
+        }
+        int stringNumber = string_table_->AddString(str);
         midcode_generator_->PrintString(stringNumber);
-        this->AddChild(AddSyntaxChild(STRING, node));
-        if (this->IsThisIdentifier(COMMA)) {
+        this->AddChild(AddSyntaxChild(SyntaxKind::STRING, node));
+        if (this->IsThisIdentifier(TokenKind::COMMA)) {
             this->AddChild(node);    // COMMA
-            SyntaxNode *expression = this->AddSyntaxChild(EXPRESSION, node);
-            TypeSymbol type = this->AnalyzeExpression(expression);
+            string value;
+            TypeSymbol type = this->AnalyzeExpression(this->AddSyntaxChild(SyntaxKind::EXPRESSION, node), value);
             if (type == TypeSymbol::INT) {
-                midcode_generator_->PrintInteger(expression->value());
+                midcode_generator_->PrintInteger(value);
             } else {
-                midcode_generator_->PrintChar(expression->value());
+                midcode_generator_->PrintChar(value);
             }
         }
     } else {
-        SyntaxNode *expression = this->AddSyntaxChild(EXPRESSION, node);
-        TypeSymbol type = this->AnalyzeExpression(expression);
+        string value;
+        TypeSymbol type = this->AnalyzeExpression(this->AddSyntaxChild(SyntaxKind::EXPRESSION, node), value);
         if (type == TypeSymbol::INT) {
-            midcode_generator_->PrintInteger(expression->value());
+            midcode_generator_->PrintInteger(value);
         } else {
-            midcode_generator_->PrintChar(expression->value());
+            midcode_generator_->PrintChar(value);
         }
     }
     midcode_generator_->PrintEnd();
@@ -711,11 +743,11 @@ void ParseAnalyser::AnalyzePrintfSentence(SyntaxNode *node) {
 TypeSymbol ParseAnalyser::AnalyzeReturnSentence(SyntaxNode *node) {
     TypeSymbol type = TypeSymbol::VOID;
     this->AddChild(node);    // RETURNTK
-    if (this->IsThisIdentifier(LPARENT)) {
+    if (this->IsThisIdentifier(TokenKind::LPARENT)) {
         this->AddChild(node);    // LPARENT
-        SyntaxNode *expression_root = this->AddSyntaxChild(EXPRESSION, node);
-        type = this->AnalyzeExpression(expression_root);
-        midcode_generator_->PrintReturn(false, expression_root->value());
+        string value;
+        type = this->AnalyzeExpression(this->AddSyntaxChild(SyntaxKind::EXPRESSION, node), value);
+        midcode_generator_->PrintReturn(false, value);
         this->AddRparentChild(node);    // RPARENT
     } else {
         midcode_generator_->PrintReturn(true, "");
@@ -723,73 +755,73 @@ TypeSymbol ParseAnalyser::AnalyzeReturnSentence(SyntaxNode *node) {
     return type;
 }
 
+// No temporary outlives the statement that computes it, so each statement starts from #1.
 bool ParseAnalyser::AnalyzeSentence(SyntaxNode *node, TypeSymbol returnType) {
     bool noReturn = true;
-    if (this->IsThisIdentifier(IFTK)) {
-        noReturn = this->AnalyzeIfSentence(this->AddSyntaxChild(IF_SENTENCE, node), returnType);
-    } else if (this->IsThisIdentifier(WHILETK)
-               || this->IsThisIdentifier(DOTK)
-               || this->IsThisIdentifier(FORTK)) {
-        noReturn = this->AnalyzeLoopSentence(this->AddSyntaxChild(LOOP_SENTENCE, node), returnType);
-    } else if (this->IsThisIdentifier(LBRACE)) {
+    reg_count_ = 1;
+    if (this->IsThisIdentifier(TokenKind::IFTK)) {
+        noReturn = this->AnalyzeIfSentence(this->AddSyntaxChild(SyntaxKind::IF_SENTENCE, node), returnType);
+    } else if (this->IsThisIdentifier(TokenKind::WHILETK)
+               || this->IsThisIdentifier(TokenKind::DOTK)
+               || this->IsThisIdentifier(TokenKind::FORTK)) {
+        noReturn = this->AnalyzeLoopSentence(this->AddSyntaxChild(SyntaxKind::LOOP_SENTENCE, node), returnType);
+    } else if (this->IsThisIdentifier(TokenKind::LBRACE)) {
         this->AddChild(node);    // LBRACE
-        noReturn = this->AnalyzeSentenceCollection(this->AddSyntaxChild(SENTENCE_COLLECTION, node), returnType);
+        noReturn = this->AnalyzeSentenceCollection(this->AddSyntaxChild(SyntaxKind::SENTENCE_COLLECTION, node), returnType);
         this->AddChild(node);    // RBRACE
-    } else if (this->IsThisIdentifier(IDENFR)) {
+    } else if (this->IsThisIdentifier(TokenKind::IDENFR)) {
         noReturn = true;
         if (this->FindSymbol(0) != nullptr
             && this->FindSymbol(0)->kind() == KindSymbol::FUNCTION
             && this->FindSymbol(0)->type() != TypeSymbol::VOID) {
-            this->AnalyzeReturnCallSentence(this->AddSyntaxChild(RETURN_CALL_SENTENCE, node));
+            this->AnalyzeReturnCallSentence(this->AddSyntaxChild(SyntaxKind::RETURN_CALL_SENTENCE, node));
             this->AddSemicnChild(node);    // SEMICN
         } else if (this->FindSymbol(0) != nullptr
                    && this->FindSymbol(0)->kind() == KindSymbol::FUNCTION
                    && this->FindSymbol(0)->type() == TypeSymbol::VOID) {
-            this->AnalyzeReturnCallSentence(this->AddSyntaxChild(NO_RETURN_CALL_SENTENCE, node));
+            this->AnalyzeReturnCallSentence(this->AddSyntaxChild(SyntaxKind::NO_RETURN_CALL_SENTENCE, node));
             this->AddSemicnChild(node);    // SEMICN
         } else {
             if (this->FindSymbol() != nullptr) {
-                this->AnalyzeAssignSentence(this->AddSyntaxChild(ASSIGN_SENTENCE, node));
+                this->AnalyzeAssignSentence(this->AddSyntaxChild(SyntaxKind::ASSIGN_SENTENCE, node));
                 this->AddSemicnChild(node);    // SEMICN
             } else if (this->FindSymbol(0) == nullptr) {
                 if (this->FindSymbol(1) == nullptr) {
-                    error_handing_->AddError(iter_->line_number, UNDEFINED);
+                    error_handing_->AddError(this->LineNumber(), UNDEFINED);
                 }
-                this->CountIterator(+1);
-                if (this->IsThisIdentifier(LPARENT)) {
-                    while (!this->IsThisIdentifier(RPARENT)) {
-                        this->CountIterator(+1);
+                this->Advance();
+                if (this->IsThisIdentifier(TokenKind::LPARENT)) {
+                    while (!this->IsThisIdentifier(TokenKind::RPARENT) && !this->IsThisIdentifier(TokenKind::END)) {
+                        this->Advance();
                     }
-                    this->CountIterator(+1);
-                } else if (this->IsThisIdentifier(ASSIGN)) {
-                    while (!this->IsThisIdentifier(SEMICN)) {
-                        this->CountIterator(+1);
+                    this->Advance();
+                } else if (this->IsThisIdentifier(TokenKind::ASSIGN)) {
+                    while (!this->IsThisIdentifier(TokenKind::SEMICN) && !this->IsThisIdentifier(TokenKind::END)) {
+                        this->Advance();
                     }
-                    this->CountIterator(+1);
+                    this->Advance();
                 }
             }
         }
-    } else if (this->IsThisIdentifier(SCANFTK)) {
+    } else if (this->IsThisIdentifier(TokenKind::SCANFTK)) {
         noReturn = true;
-        this->AnalyzeScanfSentence(this->AddSyntaxChild(SCANF_SENTENCE, node));
+        this->AnalyzeScanfSentence(this->AddSyntaxChild(SyntaxKind::SCANF_SENTENCE, node));
         this->AddSemicnChild(node);    // SEMICN
-    } else if (this->IsThisIdentifier(PRINTFTK)) {
+    } else if (this->IsThisIdentifier(TokenKind::PRINTFTK)) {
         noReturn = true;
-        this->AnalyzePrintfSentence(this->AddSyntaxChild(PRINTF_SENTENCE, node));
+        this->AnalyzePrintfSentence(this->AddSyntaxChild(SyntaxKind::PRINTF_SENTENCE, node));
         this->AddSemicnChild(node);    // SEMICN
-    } else if (this->IsThisIdentifier(SEMICN)) {
+    } else if (this->IsThisIdentifier(TokenKind::SEMICN)) {
         noReturn = true;
         this->AddSemicnChild(node);    // SEMICN
-    } else if (this->IsThisIdentifier(RETURNTK)) {
-        TypeSymbol type = this->AnalyzeReturnSentence(this->AddSyntaxChild(RETURN_SENTENCE, node));
+    } else if (this->IsThisIdentifier(TokenKind::RETURNTK)) {
+        TypeSymbol type = this->AnalyzeReturnSentence(this->AddSyntaxChild(SyntaxKind::RETURN_SENTENCE, node));
         noReturn = type == TypeSymbol::VOID;
-        this->CountIterator(-1);
         if (returnType == TypeSymbol::VOID && type != TypeSymbol::VOID) {
-            error_handing_->AddError(iter_->line_number, RETURN_IN_NO_RETURN_FUNCTION);
+            error_handing_->AddError(this->LineNumber(-1), RETURN_IN_NO_RETURN_FUNCTION);
         } else if (returnType != type) {
-            error_handing_->AddError(iter_->line_number, NO_RETURN_OR_WRONG_RETURN_IN_RETURN_FUNCTION);
+            error_handing_->AddError(this->LineNumber(-1), NO_RETURN_OR_WRONG_RETURN_IN_RETURN_FUNCTION);
         }
-        this->CountIterator(+1);
         this->AddSemicnChild(node);    // SEMICN
     }
     return noReturn;
@@ -797,8 +829,8 @@ bool ParseAnalyser::AnalyzeSentence(SyntaxNode *node, TypeSymbol returnType) {
 
 bool ParseAnalyser::AnalyzeSentenceCollection(SyntaxNode *node, TypeSymbol returnType) {
     bool noReturn = true;
-    while (!this->IsThisIdentifier(RBRACE)) {
-        if (!this->AnalyzeSentence(this->AddSyntaxChild(SENTENCE, node), returnType)) {
+    while (!this->IsThisIdentifier(TokenKind::RBRACE)) {
+        if (!this->AnalyzeSentence(this->AddSyntaxChild(SyntaxKind::SENTENCE, node), returnType)) {
             noReturn = false;
         }
     }
@@ -807,82 +839,107 @@ bool ParseAnalyser::AnalyzeSentenceCollection(SyntaxNode *node, TypeSymbol retur
 }
 
 void ParseAnalyser::AnalyzeCompositeSentence(SyntaxNode *node, TypeSymbol returnType) {
-    if (this->IsThisIdentifier(CONSTTK)) {
-        this->AnalyzeConstDeclare(this->AddSyntaxChild(CONST_DECLARE, node), 1);
+    if (this->IsThisIdentifier(TokenKind::CONSTTK)) {
+        this->AnalyzeConstDeclare(this->AddSyntaxChild(SyntaxKind::CONST_DECLARE, node), 1);
     }
-    if (this->IsThisIdentifier(INTTK) || this->IsThisIdentifier(CHARTK)) {
-        this->AnalyzeVariableDeclare(this->AddSyntaxChild(VARIABLE_DECLARE, node), 1);
+    if (this->IsThisIdentifier(TokenKind::INTTK) || this->IsThisIdentifier(TokenKind::CHARTK)) {
+        this->AnalyzeVariableDeclare(this->AddSyntaxChild(SyntaxKind::VARIABLE_DECLARE, node), 1);
     }
     bool noReturn = this->AnalyzeSentenceCollection(
-            this->AddSyntaxChild(SENTENCE_COLLECTION, node), returnType);
+            this->AddSyntaxChild(SyntaxKind::SENTENCE_COLLECTION, node), returnType);
     if (returnType != TypeSymbol::VOID && noReturn) {
-        this->CountIterator(-1);
-        error_handing_->AddError(iter_->line_number, NO_RETURN_OR_WRONG_RETURN_IN_RETURN_FUNCTION);
-        this->CountIterator(+1);
+        error_handing_->AddError(this->LineNumber(-1), NO_RETURN_OR_WRONG_RETURN_IN_RETURN_FUNCTION);
+    }
+}
+
+// From the LBRACE to the end of the function. While pre-scanning the body is only recorded as
+// a job; in a function job the parent does the bookkeeping when it merges the job.
+// Temporaries and labels are numbered from the start of each function.
+void ParseAnalyser::AnalyzeFunctionBody(SyntaxNode *node, Symbol *function, TypeSymbol returnType) {
+    if (job_list_ != nullptr) {
+        FunctionJob &job = job_list_->back();
+        job.function = function;
+        job.return_type = returnType;
+        job.order = (int) job_list_->size() - 1;
+        job.symbol_table = check_table_->GetSymbolTable(1);
+        job.begin = token_stream_->index();
+        int depth = 0;
+        do {
+            if (this->IsThisIdentifier(TokenKind::LBRACE)) {
+                depth++;
+            } else if (this->IsThisIdentifier(TokenKind::RBRACE)) {
+                depth--;
+            }
+            this->Advance();
+        } while (depth > 0);
+        job.end = token_stream_->index();
+        function_order_map_[function->id()] = job.order;
+        return;
+    }
+
+    reg_count_ = 1;
+    reg_max_ = 0;
+    label_count_ = 0;
+    this->AddChild(node);    // LBRACE
+    this->AnalyzeCompositeSentence(this->AddSyntaxChild(SyntaxKind::COMPOSITE_SENTENCE, node), returnType);
+    if (returnType == TypeSymbol::VOID) {
+        midcode_generator_->PrintReturn(true, "");
+    }
+    this->AddChild(node);    // RBRACE
+
+    midcode_generator_->PrintFuncEnd();
+    if (function_order_ == nullptr) {
+        check_table_->AddFunctionVariableNumber(function->name(), reg_max_);
+        this->InsertSymbolTable(function->name(), 1);
+        temp_count_ += reg_max_;
     }
 }
 
 void ParseAnalyser::AnalyzeMain(SyntaxNode *node) {
-    int temp_reg = reg_count_;
     this->AddChild(node);    // VOIDTK
     this->InsertIdentifier(KindSymbol::FUNCTION, TypeSymbol::VOID, 0);
     Symbol *function = this->FindSymbol(0);
-    this->CleanLevel(1);
+    this->OpenFunctionScope();
     this->AddChild(node);    // MAINTK
     this->AddChild(node);    // LPARENT
     this->AddRparentChild(node);    // RPARENT
     midcode_generator_->PrintVoidFuncDeclare(function);
-    this->AddChild(node);    // LBRACE
-    this->AnalyzeCompositeSentence(this->AddSyntaxChild(COMPOSITE_SENTENCE, node), TypeSymbol::VOID);
-    midcode_generator_->PrintReturn(true, "");
-    this->AddChild(node);    // RBRACE
-
-    midcode_generator_->PrintFuncEnd();
-    check_table_->AddFunctionVariableNumber(function->name(), reg_count_ - temp_reg);
-    this->InsertSymbolTable(function->name(), 1);
+    this->AnalyzeFunctionBody(node, function, TypeSymbol::VOID);
 }
 
 void ParseAnalyser::AnalyzeParameterTable(SyntaxNode *node, Symbol *function) {
-    while (this->IsThisIdentifier(INTTK) || this->IsThisIdentifier(CHARTK)) {
+    while (this->IsThisIdentifier(TokenKind::INTTK) || this->IsThisIdentifier(TokenKind::CHARTK)) {
 
         TypeSymbol type;
         this->SetSymbolType(type);
         this->AddChild(node);    // INTTK or CHARTK
 
         if (this->FindSymbol(1) != nullptr) {
-            error_handing_->AddError(iter_->line_number, REDEFINITION);
+            error_handing_->AddError(this->LineNumber(), REDEFINITION);
         }
-        function->AddParameter(type == TypeSymbol::INT ? '0' : '1');
+        function->AddParameter(type == TypeSymbol::INT ? TypeSymbol::INT : TypeSymbol::CHAR);
         this->InsertIdentifier(KindSymbol::PARAMETER, type, 1);
-        this->midcode_generator_->PrintParameter(type, iter_->value);
+        this->midcode_generator_->PrintParameter(type, Peek().value);
         this->AddChild(node);    // IDENTFR
         this->AddCommaChild(node);
     }
 }
 
 void ParseAnalyser::AnalyzeVoidFunc(SyntaxNode *node) {
-    int temp_reg = reg_count_;
     this->AddChild(node);    // VOIDTK
     if (this->FindSymbol(0) != nullptr) {
-        error_handing_->AddError(iter_->line_number, REDEFINITION);
+        error_handing_->AddError(this->LineNumber(), REDEFINITION);
     }
     this->InsertIdentifier(KindSymbol::FUNCTION, TypeSymbol::VOID, 0);
     Symbol *function = FindSymbol(0);
-    this->CleanLevel(1);
+    this->OpenFunctionScope();
     this->AddChild(node);    // IDENFR
     this->midcode_generator_->PrintVoidFuncDeclare(function);
     this->AddChild(node);    // LPARENT
     this->AnalyzeParameterTable(
-            this->AddSyntaxChild(PARAMETER_TABLE, node), function);
+            this->AddSyntaxChild(SyntaxKind::PARAMETER_TABLE, node), function);
     this->AddRparentChild(node);    // RPARENT
-    this->AddChild(node);    // LBRACE
-    this->AnalyzeCompositeSentence(this->AddSyntaxChild(COMPOSITE_SENTENCE, node), TypeSymbol::VOID);
-    this->midcode_generator_->PrintReturn(true, "");
-    this->AddChild(node);    // RBRACE
-
-    this->midcode_generator_->PrintFuncEnd();
-    this->check_table_->AddFunctionVariableNumber(function->name(), reg_count_ - temp_reg);
-    this->InsertSymbolTable(function->name(), 1);
+    this->AnalyzeFunctionBody(node, function, TypeSymbol::VOID);
 }
 
 void ParseAnalyser::AnalyzeHeadState(SyntaxNode *node, Symbol *&function) {
@@ -890,82 +947,299 @@ void ParseAnalyser::AnalyzeHeadState(SyntaxNode *node, Symbol *&function) {
     this->SetSymbolType(type);
     this->AddChild(node);    // INTTK or CHARTK
     if (this->FindSymbol(0) != nullptr) {
-        error_handing_->AddError(iter_->line_number, REDEFINITION);
+        error_handing_->AddError(this->LineNumber(), REDEFINITION);
     }
     this->InsertIdentifier(KindSymbol::FUNCTION, type, 0);
     function = this->FindSymbol(0);
-    this->CleanLevel(1);
+    this->OpenFunctionScope();
     this->AddChild(node);    // IDENFR
 }
 
 void ParseAnalyser::AnalyzeFunc(SyntaxNode *node) {
-    auto function = new Symbol();
-    int temp_reg = reg_count_;
-    this->AnalyzeHeadState(this->AddSyntaxChild(HEAD_STATE, node), function);
+    Symbol *function = nullptr;
+    this->AnalyzeHeadState(this->AddSyntaxChild(SyntaxKind::HEAD_STATE, node), function);
     this->midcode_generator_->PrintFuncDeclare(function);
     this->AddChild(node);    // LPARENT
     this->AnalyzeParameterTable(
-            this->AddSyntaxChild(PARAMETER_TABLE, node), function);
+            this->AddSyntaxChild(SyntaxKind::PARAMETER_TABLE, node), function);
     this->AddRparentChild(node);    // RPARENT
-    this->AddChild(node);    // LBRACE
-    this->AnalyzeCompositeSentence(this->AddSyntaxChild(COMPOSITE_SENTENCE, node),
-                                   function->type());
-    this->AddChild(node);    // RBRACE
+    this->AnalyzeFunctionBody(node, function, function->type());
+}
 
-    midcode_generator_->PrintFuncEnd();
-    check_table_->AddFunctionVariableNumber(function->name(), reg_count_ - temp_reg);
-    this->InsertSymbolTable(function->name(), 1);
+// While pre-scanning only the header is parsed here; the body gets its own "function" span in
+// the worker that parses it (AnalyzeFunctionJob).
+void ParseAnalyser::BeginFunctionSpan() {
+    Profiler *profiler = Profiler::GetInstance();
+    if (profiler->is_enabled()) {
+        profiler->Begin(job_list_ == nullptr ? "function" : "header", Peek(1).value);    // Peek() is the return type
+    }
+}
+
+// While pre-scanning, each function's header is analysed into a job of its own: the job's
+// generator and error list are swapped in before the header and back out after it.
+void ParseAnalyser::BeginFunctionJob() {
+    if (job_list_ == nullptr) {
+        return;
+    }
+    FunctionJob job;
+    job.midcode_generator = new MidcodeGenerator();
+    job.string_table = new StringTable();
+    job.symbol_arena = new SymbolArena();
+    job.error_handing = new ErrorHanding();
+    job.temp_count = 0;
+    job_list_->push_back(job);
+    swap(midcode_generator_, job_list_->back().midcode_generator);
+    swap(error_handing_, job_list_->back().error_handing);
+}
+
+void ParseAnalyser::EndFunctionJob() {
+    if (job_list_ == nullptr) {
+        return;
+    }
+    swap(midcode_generator_, job_list_->back().midcode_generator);
+    swap(error_handing_, job_list_->back().error_handing);
 }
 
 void ParseAnalyser::BuildSyntaxTree(SyntaxNode *root) {
-    string flag = CONST_DECLARE;
-
-    int temp_reg = reg_count_;
-    bool first = true;
-
-    while (iter_ != iter_end_) {
-        if (this->IsThisIdentifier(CONSTTK)) {
-            this->AnalyzeConstDeclare(this->AddSyntaxChild(CONST_DECLARE, root), 0);
-        } else if (this->IsThisIdentifier(INTTK) || this->IsThisIdentifier(CHARTK)) {
-            if (flag == CONST_DECLARE) {
-                this->CountIterator(+2);
-                if (this->IsThisIdentifier(LPARENT)) {
-                    flag = RETURN_FUNCTION;
+    SyntaxKind flag = SyntaxKind::CONST_DECLARE;
+
+    while (!this->IsThisIdentifier(TokenKind::END)) {
+        if (this->IsThisIdentifier(TokenKind::CONSTTK)) {
+            this->AnalyzeConstDeclare(this->AddSyntaxChild(SyntaxKind::CONST_DECLARE, root), 0);
+        } else if (this->IsThisIdentifier(TokenKind::INTTK) || this->IsThisIdentifier(TokenKind::CHARTK)) {
+            if (flag == SyntaxKind::CONST_DECLARE) {
+                if (this->IsThisIdentifier(TokenKind::LPARENT, 2)) {
+                    flag = SyntaxKind::RETURN_FUNCTION;
                 } else {
-                    flag = VARIABLE_DECLARE;
+                    flag = SyntaxKind::VARIABLE_DECLARE;
                 }
-                this->CountIterator(-2);
             }
-            if (flag == RETURN_FUNCTION) {
-                this->AnalyzeFunc(this->AddSyntaxChild(RETURN_FUNCTION, root));
+            if (flag == SyntaxKind::RETURN_FUNCTION) {
+                this->BeginFunctionSpan();
+                this->BeginFunctionJob();
+                this->AnalyzeFunc(this->AddSyntaxChild(SyntaxKind::RETURN_FUNCTION, root));
+                this->EndFunctionJob();
+                Profiler::GetInstance()->End();
             } else {
-                this->AnalyzeVariableDeclare(this->AddSyntaxChild(VARIABLE_DECLARE, root), 0);
-                flag = RETURN_FUNCTION;
+                this->AnalyzeVariableDeclare(this->AddSyntaxChild(SyntaxKind::VARIABLE_DECLARE, root), 0);
+                flag = SyntaxKind::RETURN_FUNCTION;
             }
         } else {
-            if (first) {
-                check_table_->AddFunctionVariableNumber("global", reg_count_ - temp_reg);
-                first = false;
+            this->BeginFunctionSpan();
+            this->BeginFunctionJob();
+            if (this->IsThisIdentifier(TokenKind::MAINTK, 1)) {    // Peek() is VOIDTK
+                this->AnalyzeMain(this->AddSyntaxChild(SyntaxKind::MAIN_FUNCTION, root));
+            } else {
+                this->AnalyzeVoidFunc(this->AddSyntaxChild(SyntaxKind::NO_RETURN_FUNCTION, root));
             }
+            this->EndFunctionJob();
+            Profiler::GetInstance()->End();
+        }
+    }
+    this->InsertSymbolTable("global", 0);
+    check_table_->AddFunctionVariableNumber("global", 0);    // global declarations use no temporaries
+}
+
+static TokenKind KindAt(const vector<Lexeme> &lexeme_list, size_t i) {
+    return i < lexeme_list.size() ? lexeme_list[i].kind : TokenKind::END;
+}
+
+static bool IsTypeKind(TokenKind kind) {
+    return kind == TokenKind::INTTK || kind == TokenKind::CHARTK;
+}
 
-            if (this->IsThisIdentifier(VOIDTK)) {
-                this->CountIterator(+1);
+// Checks on the tokens alone that the program is global declarations followed by well-formed
+// function headers with brace-balanced bodies, so every body can be parsed on its own and no
+// top-level construct depends on how a body parses. Anything else is parsed serially.
+bool ParseAnalyser::IsFunctionSplittable() {
+    const vector<Lexeme> *lexeme_list = token_stream_->lexeme_list();
+    if (lexeme_list == nullptr || token_stream_->index() != 0) {
+        return false;
+    }
+    const vector<Lexeme> &list = *lexeme_list;
+
+    size_t i = 0;
+    set<int> global_id_set;
+    bool is_variable = false;
+    bool is_statement_start = true;
+    while (i < list.size()) {
+        TokenKind kind = list[i].kind;
+        if (kind == TokenKind::VOIDTK || (IsTypeKind(kind) && KindAt(list, i + 2) == TokenKind::LPARENT)) {
+            break;
+        }
+        if (kind == TokenKind::LPARENT || kind == TokenKind::RPARENT
+            || kind == TokenKind::LBRACE || kind == TokenKind::RBRACE) {
+            return false;
+        }
+        if (is_statement_start) {    // a const after the variables would start a function
+            if (kind == TokenKind::CONSTTK && is_variable) {
+                return false;
             }
-            if (this->IsThisIdentifier(MAINTK)) {
-                this->CountIterator(-1);
-                this->AnalyzeMain(this->AddSyntaxChild(MAIN_FUNCTION, root));
-            } else {
-                this->CountIterator(-1);
-                this->AnalyzeVoidFunc(this->AddSyntaxChild(NO_RETURN_FUNCTION, root));
+            is_variable = is_variable || IsTypeKind(kind);
+        }
+        if (kind == TokenKind::IDENFR) {
+            global_id_set.insert(list[i].symbol_id);
+        }
+        is_statement_start = kind == TokenKind::SEMICN;
+        i++;
+    }
+
+    set<int> function_id_set;
+    int function_count = 0;
+    while (i < list.size()) {
+        bool is_main = KindAt(list, i) == TokenKind::VOIDTK && KindAt(list, i + 1) == TokenKind::MAINTK;
+        if (!is_main) {
+            if ((!IsTypeKind(KindAt(list, i)) && KindAt(list, i) != TokenKind::VOIDTK)
+                || KindAt(list, i + 1) != TokenKind::IDENFR) {
+                return false;
+            }
+            int id = list[i + 1].symbol_id;
+            if (global_id_set.count(id) != 0 || !function_id_set.insert(id).second) {
+                return false;
+            }
+        }
+        i += 2;
+        if (KindAt(list, i++) != TokenKind::LPARENT) {
+            return false;
+        }
+        while (!is_main && IsTypeKind(KindAt(list, i))) {
+            if (KindAt(list, i + 1) != TokenKind::IDENFR) {
+                return false;
+            }
+            i += 2;
+            if (KindAt(list, i) != TokenKind::COMMA) {
+                break;
+            }
+            i++;
+        }
+        if (KindAt(list, i++) != TokenKind::RPARENT || KindAt(list, i) != TokenKind::LBRACE) {
+            return false;
+        }
+        int depth = 0;
+        do {
+            if (KindAt(list, i) == TokenKind::LBRACE) {
+                depth++;
+            } else if (KindAt(list, i) == TokenKind::RBRACE) {
+                depth--;
             }
+            i++;
+        } while (depth > 0 && i < list.size());
+        if (depth != 0) {
+            return false;
         }
+        function_count++;
     }
-    this->InsertSymbolTable("global", 0);
+    return function_count > 1;
+}
+
+void ParseAnalyser::AnalyzeFunctionJob(FunctionJob &job) {
+    Profiler *profiler = Profiler::GetInstance();
+    profiler->Begin("function", job.function->name());
+    TokenStream token_stream(token_stream_->lexeme_list(), job.begin, job.end);
+    ParseAnalyser worker(*this, job, &token_stream);
+    worker.AnalyzeFunctionBody(nullptr, job.function, job.return_type);
+    job.temp_count = worker.reg_max_;
+    profiler->End();
 }
 
-void ParseAnalyser::AnalyzeParse() {
-    auto root = new SyntaxNode(PROGRAM);
-    this->BuildSyntaxTree(root);
+// Appends one job in source order. Temporaries and labels are already numbered per function;
+// only the strings are shifted past those merged before, so the result is that of a serial parse.
+void ParseAnalyser::MergeFunctionJob(FunctionJob &job) {
+    Profiler *profiler = Profiler::GetInstance();
+    profiler->Begin("function", job.function->name());
+    int string_base = string_table_->GetStringCount();
+    for (Midcode *midcode : job.midcode_generator->midcode_list()) {
+        midcode->RebaseString(string_base);
+        midcode_generator_->AddMidcode(midcode);
+    }
+    for (int i = 0; i < job.string_table->GetStringCount(); i++) {
+        string_table_->AddString(job.string_table->GetString(i));
+    }
+    error_handing_->Append(*job.error_handing);
+    check_table_->AddFunctionVariableNumber(job.function->name(), job.temp_count);
+    symbol_table_map_.insert(pair<string, SymbolTable *>(job.function->name(), job.symbol_table));
+    symbol_arena_->Append(*job.symbol_arena);
+    temp_count_ += job.temp_count;
+
+    delete job.midcode_generator;
+    delete job.string_table;
+    delete job.symbol_arena;
+    delete job.error_handing;
+    profiler->End();
+}
+
+// Pre-scans the top level serially -- globals and function headers, skipping the bodies --
+// then parses the bodies on job_count threads and merges them in source order.
+bool ParseAnalyser::AnalyzeParallel(int job_count) {
+    Profiler *profiler = Profiler::GetInstance();
+    if (!this->IsFunctionSplittable()) {
+        return false;
+    }
+
+    profiler->Begin("prescan");
+    vector<FunctionJob> job_list;
+    job_list_ = &job_list;
+    this->BuildSyntaxTree(nullptr);
+    job_list_ = nullptr;
+    profiler->End();
+
+    profiler->Begin("function jobs");
+    source_->Line(0);    // builds the line index before the workers share it
+    atomic<size_t> next(0);
+    vector<thread> worker_list;
+    for (int i = 0; i < job_count && i < (int) job_list.size(); i++) {
+        worker_list.emplace_back([&]() {
+            Profiler *worker_profiler = Profiler::GetInstance();
+            if (profiler->is_enabled()) {
+                worker_profiler->Enable();
+            }
+            size_t index;
+            while ((index = next++) < job_list.size()) {
+                this->AnalyzeFunctionJob(job_list[index]);
+            }
+            worker_profiler->Flush();
+            profiler->Adopt(*worker_profiler);
+        });
+    }
+    for (thread &worker : worker_list) {
+        worker.join();
+    }
+    profiler->End();
+
+    profiler->Begin("merge");
+    for (FunctionJob &job : job_list) {
+        this->MergeFunctionJob(job);
+    }
+    profiler->End();
+    return true;
+}
+
+// The concrete syntax tree is only materialized when is_syntax_tree is set, i.e. for the dump;
+// without one, job_count > 1 lets the function bodies be parsed in parallel.
+void ParseAnalyser::AnalyzeParse(bool is_syntax_tree, int job_count) {
+    if (!is_syntax_tree) {
+        if (job_count <= 1 || !this->AnalyzeParallel(job_count)) {
+            this->BuildSyntaxTree(nullptr);
+        }
+        return;
+    }
+    syntax_tree_ = new SyntaxTree();
+    this->BuildSyntaxTree(syntax_tree_->AddRoot(SyntaxKind::PROGRAM));
+    syntax_node_count_ = syntax_tree_->node_count();
+}
+
+bool ParseAnalyser::PrintSyntaxTree(const string &file_name) {
+    ofstream output(file_name);
+    if (syntax_tree_ != nullptr) {
+        syntax_tree_->Print(output);
+    }
+    return (bool) output;
+}
+
+// Midcode is emitted while parsing, so the tree is only kept until the caller is done with it.
+void ParseAnalyser::FreeSyntaxTree() {
+    delete syntax_tree_;
+    syntax_tree_ = nullptr;
 }
 
 map<string, SymbolTable *> ParseAnalyser::symbol_table_map() {
@@ -984,8 +1258,12 @@ CheckTable *ParseAnalyser::check_table() {
     return check_table_;
 }
 
-int ParseAnalyser::reg_count() const {
-    return reg_count_;
+int ParseAnalyser::temp_count() const {
+    return temp_count_;
+}
+
+int ParseAnalyser::syntax_node_count() {
+    return syntax_node_count_;
 }
 
 void ParseAnalyser::FileClose() {
@@ -0,0 +1,333 @@
+﻿#include "profiler.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <new>
+#include <sstream>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#endif
+
+using namespace std;
+
+// Heap accounting starts when the first profiler is enabled; until then operator new is
+// malloc plus one relaxed load. Every thread counts the bytes it allocates less those it frees,
+// with the peak of that count, so nothing is shared per allocation; a thread's count joins
+// heap_retired_bytes when it exits. Block sizes come from the C library (BlockSize), so no header
+// is needed and blocks allocated before accounting started are freed the same way; where it
+// cannot tell a block's size the heap figures stay 0.
+struct HeapCounter {
+    long long current;
+    long long peak;
+    bool is_retired;
+
+    ~HeapCounter() {
+        Retire();
+    }
+
+    void Retire();
+};
+
+static atomic<bool> is_heap_counted(false);
+static atomic<long long> heap_retired_bytes(0);
+static thread_local HeapCounter heap_counter = {0, 0, false};
+
+void HeapCounter::Retire() {
+    if (!is_retired) {
+        heap_retired_bytes += current;
+        is_retired = true;
+    }
+}
+
+static void CountHeap(long long size) {
+    if (heap_counter.is_retired) {     // freed while the thread is exiting
+        heap_retired_bytes += size;
+        return;
+    }
+    heap_counter.current += size;
+    if (heap_counter.current > heap_counter.peak) {
+        heap_counter.peak = heap_counter.current;
+    }
+}
+
+static const chrono::steady_clock::time_point process_start = chrono::steady_clock::now();
+static atomic<int> next_thread_id(1);
+static mutex trace_mutex;
+static mutex adopt_mutex;
+static vector<string> trace_event_list;
+
+static long long BlockSize(void *pointer) {
+#if defined(__GLIBC__)
+    return (long long) malloc_usable_size(pointer);
+#elif defined(__APPLE__)
+    return (long long) malloc_size(pointer);
+#else
+    return 0;
+#endif
+}
+
+static void *Allocate(size_t size) {
+    void *pointer = malloc(size > 0 ? size : 1);
+    if (pointer != nullptr && is_heap_counted.load(memory_order_relaxed)) {
+        CountHeap(BlockSize(pointer));
+    }
+    return pointer;
+}
+
+static void CountRelease(void *pointer) {
+    if (pointer != nullptr && is_heap_counted.load(memory_order_relaxed)) {
+        CountHeap(-BlockSize(pointer));
+    }
+}
+
+void *operator new(size_t size) {
+    void *pointer = Allocate(size);
+    if (pointer == nullptr) {
+        throw bad_alloc();
+    }
+    return pointer;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void *operator new(size_t size, const nothrow_t &) noexcept {
+    return Allocate(size);
+}
+
+void *operator new[](size_t size, const nothrow_t &) noexcept {
+    return Allocate(size);
+}
+
+// Kept out of line: inlined into a container in this file, GCC would see operator new's block
+// reach free and warn (-Wmismatched-new-delete).
+__attribute__((noinline)) void operator delete(void *pointer) noexcept {
+    CountRelease(pointer);
+    free(pointer);
+}
+
+__attribute__((noinline)) void operator delete[](void *pointer) noexcept {
+    CountRelease(pointer);
+    free(pointer);
+}
+
+__attribute__((noinline)) void operator delete(void *pointer, const nothrow_t &) noexcept {
+    CountRelease(pointer);
+    free(pointer);
+}
+
+__attribute__((noinline)) void operator delete[](void *pointer, const nothrow_t &) noexcept {
+    CountRelease(pointer);
+    free(pointer);
+}
+
+Profiler::Profiler() {
+    is_enabled_ = false;
+    thread_id_ = 0;
+    flush_count_ = 0;
+}
+
+Profiler *Profiler::GetInstance() {
+    static thread_local Profiler profiler;
+    return &profiler;
+}
+
+// this thread's count plus those of the threads that have exited
+long long Profiler::heap_current() {
+    return heap_retired_bytes.load() + (heap_counter.is_retired ? 0 : heap_counter.current);
+}
+
+long long Profiler::Now() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - process_start).count();
+}
+
+string Profiler::Escape(const string &str) {
+    string escape;
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            escape.push_back('\\');
+            escape.push_back(c);
+        } else if ((unsigned char) c < 0x20) {
+            escape.push_back(' ');
+        } else {
+            escape.push_back(c);
+        }
+    }
+    return escape;
+}
+
+void Profiler::Enable() {
+    is_enabled_ = true;
+    is_heap_counted = true;
+    if (thread_id_ == 0) {
+        thread_id_ = next_thread_id++;
+    }
+}
+
+bool Profiler::is_enabled() const {
+    return is_enabled_;
+}
+
+void Profiler::Begin(const string &name, const string &detail) {
+    if (!is_enabled_) {
+        return;
+    }
+
+    Span span;
+    span.name = name;
+    span.detail = detail;
+    span.depth = (int) stack_.size();
+    span.begin_heap = heap_counter.current;
+    span.outer_peak = heap_counter.peak;
+    heap_counter.peak = heap_counter.current;
+    span.begin_time = Now();
+    span.is_adopted = false;
+    stack_.push_back(span_list_.size());
+    span_list_.push_back(span);
+}
+
+void Profiler::End() {
+    if (!is_enabled_ || stack_.empty()) {
+        return;
+    }
+
+    Span &span = span_list_[stack_.back()];
+    stack_.pop_back();
+    span.end_time = Now();
+    span.end_heap = heap_counter.current;
+    span.peak_heap = heap_counter.peak;
+    heap_counter.peak = max(span.outer_peak, heap_counter.peak);
+}
+
+void Profiler::AddCount(const string &name, long long count) {
+    if (!is_enabled_) {
+        return;
+    }
+    for (auto &item : count_list_) {
+        if (item.first == name) {
+            item.second = count;
+            return;
+        }
+    }
+    count_list_.emplace_back(name, count);
+}
+
+void Profiler::Adopt(const Profiler &worker) {
+    if (!is_enabled_) {
+        return;
+    }
+
+    lock_guard<mutex> lock(adopt_mutex);
+    for (const Span &worker_span : worker.span_list_) {
+        Span span = worker_span;
+        span.depth += (int) stack_.size();
+        span.is_adopted = true;
+        span_list_.push_back(span);
+    }
+}
+
+void Profiler::Report(ostream &output) const {
+    struct Row {
+        string name;
+        int depth;
+        int call_count;
+        long long time;
+        long long peak_heap;
+        long long retained_heap;
+    };
+
+    // spans with the same nesting path are merged into one row, in first-seen order
+    vector<Row> row_list;
+    map<string, size_t> row_map;
+    vector<string> path_stack;
+    long long total_time = 0;
+    for (const Span &span : span_list_) {
+        path_stack.resize(span.depth);
+        path_stack.push_back((span.depth > 0 ? path_stack[span.depth - 1] + "/" : "") + span.name);
+        if (row_map.find(path_stack.back()) == row_map.end()) {
+            row_map[path_stack.back()] = row_list.size();
+            row_list.push_back({span.name, span.depth, 0, 0, 0, 0});
+        }
+        Row &row = row_list[row_map[path_stack.back()]];
+        row.call_count++;
+        row.time += span.end_time - span.begin_time;
+        row.peak_heap = max(row.peak_heap, span.peak_heap - span.begin_heap);
+        row.retained_heap += span.end_heap - span.begin_heap;
+        if (span.depth == 0) {
+            total_time += span.end_time - span.begin_time;
+        }
+    }
+
+    output << "===------------------------------------------------------------------===" << endl
+           << "                       Compiler phase report" << endl
+           << "===------------------------------------------------------------------===" << endl
+           << "  " << left << setw(32) << "phase" << right << setw(8) << "calls" << setw(12) << "time(ms)"
+           << setw(8) << "%" << setw(14) << "peak heap(KB)" << setw(14) << "retained(KB)" << endl;
+    output << fixed;
+    for (const Row &row : row_list) {
+        output << "  " << left << setw(32) << string(2 * row.depth, ' ') + row.name << right
+               << setw(8) << row.call_count
+               << setw(12) << setprecision(3) << row.time / 1e6
+               << setw(8) << setprecision(1) << (total_time > 0 ? 100.0 * row.time / total_time : 0.0)
+               << setw(14) << setprecision(1) << row.peak_heap / 1024.0
+               << setw(14) << setprecision(1) << row.retained_heap / 1024.0 << endl;
+    }
+    output << "  " << left << setw(32) << "total" << right << setw(8) << "" << setw(12) << setprecision(3)
+           << total_time / 1e6 << endl << endl;
+
+    for (const auto &item : count_list_) {
+        output << "  " << left << setw(32) << item.first << right << setw(12) << item.second << endl;
+    }
+    output << "  " << left << setw(32) << "live heap(KB)" << right << setw(12) << setprecision(1)
+           << heap_current() / 1024.0 << endl;
+    output.unsetf(ios::floatfield);
+    output.unsetf(ios::adjustfield);
+}
+
+void Profiler::Flush() {
+    if (!is_enabled_ || !stack_.empty()) {
+        return;
+    }
+
+    vector<string> event_list;
+    for (; flush_count_ < span_list_.size(); flush_count_++) {
+        const Span &span = span_list_[flush_count_];
+        if (span.is_adopted) {
+            continue;
+        }
+        ostringstream event;
+        event << fixed << setprecision(3)
+              << "{\"name\":\"" << Escape(span.detail.empty() ? span.name : span.detail)
+              << "\",\"cat\":\"" << Escape(span.name)
+              << "\",\"ph\":\"X\",\"ts\":" << span.begin_time / 1e3
+              << ",\"dur\":" << (span.end_time - span.begin_time) / 1e3
+              << ",\"pid\":1,\"tid\":" << thread_id_
+              << ",\"args\":{\"peak_heap\":" << span.peak_heap - span.begin_heap
+              << ",\"retained_heap\":" << span.end_heap - span.begin_heap << "}}";
+        event_list.push_back(event.str());
+    }
+
+    lock_guard<mutex> lock(trace_mutex);
+    trace_event_list.insert(trace_event_list.end(), event_list.begin(), event_list.end());
+}
+
+bool Profiler::WriteTrace(const string &file_name) {
+    GetInstance()->Flush();
+
+    ofstream trace(file_name);
+    lock_guard<mutex> lock(trace_mutex);
+    trace << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << endl;
+    for (size_t i = 0; i < trace_event_list.size(); i++) {
+        trace << trace_event_list[i] << (i + 1 < trace_event_list.size() ? "," : "") << endl;
+    }
+    trace << "]}" << endl;
+    return (bool) trace;
+}
\ No newline at end of file
@@ -0,0 +1,154 @@
+﻿#include "scanner.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define SCANNER_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// Scalar kernels: the fallback, and the tail of every vector kernel.
+
+static inline bool IsSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline bool IsIdentifier(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static inline bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline bool IsStringLetter(char c) {
+    return c >= 32 && c <= 126 && c != '"';
+}
+
+static const char *SkipSpaceScalar(const char *begin, const char *end) {
+    while (begin < end && IsSpace(*begin)) {
+        begin++;
+    }
+    return begin;
+}
+
+static const char *SkipIdentifierScalar(const char *begin, const char *end) {
+    while (begin < end && IsIdentifier(*begin)) {
+        begin++;
+    }
+    return begin;
+}
+
+static const char *SkipDigitScalar(const char *begin, const char *end) {
+    while (begin < end && IsDigit(*begin)) {
+        begin++;
+    }
+    return begin;
+}
+
+static const char *SkipStringLetterScalar(const char *begin, const char *end) {
+    while (begin < end && IsStringLetter(*begin)) {
+        begin++;
+    }
+    return begin;
+}
+
+#ifdef SCANNER_X86
+
+// The vector kernels build a byte mask of "in class" with signed compares; bytes >= 0x80 are
+// negative and so fall outside every class, as they do for the <cctype> checks in the C locale.
+
+#define SSE2_IN_RANGE(x, lo, hi) \
+    _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8((char) ((lo) - 1))), \
+                  _mm_cmplt_epi8(x, _mm_set1_epi8((char) ((hi) + 1))))
+
+#define AVX2_IN_RANGE(x, lo, hi) \
+    _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8((char) ((lo) - 1))), \
+                     _mm256_cmpgt_epi8(_mm256_set1_epi8((char) ((hi) + 1)), x))
+
+static inline __m128i SpaceMaskSse2(__m128i x) {
+    return _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')), SSE2_IN_RANGE(x, '\t', '\r'));
+}
+
+static inline __m128i IdentifierMaskSse2(__m128i x) {
+    __m128i lower = _mm_or_si128(x, _mm_set1_epi8(0x20));    // folds A-Z onto a-z
+    return _mm_or_si128(_mm_or_si128(SSE2_IN_RANGE(lower, 'a', 'z'), SSE2_IN_RANGE(x, '0', '9')),
+                        _mm_cmpeq_epi8(x, _mm_set1_epi8('_')));
+}
+
+static inline __m128i DigitMaskSse2(__m128i x) {
+    return SSE2_IN_RANGE(x, '0', '9');
+}
+
+static inline __m128i StringLetterMaskSse2(__m128i x) {
+    return _mm_andnot_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('"')), SSE2_IN_RANGE(x, 32, 126));
+}
+
+#define DEFINE_SKIP_SSE2(Name, Mask) \
+    static const char *Name##Sse2(const char *begin, const char *end) { \
+        while (end - begin >= 16) { \
+            unsigned mask = (unsigned) _mm_movemask_epi8(Mask(_mm_loadu_si128((const __m128i *) begin))); \
+            if (mask != 0xFFFF) { \
+                return begin + __builtin_ctz(~mask); \
+            } \
+            begin += 16; \
+        } \
+        return Name##Scalar(begin, end); \
+    }
+
+DEFINE_SKIP_SSE2(SkipSpace, SpaceMaskSse2)
+DEFINE_SKIP_SSE2(SkipIdentifier, IdentifierMaskSse2)
+DEFINE_SKIP_SSE2(SkipDigit, DigitMaskSse2)
+DEFINE_SKIP_SSE2(SkipStringLetter, StringLetterMaskSse2)
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET static inline __m256i SpaceMaskAvx2(__m256i x) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')), AVX2_IN_RANGE(x, '\t', '\r'));
+}
+
+AVX2_TARGET static inline __m256i IdentifierMaskAvx2(__m256i x) {
+    __m256i lower = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+    return _mm256_or_si256(_mm256_or_si256(AVX2_IN_RANGE(lower, 'a', 'z'), AVX2_IN_RANGE(x, '0', '9')),
+                           _mm256_cmpeq_epi8(x, _mm256_set1_epi8('_')));
+}
+
+AVX2_TARGET static inline __m256i DigitMaskAvx2(__m256i x) {
+    return AVX2_IN_RANGE(x, '0', '9');
+}
+
+AVX2_TARGET static inline __m256i StringLetterMaskAvx2(__m256i x) {
+    return _mm256_andnot_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('"')), AVX2_IN_RANGE(x, 32, 126));
+}
+
+#define DEFINE_SKIP_AVX2(Name, Mask) \
+    AVX2_TARGET static const char *Name##Avx2(const char *begin, const char *end) { \
+        while (end - begin >= 32) { \
+            unsigned mask = (unsigned) _mm256_movemask_epi8(Mask(_mm256_loadu_si256((const __m256i *) begin))); \
+            if (mask != 0xFFFFFFFFu) { \
+                return begin + __builtin_ctz(~mask); \
+            } \
+            begin += 32; \
+        } \
+        return Name##Sse2(begin, end); \
+    }
+
+DEFINE_SKIP_AVX2(SkipSpace, SpaceMaskAvx2)
+DEFINE_SKIP_AVX2(SkipIdentifier, IdentifierMaskAvx2)
+DEFINE_SKIP_AVX2(SkipDigit, DigitMaskAvx2)
+DEFINE_SKIP_AVX2(SkipStringLetter, StringLetterMaskAvx2)
+
+#endif
+
+const Scanner::Kernel &Scanner::kernel() {
+    static const Kernel scalar = {SkipSpaceScalar, SkipIdentifierScalar, SkipDigitScalar, SkipStringLetterScalar};
+#ifdef SCANNER_X86
+    static const Kernel sse2 = {SkipSpaceSse2, SkipIdentifierSse2, SkipDigitSse2, SkipStringLetterSse2};
+    static const Kernel avx2 = {SkipSpaceAvx2, SkipIdentifierAvx2, SkipDigitAvx2, SkipStringLetterAvx2};
+    static const Kernel &selected = __builtin_cpu_supports("avx2") ? avx2
+                                    : __builtin_cpu_supports("sse2") ? sse2 : scalar;
+    return selected;
+#else
+    return scalar;
+#endif
+}
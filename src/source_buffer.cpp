@@ -0,0 +1,114 @@
+﻿#include "source_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+SourceBuffer::SourceBuffer() {
+    data_ = "";
+    size_ = 0;
+    map_ = nullptr;
+    map_size_ = 0;
+}
+
+SourceBuffer::~SourceBuffer() {
+    Unmap();
+}
+
+void SourceBuffer::Unmap() {
+    if (map_ != nullptr) {
+        munmap(map_, map_size_);
+        map_ = nullptr;
+        map_size_ = 0;
+    }
+}
+
+bool SourceBuffer::Open(const string &file_name) {
+    Unmap();
+    text_.clear();
+    line_start_list_.clear();
+    data_ = "";
+    size_ = 0;
+
+    int fd = file_name == "-" ? dup(STDIN_FILENO) : open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void *map = mmap(nullptr, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            madvise(map, (size_t) info.st_size, MADV_SEQUENTIAL);
+            map_ = map;
+            map_size_ = (size_t) info.st_size;
+            data_ = (const char *) map;
+            size_ = map_size_;
+            close(fd);
+            return true;
+        }
+    }
+
+    // not mappable (pipe, empty file, ...): read it into an owned buffer instead
+    char block[1 << 16];
+    ssize_t count;
+    while ((count = read(fd, block, sizeof(block))) > 0) {
+        text_.append(block, (size_t) count);
+    }
+    close(fd);
+    data_ = text_.data();
+    size_ = text_.size();
+    return count == 0;
+}
+
+void SourceBuffer::Assign(const string &text) {
+    Unmap();
+    line_start_list_.clear();
+    text_ = text;
+    data_ = text_.data();
+    size_ = text_.size();
+}
+
+const char *SourceBuffer::data() const {
+    return data_;
+}
+
+size_t SourceBuffer::size() const {
+    return size_;
+}
+
+// memchr is vectorized in the C library, so this is a SIMD newline scan without any of our own kernels.
+void SourceBuffer::BuildLineIndex() const {
+    line_start_list_.push_back(0);
+    const char *begin = data_;
+    const char *end = data_ + size_;
+    while (begin < end) {
+        auto newline = (const char *) memchr(begin, '\n', (size_t) (end - begin));
+        if (newline == nullptr) {
+            break;
+        }
+        line_start_list_.push_back((size_t) (newline + 1 - data_));
+        begin = newline + 1;
+    }
+}
+
+// index of the line holding offset; offsets past the end belong to the last line
+size_t SourceBuffer::FindLine(size_t offset) const {
+    if (line_start_list_.empty()) {
+        this->BuildLineIndex();
+    }
+    return upper_bound(line_start_list_.begin(), line_start_list_.end(), offset) - line_start_list_.begin() - 1;
+}
+
+int SourceBuffer::Line(size_t offset) const {
+    return (int) this->FindLine(offset) + 1;
+}
+
+int SourceBuffer::Column(size_t offset) const {
+    return (int) (offset - line_start_list_[this->FindLine(offset)]) + 1;
+}
\ No newline at end of file
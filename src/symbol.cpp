@@ -4,22 +4,39 @@
 
 using namespace std;
 
+static const string empty_name;
+
 Symbol::Symbol() {
+    id_ = -1;
+    index_ = -1;
+    name_ = &empty_name;
+    has_const_value_ = false;
+    const_value_ = 0;
     array_length_ = 0;
     reg_number_ = 0;
     offset_ = 0;
+    level_ = 0;
     kind_ = KindSymbol::CONST;
     type_ = TypeSymbol::INT;
 }
 
-void Symbol::SetProperty(const string &name, KindSymbol kind, TypeSymbol type) {
+void Symbol::SetProperty(int id, const string *name, KindSymbol kind, TypeSymbol type) {
+    id_ = id;
     name_ = name;
     kind_ = kind;
     type_ = type;
 }
 
-string Symbol::name() {
-    return name_;
+int Symbol::id() const {
+    return id_;
+}
+
+int Symbol::index() const {
+    return index_;
+}
+
+const string &Symbol::name() const {
+    return *name_;
 }
 
 KindSymbol Symbol::kind() {
@@ -34,26 +51,38 @@ TypeSymbol Symbol::type() {
     return type_;
 }
 
-void Symbol::AddParameter(char c) {
-    parameter_.push_back(c);
+void Symbol::AddParameter(TypeSymbol type) {
+    parameter_list_.push_back(type);
 }
 
-string Symbol::parameter() {
-    return parameter_;
+const vector<TypeSymbol> &Symbol::parameter_list() const {
+    return parameter_list_;
 }
 
-int Symbol::GetParameterCount() {
-    return parameter_.length();
+int Symbol::GetParameterCount() const {
+    return (int) parameter_list_.size();
 }
 
-void Symbol::set_const_value(const string &const_value) {
+void Symbol::set_const_value(int const_value) {
+    has_const_value_ = true;
     const_value_ = const_value;
 }
 
-string Symbol::const_value() {
+bool Symbol::has_const_value() const {
+    return has_const_value_;
+}
+
+int Symbol::const_value() const {
     return const_value_;
 }
 
+string Symbol::GetConstOperand() const {
+    if (type_ == TypeSymbol::CHAR) {
+        return string("\'") + (char) const_value_ + "\'";
+    }
+    return to_string(const_value_);
+}
+
 void Symbol::set_array_length(int array_length) {
     array_length_ = array_length;
 }
@@ -76,4 +105,56 @@ void Symbol::set_offset(int sp_offer) {
 
 int Symbol::offset() const {
     return offset_;
+}
+
+void Symbol::set_level(int level) {
+    level_ = level;
+}
+
+int Symbol::level() const {
+    return level_;
+}
+
+SymbolArena::SymbolArena() {
+    chunk_ = nullptr;
+    chunk_used_ = 0;
+}
+
+SymbolArena::~SymbolArena() {
+    for (Symbol *chunk : chunk_list_) {
+        delete[] chunk;
+    }
+}
+
+Symbol *SymbolArena::NewSymbol() {
+    if (chunk_ == nullptr || chunk_used_ == SYMBOL_CHUNK_SIZE) {
+        chunk_ = new Symbol[SYMBOL_CHUNK_SIZE];
+        chunk_list_.push_back(chunk_);
+        chunk_used_ = 0;
+    }
+    Symbol *symbol = &chunk_[chunk_used_++];
+    symbol->index_ = (int) symbol_list_.size();
+    symbol_list_.push_back(symbol);
+    return symbol;
+}
+
+// Only the chunks change hands; the symbols stay where they are and are renumbered.
+void SymbolArena::Append(SymbolArena &other) {
+    chunk_list_.insert(chunk_list_.end(), other.chunk_list_.begin(), other.chunk_list_.end());
+    for (Symbol *symbol : other.symbol_list_) {
+        symbol->index_ = (int) symbol_list_.size();
+        symbol_list_.push_back(symbol);
+    }
+    other.chunk_list_.clear();
+    other.chunk_ = nullptr;
+    other.chunk_used_ = 0;
+    other.symbol_list_.clear();
+}
+
+int SymbolArena::size() const {
+    return (int) symbol_list_.size();
+}
+
+Symbol *SymbolArena::symbol(int index) const {
+    return symbol_list_[index];
 }
\ No newline at end of file
@@ -1,91 +1,153 @@
 ﻿#include "syntax_node.h"
-#include <utility>
 
 using namespace std;
 
-SyntaxNode::SyntaxNode() = default;
+const char *SyntaxName(SyntaxKind kind) {
+    static const char *name_list[] = {
+            "",
+            "<字符串>", "<程序>", "<常量说明>", "<常量定义>", "<无符号整数>", "<整数>", "<声明头部>",
+            "<变量说明>", "<变量定义>", "<有返回值函数定义>", "<无返回值函数定义>",
+            "<复合语句>", "<参数表>", "<主函数>",
+            "<表达式>", "<项>", "<因子>",
+            "<语句>", "<赋值语句>", "<条件语句>", "<条件>", "<循环语句>", "<步长>",
+            "<有返回值函数调用语句>", "<无返回值函数调用语句>", "<值参数表>",
+            "<语句列>", "<读语句>", "<写语句>", "<返回语句>"
+    };
+    return name_list[(int) kind];
+}
 
-SyntaxNode::SyntaxNode(const string &syntax_identifier) {
-    this->syntax_identifier_ = syntax_identifier;
+SyntaxKind SyntaxNode::kind() const {
+    return kind_;
 }
 
-SyntaxNode::SyntaxNode(const string &lexeme_identifier, const string &lexeme_value) {
-    this->lexeme_identifier_ = lexeme_identifier;
-    this->lexeme_value_ = lexeme_value;
+TokenKind SyntaxNode::token_kind() const {
+    return token_kind_;
 }
 
-void SyntaxNode::set_syntax_identifier(const string &syntax_identifier) {
-    this->syntax_identifier_ = syntax_identifier;
+StringRef SyntaxNode::lexeme() const {
+    return StringRef(lexeme_data_, lexeme_size_);
 }
 
-void SyntaxNode::set_value(const string &value) {
-    this->value_ = value;
+bool SyntaxNode::IsLeaf() const {
+    return first_child_ == nullptr;
 }
 
-bool SyntaxNode::IsLeaf() {
-    return child_list_.empty();
+SyntaxNode *SyntaxNode::first_child() const {
+    return first_child_;
 }
 
-bool SyntaxNode::IsLexemeEmpty() {
-    return this->lexeme_identifier_.empty();
+SyntaxNode *SyntaxNode::next_sibling() const {
+    return next_sibling_;
 }
 
-void SyntaxNode::AddChild(SyntaxNode *child) {
-    child_list_.push_back(child);
+// Appends this node's own dump line; the children are printed by SyntaxTree::Print.
+void SyntaxNode::Print(string &buffer) const {
+    if (kind_ == SyntaxKind::TOKEN) {
+        buffer += TokenName(token_kind_);
+        buffer.push_back(' ');
+        buffer.append(lexeme_data_, lexeme_size_);
+    } else {
+        buffer += SyntaxName(kind_);
+    }
+    buffer.push_back('\n');
 }
 
-string SyntaxNode::syntax_identifier() {
-    return syntax_identifier_;
+SyntaxTree::SyntaxTree() {
+    node_count_ = 0;
+    root_ = nullptr;
 }
 
-string SyntaxNode::lexeme_identifier() {
-    return lexeme_identifier_;
+SyntaxTree::~SyntaxTree() {
+    for (SyntaxNode *chunk : chunk_list_) {
+        delete[] chunk;
+    }
 }
 
-string SyntaxNode::lexeme_value() {
-    return lexeme_value_;
+SyntaxNode *SyntaxTree::NewNode(SyntaxNode *parent) {
+    if (node_count_ % SYNTAX_CHUNK_SIZE == 0) {
+        chunk_list_.push_back(new SyntaxNode[SYNTAX_CHUNK_SIZE]);
+    }
+    SyntaxNode *node = &chunk_list_.back()[node_count_ % SYNTAX_CHUNK_SIZE];
+    node_count_++;
+
+    node->kind_ = SyntaxKind::TOKEN;
+    node->token_kind_ = TokenKind::END;
+    node->lexeme_size_ = 0;
+    node->lexeme_data_ = nullptr;
+    node->first_child_ = nullptr;
+    node->last_child_ = nullptr;
+    node->next_sibling_ = nullptr;
+    if (parent != nullptr) {
+        if (parent->last_child_ == nullptr) {
+            parent->first_child_ = node;
+        } else {
+            parent->last_child_->next_sibling_ = node;
+        }
+        parent->last_child_ = node;
+    }
+    return node;
 }
 
-string SyntaxNode::value() {
-    return value_;
+SyntaxNode *SyntaxTree::AddRoot(SyntaxKind kind) {
+    root_ = this->NewNode(nullptr);
+    root_->kind_ = kind;
+    return root_;
 }
 
-string SyntaxNode::GetFirstChildNumericalValue() {
-    return child_list_.front()->value();
+SyntaxNode *SyntaxTree::AddSyntax(SyntaxNode *parent, SyntaxKind kind) {
+    SyntaxNode *node = this->NewNode(parent);
+    node->kind_ = kind;
+    return node;
 }
 
-list<SyntaxNode *> SyntaxNode::GetChildList() {
-    return child_list_;
+void SyntaxTree::AddToken(SyntaxNode *parent, const Lexeme &lexeme) {
+    SyntaxNode *node = this->NewNode(parent);
+    node->token_kind_ = lexeme.kind;
+    node->lexeme_size_ = (unsigned) lexeme.value.size();
+    node->lexeme_data_ = lexeme.value.data();
 }
 
-void SyntaxNode::WriteLexical(ofstream &output) {
-    output << this->lexeme_identifier() << " " << lexeme_value() << endl;
+SyntaxNode *SyntaxTree::root() const {
+    return root_;
 }
 
-void SyntaxNode::WriteSyntax(ofstream &output) {
-    output << this->syntax_identifier() << endl;
+int SyntaxTree::node_count() const {
+    return node_count_;
 }
 
-void SyntaxNode::Print(ofstream &output) {
-    if (this->IsLeaf()) {
-        if (this->IsLexemeEmpty()) {
-            this->WriteSyntax(output);
-        } else {
-            this->WriteLexical(output);
-        }
-    } else {
-        auto childList = this->GetChildList();
-        auto iter = childList.begin();
+// Post-order walk with an explicit stack of ancestors, so deeply nested expressions cannot
+// overflow the call stack; lines are gathered in a buffer and written in large blocks.
+void SyntaxTree::Print(ofstream &output) const {
+    if (root_ == nullptr) {
+        return;
+    }
 
-        while (iter != childList.end()) {
-            (*iter)->Print(output);
-            iter++;
+    vector<const SyntaxNode *> stack;
+    string buffer;
+    buffer.reserve(SYNTAX_PRINT_BUFFER + 256);
+    const SyntaxNode *node = root_;
+    while (node != nullptr) {
+        while (node->first_child_ != nullptr) {
+            stack.push_back(node);
+            node = node->first_child_;
         }
-
-        if (this->IsLexemeEmpty()) {
-            this->WriteSyntax(output);
-        } else {
-            this->WriteLexical(output);
+        while (true) {
+            node->Print(buffer);
+            if (buffer.size() >= SYNTAX_PRINT_BUFFER) {
+                output.write(buffer.data(), (streamsize) buffer.size());
+                buffer.clear();
+            }
+            if (node->next_sibling_ != nullptr) {
+                node = node->next_sibling_;
+                break;
+            }
+            if (stack.empty()) {
+                node = nullptr;
+                break;
+            }
+            node = stack.back();
+            stack.pop_back();
         }
     }
+    output.write(buffer.data(), (streamsize) buffer.size());
 }
\ No newline at end of file
@@ -1,4 +1,7 @@
 ﻿#include "table.h"
+
+#include <algorithm>
+#include <cassert>
 #include <utility>
 
 using namespace std;
@@ -29,82 +32,143 @@ string StringTable::GetString(int string_number) {
 
 
 // SymbolTable
-SymbolTable::SymbolTable() = default;
+SymbolTable::SymbolTable() {
+    this->slot_list_.assign(SYMBOL_TABLE_CAPACITY, nullptr);
+}
 
-Symbol *SymbolTable::AddSymbol(const string &name, KindSymbol kind, TypeSymbol type) {
-    Symbol *symbol = this->FindSymbol(name);
-    if (symbol != nullptr) {
-        symbol->SetProperty(name, kind, type);
-    } else {
-        symbol = new Symbol();
-        symbol->SetProperty(name, kind, type);
-        this->symbol_map_.insert(pair<string, Symbol *>(name, symbol));
+// the slot holding id, or the empty slot where it would go
+size_t SymbolTable::Probe(int id) const {
+    size_t mask = this->slot_list_.size() - 1;
+    size_t slot = ((unsigned) id * 2654435761u) & mask;
+    while (this->slot_list_[slot] != nullptr && this->slot_list_[slot]->id() != id) {
+        slot = (slot + 1) & mask;
     }
-    return symbol;
+    return slot;
 }
 
-Symbol *SymbolTable::FindSymbol(const string &name) {
-    auto iter = this->symbol_map_.find(name);
+void SymbolTable::Grow() {
+    this->slot_list_.assign(2 * this->slot_list_.size(), nullptr);
+    for (Symbol *symbol : this->symbol_list_) {
+        this->slot_list_[this->Probe(symbol->id())] = symbol;
+    }
+}
 
-    if (iter == this->symbol_map_.end()) {
-        return nullptr;
-    } else {
-        return iter->second;
+// Grow re-inserts in declaration order, so the newest symbol for an id keeps the slot.
+void SymbolTable::AddSymbol(Symbol *symbol) {
+    if (2 * (this->symbol_list_.size() + 1) > this->slot_list_.size()) {
+        this->Grow();
     }
+    this->slot_list_[this->Probe(symbol->id())] = symbol;
+    this->symbol_list_.push_back(symbol);
 }
 
-map<string, Symbol *> SymbolTable::symbol_map() {
-    return this->symbol_map_;
+Symbol *SymbolTable::FindSymbol(int id) const {
+    return this->slot_list_[this->Probe(id)];
+}
+
+const vector<Symbol *> &SymbolTable::symbol_list() const {
+    return this->symbol_list_;
 }
 
 
 // CheckTable
-CheckTable::CheckTable() {
-    auto map0 = new SymbolTable();
-    auto map1 = new SymbolTable();
-    this->symbol_table_vector_.push_back(map0);
-    this->symbol_table_vector_.push_back(map1);
+CheckTable::CheckTable(const Interner *interner, SymbolArena *symbol_arena) {
+    this->interner_ = interner;
+    this->symbol_arena_ = symbol_arena;
+    this->global_table_ = nullptr;
+    this->function_table_ = nullptr;
 }
 
-Symbol *CheckTable::AddSymbol(const string &name, KindSymbol kind, TypeSymbol type, int level) {
-    return this->symbol_table_vector_[level]->AddSymbol(name, kind, type);
+void CheckTable::Bind(Symbol *symbol) {
+    int id = symbol->id();
+    if ((size_t) id >= this->binding_list_.size()) {
+        this->binding_list_.resize(max((size_t) id + 1, 2 * this->binding_list_.size()), nullptr);
+    }
+    this->undo_log_.push_back({id, this->binding_list_[id]});
+    this->binding_list_[id] = symbol;
 }
 
-Symbol *CheckTable::FindSymbol(const string &name) {
-    Symbol *symbol;
-    symbol = this->symbol_table_vector_[1]->FindSymbol(name);
+// A name declared again in the same scope reuses its symbol.
+Symbol *CheckTable::AddSymbol(int id, KindSymbol kind, TypeSymbol type, int level) {
+    assert(level == 0 || level == this->level());
+    Symbol *symbol = this->FindSymbol(id, level);
     if (symbol == nullptr) {
-        symbol = this->symbol_table_vector_[0]->FindSymbol(name);
+        symbol = this->symbol_arena_->NewSymbol();
+        symbol->SetProperty(id, &interner_->Name(id), kind, type);
+        if (level == 0) {
+            this->global_table_->AddSymbol(symbol);
+        } else {
+            this->function_table_->AddSymbol(symbol);
+            this->Bind(symbol);
+        }
+    } else {
+        symbol->SetProperty(id, &interner_->Name(id), kind, type);
     }
+    symbol->set_level(level);
     return symbol;
 }
 
-Symbol *CheckTable::FindSymbol(const string &name, int level) {
-    return this->symbol_table_vector_[level]->FindSymbol(name);
+Symbol *CheckTable::FindSymbol(int id) {
+    if (id >= 0 && (size_t) id < this->binding_list_.size() && this->binding_list_[id] != nullptr) {
+        return this->binding_list_[id];
+    }
+    return this->global_table_->FindSymbol(id);
 }
 
-int CheckTable::GetSymbolLevel(const string &name) {
-    if (this->FindSymbol(name, 1) != nullptr) {
-        return 1;
-    } else {
-        return 0;
+Symbol *CheckTable::FindSymbol(int id, int level) {
+    if (level == 0) {
+        return this->global_table_->FindSymbol(id);
     }
+    if (id < 0 || (size_t) id >= this->binding_list_.size()) {
+        return nullptr;
+    }
+    Symbol *symbol = this->binding_list_[id];
+    return symbol != nullptr && symbol->level() == level ? symbol : nullptr;
 }
 
-void CheckTable::ClearLevel(int level) {
-    this->symbol_table_vector_[level] = new SymbolTable();
+Symbol *CheckTable::FindSymbol(const string &name) {
+    return this->FindSymbol(interner_->Find(name));
 }
 
-void CheckTable::SetTable(int level, SymbolTable *symbol_table) {
-    this->symbol_table_vector_[level] = symbol_table;
+Symbol *CheckTable::FindSymbol(const string &name, int level) {
+    return this->FindSymbol(interner_->Find(name), level);
 }
 
-SymbolTable *CheckTable::GetSymbolTable(int level) {
-    return this->symbol_table_vector_[level];
+int CheckTable::level() const {
+    return (int) this->scope_list_.size();
 }
 
-map<string, Symbol *> CheckTable::GetSymbolMap(int level) {
-    return this->GetSymbolTable(level)->symbol_map();
+void CheckTable::OpenScope() {
+    this->scope_list_.push_back(this->undo_log_.size());
+}
+
+void CheckTable::CloseScope() {
+    size_t mark = this->scope_list_.back();
+    this->scope_list_.pop_back();
+    while (this->undo_log_.size() > mark) {
+        this->binding_list_[this->undo_log_.back().id] = this->undo_log_.back().symbol;
+        this->undo_log_.pop_back();
+    }
+}
+
+void CheckTable::SetTable(int level, SymbolTable *symbol_table) {
+    if (level == 0) {
+        this->global_table_ = symbol_table;
+        return;
+    }
+    assert(level == 1);
+    while (!this->scope_list_.empty()) {
+        this->CloseScope();
+    }
+    this->function_table_ = symbol_table;
+    this->OpenScope();
+    for (Symbol *symbol : symbol_table->symbol_list()) {
+        this->Bind(symbol);
+    }
+}
+
+SymbolTable *CheckTable::GetSymbolTable(int level) {
+    return level == 0 ? this->global_table_ : this->function_table_;
 }
 
 void CheckTable::AddFunctionVariableNumber(const string &function_name, int number) {
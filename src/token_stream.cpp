@@ -0,0 +1,77 @@
+﻿#include "token_stream.h"
+
+#include <cassert>
+
+using namespace std;
+
+TokenStream::TokenStream(LexicalAnalyser *lexical_analyser) : end_lexeme_(TokenKind::END) {
+    lexical_analyser_ = lexical_analyser;
+    lexeme_list_ = nullptr;
+    index_ = 0;
+    end_index_ = 0;
+    fill_count_ = 0;
+    is_drained_ = false;
+}
+
+TokenStream::TokenStream(const vector<struct Lexeme> *lexeme_list, unsigned end_offset)
+        : end_lexeme_(TokenKind::END) {
+    lexical_analyser_ = nullptr;
+    lexeme_list_ = lexeme_list;
+    index_ = 0;
+    end_index_ = lexeme_list->size();
+    fill_count_ = lexeme_list->size();
+    is_drained_ = true;
+    end_lexeme_.offset = end_offset;
+}
+
+// Positions stay absolute, so Peek(-1) at begin still sees the token before the range.
+TokenStream::TokenStream(const vector<struct Lexeme> *lexeme_list, size_t begin, size_t end)
+        : end_lexeme_(TokenKind::END) {
+    assert(begin < end && end <= lexeme_list->size());
+    lexical_analyser_ = nullptr;
+    lexeme_list_ = lexeme_list;
+    index_ = begin;
+    end_index_ = end;
+    fill_count_ = end;
+    is_drained_ = true;
+    end_lexeme_.offset = (*lexeme_list)[end - 1].offset;
+}
+
+const Lexeme &TokenStream::Peek(int k) {
+    // pulling up to index_ + k overwrites slot index_ + k - TOKEN_RING_SIZE, which must stay behind -k
+    assert(k > -TOKEN_RING_SIZE / 2 && k < TOKEN_RING_SIZE / 2);
+
+    if (k < 0 && index_ < (size_t) -k) {
+        return end_lexeme_;
+    }
+    size_t position = index_ + k;
+    if (lexeme_list_ != nullptr) {
+        return position < end_index_ ? (*lexeme_list_)[position] : end_lexeme_;
+    }
+    while (fill_count_ <= position && !is_drained_) {
+        if (lexical_analyser_->Next(ring_[fill_count_ & (TOKEN_RING_SIZE - 1)])) {
+            fill_count_++;
+        } else {
+            is_drained_ = true;
+            end_lexeme_.offset = lexical_analyser_->offset();
+        }
+    }
+    return position < fill_count_ ? ring_[position & (TOKEN_RING_SIZE - 1)] : end_lexeme_;
+}
+
+void TokenStream::Advance() {
+    index_++;
+}
+
+size_t TokenStream::token_count() const {
+    return fill_count_;
+}
+
+size_t TokenStream::index() const {
+    return index_;
+}
+
+// nullptr when tokens are pulled from the lexer
+const vector<struct Lexeme> *TokenStream::lexeme_list() const {
+    return lexeme_list_;
+}
\ No newline at end of file
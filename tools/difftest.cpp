@@ -0,0 +1,343 @@
+﻿#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "compiler.h"
+#include "midcode_interpreter.h"
+#include "mips_simulator.h"
+#include "profiler.h"
+
+using namespace std;
+
+struct Execution {
+    bool is_ok;
+    string output;
+    long long step_count;
+    string error;
+};
+
+struct Result {
+    string name;
+    bool is_compile_error;
+    bool is_mismatch;
+    string detail;
+    vector<Execution> midcode_list;
+    vector<Execution> mips_list;
+};
+
+struct Option {
+    vector<int> optimize_level;
+    int job_count;
+    long long step_limit;
+    bool is_keep;
+    string work_dir;
+    string trace_file;
+};
+
+static bool IsDirectory(const string &path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+static bool IsFile(const string &path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+}
+
+static string ReadFile(const string &path) {
+    ifstream file(path);
+    stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+static string GetInputPath(const string &source) {
+    size_t dot = source.rfind('.');
+    size_t slash = source.rfind('/');
+    if (dot == string::npos || (slash != string::npos && dot < slash)) {
+        return source + ".in";
+    }
+    return source.substr(0, dot) + ".in";
+}
+
+static void CollectProgram(const string &path, vector<string> &program_list) {
+    if (!IsDirectory(path)) {
+        program_list.push_back(path);
+        return;
+    }
+
+    vector<string> name_list;
+    DIR *dir = opendir(path.c_str());
+    struct dirent *entry;
+    while (dir != nullptr && (entry = readdir(dir)) != nullptr) {
+        string name = entry->d_name;
+        if (name.compare(0, 8, "testfile") == 0 && name.size() > 4
+            && name.compare(name.size() - 4, 4, ".txt") == 0 && IsFile(path + "/" + name)) {
+            name_list.push_back(path + "/" + name);
+        }
+    }
+    if (dir != nullptr) {
+        closedir(dir);
+    }
+    sort(name_list.begin(), name_list.end());
+    program_list.insert(program_list.end(), name_list.begin(), name_list.end());
+}
+
+static string Describe(const Execution &execution) {
+    return execution.is_ok ? "ok" : "trap(" + execution.error + ")";
+}
+
+static string FirstDifference(const string &expect, const string &actual) {
+    size_t line = 1;
+    size_t i = 0;
+    while (i < expect.size() && i < actual.size() && expect[i] == actual[i]) {
+        if (expect[i] == '\n') {
+            line++;
+        }
+        i++;
+    }
+    return "output differs at line " + to_string(line);
+}
+
+static void Compare(const Option &option, Result &result) {
+    const Execution &reference = result.midcode_list[0];
+
+    for (size_t i = 0; i < option.optimize_level.size(); i++) {
+        const Execution *execution_list[] = {&result.midcode_list[i], &result.mips_list[i]};
+        const char *kind_list[] = {"midcode", "mips"};
+
+        for (int k = 0; k < 2; k++) {
+            const Execution &execution = *execution_list[k];
+            string where = string(kind_list[k]) + " -O" + to_string(option.optimize_level[i]);
+            if (execution.is_ok != reference.is_ok) {
+                result.is_mismatch = true;
+                result.detail += where + ": " + Describe(execution) + " vs " + Describe(reference) + "; ";
+            } else if (execution.output != reference.output) {
+                result.is_mismatch = true;
+                result.detail += where + ": " + FirstDifference(reference.output, execution.output) + "; ";
+            }
+        }
+    }
+}
+
+static void RunProgram(const Option &option, const string &source, int index, Result &result) {
+    string prefix = option.work_dir + "/" + to_string(index);
+    string midcode_file = option.is_keep ? prefix + "_midcode.txt" : "";
+    string error_file = prefix + "_error.txt";
+
+    result.name = source;
+    result.is_compile_error = false;
+    result.is_mismatch = false;
+
+    Compiler compiler(source, midcode_file, error_file);
+    if (!compiler.Open()) {
+        result.is_compile_error = true;
+        result.detail = "cannot open " + source;
+    } else if (!compiler.Analyze()) {
+        result.is_compile_error = true;
+        istringstream error(ReadFile(error_file));
+        getline(error, result.detail);
+    } else {
+        string input = ReadFile(GetInputPath(source));
+
+        for (int optimize_level : option.optimize_level) {
+            MidcodeInterpreter midcode_interpreter = MidcodeInterpreter(compiler.string_table(),
+                                                                        compiler.symbol_table_map(),
+                                                                        compiler.frame_layout_map(),
+                                                                        compiler.Optimize(optimize_level));
+            istringstream midcode_input(input);
+            ostringstream midcode_output;
+            midcode_interpreter.set_step_limit(option.step_limit);
+            Profiler::GetInstance()->Begin("run midcode");
+            bool is_ok = midcode_interpreter.Run(midcode_input, midcode_output);
+            Profiler::GetInstance()->End();
+            result.midcode_list.push_back({is_ok, midcode_output.str(),
+                                           midcode_interpreter.step_count(), midcode_interpreter.error()});
+
+            string mips_file = prefix + "_O" + to_string(optimize_level) + "_mips.txt";
+            compiler.GenerateMips(mips_file, optimize_level);
+
+            MipsSimulator mips_simulator;
+            ifstream mips(mips_file);
+            istringstream mips_input(input);
+            ostringstream mips_output;
+            mips_simulator.set_step_limit(option.step_limit);
+            Profiler::GetInstance()->Begin("run mips");
+            is_ok = mips_simulator.Load(mips) && mips_simulator.Run(mips_input, mips_output);
+            Profiler::GetInstance()->End();
+            result.mips_list.push_back({is_ok, mips_output.str(),
+                                        mips_simulator.step_count(), mips_simulator.error()});
+            if (!option.is_keep) {
+                remove(mips_file.c_str());
+            }
+        }
+        Compare(option, result);
+    }
+
+    if (!option.is_keep) {
+        remove(midcode_file.c_str());
+        remove(error_file.c_str());
+    }
+}
+
+static string JoinCount(const vector<Execution> &execution_list) {
+    string str;
+    for (const Execution &execution : execution_list) {
+        str += (str.empty() ? "" : "/") + to_string(execution.step_count);
+    }
+    return str;
+}
+
+static void PrintSpeedup(const Option &option, const vector<Result> &result_list, bool is_mips) {
+    for (size_t i = 1; i < option.optimize_level.size(); i++) {
+        double log_sum = 0;
+        int count = 0;
+        for (const Result &result : result_list) {
+            if (result.is_compile_error || result.is_mismatch) {
+                continue;
+            }
+            const vector<Execution> &list = is_mips ? result.mips_list : result.midcode_list;
+            if (list[0].step_count > 0 && list[i].step_count > 0) {
+                log_sum += log((double) list[0].step_count / list[i].step_count);
+                count++;
+            }
+        }
+        if (count > 0) {
+            cout << (is_mips ? "mips" : "midcode") << " speedup -O" << option.optimize_level[0]
+                 << " -> -O" << option.optimize_level[i] << ": "
+                 << fixed << setprecision(3) << exp(log_sum / count) << "x (geomean of " << count << ")" << endl;
+        }
+    }
+}
+
+static void PrintUsage() {
+    cerr << "usage: mips_difftest [-j jobs] [-O levels] [--step-limit n] [--keep] [--trace file] path..." << endl
+         << "  levels are digits 0-2, optionally comma-separated: -O 02 or -O 0,2 (default 012);" << endl
+         << "  path is a Persuade C source or a directory of testfile*.txt sources;" << endl
+         << "  stdin for a source is read from the file with the same stem and a .in suffix." << endl;
+}
+
+int main(int argc, char *argv[]) {
+    Option option;
+    option.optimize_level = {0, 1, 2};
+    option.job_count = thread::hardware_concurrency() > 0 ? thread::hardware_concurrency() : 1;
+    option.step_limit = 100000000;
+    option.is_keep = false;
+
+    vector<string> program_list;
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        if (argument == "-j" && i + 1 < argc) {
+            option.job_count = max(1, atoi(argv[++i]));
+        } else if (argument == "-O" && i + 1 < argc) {
+            option.optimize_level.clear();
+            for (char c : string(argv[++i])) {
+                if (c >= '0' && c <= '2') {
+                    option.optimize_level.push_back(c - '0');
+                } else if (c != ',') {
+                    PrintUsage();
+                    return 2;
+                }
+            }
+        } else if (argument == "--step-limit" && i + 1 < argc) {
+            option.step_limit = atoll(argv[++i]);
+        } else if (argument == "--keep") {
+            option.is_keep = true;
+        } else if (argument == "--trace" && i + 1 < argc) {
+            option.trace_file = argv[++i];
+        } else if (argument[0] == '-') {
+            PrintUsage();
+            return 2;
+        } else {
+            CollectProgram(argument, program_list);
+        }
+    }
+    if (program_list.empty() || option.optimize_level.empty()) {
+        PrintUsage();
+        return 2;
+    }
+
+    const char *tmp = getenv("TMPDIR");
+    string pattern = string(tmp != nullptr ? tmp : "/tmp") + "/mips_difftest.XXXXXX";
+    vector<char> work_dir(pattern.begin(), pattern.end());
+    work_dir.push_back('\0');
+    if (mkdtemp(work_dir.data()) == nullptr) {
+        cerr << "mips_difftest: cannot create work directory " << pattern << endl;
+        return 2;
+    }
+    option.work_dir = work_dir.data();
+
+    vector<Result> result_list(program_list.size());
+    atomic<size_t> next(0);
+    vector<thread> worker_list;
+    for (int i = 0; i < option.job_count; i++) {
+        worker_list.emplace_back([&]() {
+            Profiler *profiler = Profiler::GetInstance();
+            if (!option.trace_file.empty()) {
+                profiler->Enable();
+            }
+            size_t index;
+            while ((index = next++) < program_list.size()) {
+                profiler->Begin("program", program_list[index]);
+                RunProgram(option, program_list[index], index, result_list[index]);
+                profiler->End();
+            }
+            profiler->Flush();
+        });
+    }
+    for (thread &worker : worker_list) {
+        worker.join();
+    }
+    if (!option.is_keep) {
+        rmdir(option.work_dir.c_str());
+    }
+    if (!option.trace_file.empty() && !Profiler::WriteTrace(option.trace_file)) {
+        cerr << "mips_difftest: cannot write " << option.trace_file << endl;
+    }
+
+    int ok_count = 0;
+    int mismatch_count = 0;
+    int error_count = 0;
+    for (const Result &result : result_list) {
+        cout << result.name << "\t";
+        if (result.is_compile_error) {
+            error_count++;
+            cout << "compile-error\t" << result.detail << endl;
+            continue;
+        }
+        if (result.is_mismatch) {
+            mismatch_count++;
+            cout << "MISMATCH";
+        } else {
+            ok_count++;
+            cout << (result.midcode_list[0].is_ok ? "ok" : "ok-trap");
+        }
+        cout << "\tmidcode " << JoinCount(result.midcode_list)
+             << "\tmips " << JoinCount(result.mips_list);
+        if (result.is_mismatch) {
+            cout << "\t" << result.detail;
+        }
+        cout << endl;
+    }
+
+    cout << endl << result_list.size() << " programs: " << ok_count << " ok, "
+         << mismatch_count << " mismatch, " << error_count << " compile error" << endl;
+    PrintSpeedup(option, result_list, false);
+    PrintSpeedup(option, result_list, true);
+    if (option.is_keep) {
+        cout << "work files kept in " << option.work_dir << endl;
+    }
+
+    return mismatch_count > 0 || error_count > 0 ? 1 : 0;
+}
\ No newline at end of file
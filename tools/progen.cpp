@@ -0,0 +1,898 @@
+﻿#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+using namespace std;
+
+// The generated MIPS keeps return addresses and pushed parameters in two 125-word areas and gives
+// every call frame 2000 bytes, so programs stay well inside those limits.
+#define RA_LIMIT                100
+#define PARA_LIMIT              100
+#define FRAME_LIMIT             400
+// Every int variable, parameter, array element and return value stays within +-VALUE_LIMIT;
+// every intermediate result stays within +-BOUND_LIMIT, so no add/sub can overflow (and trap).
+#define VALUE_LIMIT             1000
+#define BOUND_LIMIT             (1LL << 30)
+// Estimated dynamic midcode count of one function body, and of the whole program.
+#define FUNCTION_COST_LIMIT     20000
+#define MAIN_COST_LIMIT         2000000
+
+struct Option {
+    long long seed;
+    int count;
+    string out_dir;
+    int function_count;
+    int statement_count;
+    int depth;
+    int expression_size;
+    int array_count;
+    int recursion_depth;
+    int loop_count;
+};
+
+class Random {
+private:
+    uint64_t state_;
+
+public:
+    explicit Random(uint64_t seed) {
+        state_ = seed;
+    }
+
+    // splitmix64: the same seed gives the same program on every platform
+    uint64_t NextRaw() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    int Next(int n) {
+        return n <= 1 ? 0 : (int) (NextRaw() % (uint64_t) n);
+    }
+
+    int Range(int low, int high) {
+        return low + Next(high - low + 1);
+    }
+
+    bool Chance(int percent) {
+        return Next(100) < percent;
+    }
+};
+
+enum class ReturnType {
+    VOID, INT, CHAR
+};
+
+struct Variable {
+    string name;
+    bool is_char;
+    int length;         // 0 for scalars
+    bool is_const;
+    int value;          // const value
+    bool is_writable;
+};
+
+struct Function {
+    string name;
+    ReturnType type;
+    vector<bool> parameter;     // true: char parameter
+    int depth_limit;            // > 0: recursive, the first parameter is the remaining depth
+    long long cost;
+    int ra_depth;
+    int para_depth;
+};
+
+struct Expression {
+    string text;
+    long long bound;
+    bool is_char;
+    int temp_count;
+    long long cost;
+    int ra_need;
+    int para_need;
+};
+
+struct Loop {
+    string counter;
+    int max_value;
+};
+
+class ProgramGenerator {
+private:
+    Option option_;
+    Random random_;
+
+    vector<Function> function_list_;
+    vector<Variable> variable_list_;
+    size_t global_count_;
+    int current_;
+    bool is_main_;
+
+    long long multiplier_;
+    long long cost_;
+    long long cost_limit_;
+    int temp_count_;
+    int ra_need_;
+    int para_need_;
+    vector<Loop> loop_list_;
+    vector<string> input_list_;
+    string global_init_;
+
+    static const int NORM = 0;
+    static const int NZ = 1;
+    static const int IX = 2;
+    static const int HELPER_COUNT = 3;
+
+    static string Indent(int indent) {
+        return string(4 * indent, ' ');
+    }
+
+    static Expression Constant(const string &text, long long bound, bool is_char) {
+        return {text, bound, is_char, 0, 1, 0, 0};
+    }
+
+    string CharLiteral() {
+        const string alphabet = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_+-*/";
+        return "'" + string(1, alphabet[random_.Next((int) alphabet.size())]) + "'";
+    }
+
+    string StringLiteral() {
+        const string alphabet = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789=:,.!?-+*/()[]<>";
+        string str;
+        int length = random_.Range(1, 12);
+        for (int i = 0; i < length; i++) {
+            str.push_back(alphabet[random_.Next((int) alphabet.size())]);
+        }
+        return "\"" + str + "\"";
+    }
+
+    vector<const Variable *> FindVariable(bool is_char, bool is_array, bool is_writable) const {
+        vector<const Variable *> candidate_list;
+        for (const Variable &variable : variable_list_) {
+            if (variable.is_char == is_char && (variable.length > 0) == is_array
+                && (!is_writable || variable.is_writable)) {
+                candidate_list.push_back(&variable);
+            }
+        }
+        return candidate_list;
+    }
+
+    vector<int> FindFunction(ReturnType type, bool is_any_value) const {
+        vector<int> candidate_list;
+        for (int i = HELPER_COUNT; i < current_; i++) {
+            if (is_any_value ? function_list_[i].type != ReturnType::VOID : function_list_[i].type == type) {
+                candidate_list.push_back(i);
+            }
+        }
+        return candidate_list;
+    }
+
+    bool IsAffordable(const Expression &expression) const {
+        return expression.ra_need <= RA_LIMIT && expression.para_need <= PARA_LIMIT
+               && cost_ + multiplier_ * expression.cost <= cost_limit_
+               && temp_count_ + expression.temp_count <= FRAME_LIMIT + 50;
+    }
+
+    void Commit(const Expression &expression) {
+        temp_count_ += expression.temp_count;
+        cost_ += multiplier_ * expression.cost;
+        ra_need_ = max(ra_need_, expression.ra_need);
+        para_need_ = max(para_need_, expression.para_need);
+    }
+
+    Expression Call(int index, const vector<Expression> &argument_list) const {
+        const Function &function = function_list_[index];
+        Expression call = {function.name + "(", VALUE_LIMIT, function.type == ReturnType::CHAR, 1,
+                           function.cost + 5 + (long long) argument_list.size(),
+                           function.ra_depth, function.para_depth};
+        for (size_t i = 0; i < argument_list.size(); i++) {
+            const Expression &argument = argument_list[i];
+            call.text += (i == 0 ? "" : ", ") + argument.text;
+            call.temp_count += argument.temp_count;
+            call.cost += argument.cost;
+            call.ra_need = max(call.ra_need, 1 + argument.ra_need);
+            call.para_need = max(call.para_need, (int) i + argument.para_need);
+        }
+        call.text += ")";
+        if (call.is_char) {
+            call.bound = 127;
+        }
+        return call;
+    }
+
+    Expression Normalize(const Expression &expression) const {
+        if (expression.is_char || expression.bound <= VALUE_LIMIT) {
+            return ToInt(expression);
+        }
+        Expression call = Call(NORM, {expression});
+        call.bound = VALUE_LIMIT - 1;
+        return call;
+    }
+
+    Expression ToInt(const Expression &expression) const {
+        if (!expression.is_char) {
+            return expression;
+        }
+        Expression result = expression;
+        result.text += " + 0";
+        result.is_char = false;
+        result.temp_count++;
+        result.cost++;
+        return result;
+    }
+
+    Expression GenerateCall(int index, int size) {
+        const Function &function = function_list_[index];
+        vector<Expression> argument_list;
+        for (size_t i = 0; i < function.parameter.size(); i++) {
+            if (i == 0 && function.depth_limit > 0) {
+                argument_list.push_back(Constant(to_string(random_.Range(0, function.depth_limit)), 0, false));
+            } else if (function.parameter[i]) {
+                argument_list.push_back(GenerateCharExpression(max(1, size / 2)));
+            } else {
+                argument_list.push_back(Normalize(GenerateIntExpression(max(1, size / 2))));
+            }
+        }
+        return Call(index, argument_list);
+    }
+
+    Expression GenerateIndex(int length) {
+        if (random_.Chance(40)) {
+            return Constant(to_string(random_.Next(length)), length - 1, false);
+        }
+        for (auto iter = loop_list_.rbegin(); iter != loop_list_.rend(); iter++) {
+            if (iter->max_value < length && random_.Chance(70)) {
+                return Constant(iter->counter, iter->max_value, false);
+            }
+        }
+        Expression call = Call(IX, {GenerateIntExpression(2), Constant(to_string(length), length, false)});
+        call.bound = length - 1;
+        if (!IsAffordable(call)) {
+            return Constant("0", 0, false);
+        }
+        return call;
+    }
+
+    Expression GenerateVariable(bool is_char) {
+        if (!is_char && !loop_list_.empty() && random_.Chance(20)) {
+            const Loop &loop = loop_list_[random_.Next((int) loop_list_.size())];
+            return Constant(loop.counter, loop.max_value, false);
+        }
+        vector<const Variable *> candidate_list = FindVariable(is_char, false, false);
+        if (candidate_list.empty()) {
+            return is_char ? Constant(CharLiteral(), 127, true) : Constant(to_string(random_.Next(100)), 99, false);
+        }
+        const Variable *variable = candidate_list[random_.Next((int) candidate_list.size())];
+        long long bound = is_char ? 127 : variable->is_const ? abs(variable->value) : VALUE_LIMIT;
+        return Constant(variable->name, bound, is_char);
+    }
+
+    Expression GenerateFactor(int size) {
+        int choice = random_.Next(100);
+
+        if (size > 1 && choice < 12) {
+            Expression inner = GenerateExpression(size - 1);
+            inner.text = "(" + inner.text + ")";
+            return inner;
+        }
+        if (size > 1 && choice < 30) {
+            vector<int> candidate_list = FindFunction(ReturnType::VOID, true);
+            if (!candidate_list.empty()) {
+                Expression call = GenerateCall(candidate_list[random_.Next((int) candidate_list.size())], size - 1);
+                if (IsAffordable(call)) {
+                    return call;
+                }
+            }
+        }
+        if (choice < 45) {
+            vector<const Variable *> candidate_list = FindVariable(false, true, false);
+            if (!candidate_list.empty()) {
+                const Variable *array = candidate_list[random_.Next((int) candidate_list.size())];
+                Expression index = GenerateIndex(array->length);
+                return {array->name + "[" + index.text + "]", VALUE_LIMIT, false, index.temp_count + 1,
+                        index.cost + 1, index.ra_need, index.para_need};
+            }
+        }
+        if (choice < 75) {
+            return GenerateVariable(random_.Chance(15));
+        }
+        if (random_.Chance(10)) {
+            return Constant(CharLiteral(), 127, true);
+        }
+        int value = random_.Chance(80) ? random_.Next(100) : random_.Next(VALUE_LIMIT + 1);
+        return Constant(to_string(value), value, false);
+    }
+
+    Expression GenerateItem(int size) {
+        int factor_count = 1 + random_.Next(min(size, 3));
+        int share = max(1, size / factor_count);
+        Expression item = GenerateFactor(share);
+
+        for (int i = 1; i < factor_count; i++) {
+            Expression factor;
+            string op;
+            if (random_.Chance(40)) {
+                op = "/";
+                if (random_.Chance(70)) {
+                    int value = random_.Range(1, 9);
+                    factor = Constant(random_.Chance(20) ? "-" + to_string(value) : to_string(value), value, false);
+                } else {
+                    factor = Call(NZ, {GenerateIntExpression(share)});
+                    if (!IsAffordable(factor)) {
+                        factor = Constant("7", 7, false);
+                    }
+                }
+            } else {
+                op = "*";
+                factor = GenerateFactor(share);
+                if (item.bound * factor.bound > BOUND_LIMIT) {
+                    int value = random_.Range(1, 9);
+                    factor = Constant(to_string(value), value, false);
+                    op = item.bound * value > BOUND_LIMIT ? "/" : "*";
+                }
+                if (op == "*") {
+                    item.bound *= max(1LL, factor.bound);
+                }
+            }
+            item.text += " " + op + " " + factor.text;
+            item.is_char = false;
+            item.temp_count += factor.temp_count + 1;
+            item.cost += factor.cost + 1;
+            item.ra_need = max(item.ra_need, factor.ra_need);
+            item.para_need = max(item.para_need, factor.para_need);
+        }
+        return item;
+    }
+
+    Expression GenerateExpression(int size) {
+        int item_count = 1 + random_.Next(min(size, 3));
+        int share = max(1, size / item_count);
+        Expression expression = GenerateItem(share);
+
+        if (!expression.is_char || item_count > 1) {
+            int choice = random_.Next(100);
+            if (choice < 20) {
+                expression.text = "-" + expression.text;
+                expression.temp_count++;
+                expression.cost++;
+            } else if (choice < 25) {
+                expression.text = "+" + expression.text;
+            }
+        }
+
+        for (int i = 1; i < item_count; i++) {
+            Expression item = GenerateItem(share);
+            if (expression.bound + item.bound > BOUND_LIMIT) {
+                item = Normalize(item);
+            }
+            if (expression.bound + item.bound > BOUND_LIMIT) {
+                expression = Normalize(expression);
+            }
+            expression.text += (random_.Chance(50) ? " + " : " - ") + item.text;
+            expression.bound += item.bound;
+            expression.is_char = false;
+            expression.temp_count += item.temp_count + 1;
+            expression.cost += item.cost + 1;
+            expression.ra_need = max(expression.ra_need, item.ra_need);
+            expression.para_need = max(expression.para_need, item.para_need);
+        }
+        return expression;
+    }
+
+    Expression GenerateIntExpression(int size) {
+        return ToInt(GenerateExpression(random_.Range(1, size)));
+    }
+
+    Expression GenerateCharExpression(int size) {
+        int choice = random_.Next(100);
+        if (size > 1 && choice < 20) {
+            vector<int> candidate_list = FindFunction(ReturnType::CHAR, false);
+            if (!candidate_list.empty()) {
+                Expression call = GenerateCall(candidate_list[random_.Next((int) candidate_list.size())], size - 1);
+                if (IsAffordable(call)) {
+                    return call;
+                }
+            }
+        }
+        if (choice < 30) {
+            Expression inner = GenerateCharExpression(1);
+            inner.text = "(" + inner.text + ")";
+            return inner;
+        }
+        if (choice < 65) {
+            return GenerateVariable(true);
+        }
+        return Constant(CharLiteral(), 127, true);
+    }
+
+    string GenerateCondition() {
+        Expression left = GenerateIntExpression(option_.expression_size);
+        Commit(left);
+        if (random_.Chance(25)) {
+            return left.text;
+        }
+        const char *op_list[] = {"<", "<=", ">", ">=", "==", "!="};
+        Expression right = GenerateIntExpression(option_.expression_size);
+        Commit(right);
+        return left.text + " " + op_list[random_.Next(6)] + " " + right.text;
+    }
+
+    string GenerateAssign(int indent) {
+        bool is_char = random_.Chance(20);
+        vector<const Variable *> candidate_list = FindVariable(is_char, false, true);
+        if (candidate_list.empty()) {
+            is_char = !is_char;
+            candidate_list = FindVariable(is_char, false, true);
+        }
+        if (candidate_list.empty()) {
+            return Indent(indent) + ";\n";
+        }
+        const Variable *variable = candidate_list[random_.Next((int) candidate_list.size())];
+        Expression value = is_char ? GenerateCharExpression(option_.expression_size)
+                                   : Normalize(GenerateIntExpression(option_.expression_size));
+        Commit(value);
+        return Indent(indent) + variable->name + " = " + value.text + ";\n";
+    }
+
+    string GenerateArrayAssign(int indent) {
+        vector<const Variable *> candidate_list = FindVariable(false, true, true);
+        if (candidate_list.empty()) {
+            return GenerateAssign(indent);
+        }
+        const Variable *array = candidate_list[random_.Next((int) candidate_list.size())];
+        Expression index = GenerateIndex(array->length);
+        Commit(index);
+        Expression value = Normalize(GenerateIntExpression(option_.expression_size));
+        Commit(value);
+        return Indent(indent) + array->name + "[" + index.text + "] = " + value.text + ";\n";
+    }
+
+    string GenerateIf(int depth, int indent) {
+        string str = Indent(indent) + "if (" + GenerateCondition() + ")\n";
+        str += GenerateStatement(depth + 1, indent + 1);
+        if (random_.Chance(50)) {
+            str += Indent(indent) + "else\n" + GenerateStatement(depth + 1, indent + 1);
+        }
+        return str;
+    }
+
+    string GenerateBlockBody(int depth, int indent) {
+        string str;
+        int count = random_.Range(1, 3);
+        for (int i = 0; i < count; i++) {
+            str += GenerateStatement(depth + 1, indent);
+        }
+        return str;
+    }
+
+    string GenerateLoop(int depth, int indent) {
+        int trip_count = random_.Range(1, option_.loop_count);
+        string counter = "k" + to_string(loop_list_.size());
+        string trip = to_string(trip_count);
+        int kind = random_.Next(3);
+        long long outer_multiplier = multiplier_;
+        string str;
+
+        multiplier_ *= trip_count;
+        cost_ += multiplier_ * 4;
+        temp_count_ += 2;
+        if (kind == 0) {
+            loop_list_.push_back({counter, trip_count - 1});
+            str = Indent(indent) + "for (" + counter + " = 0; " + counter + " < " + trip + "; "
+                  + counter + " = " + counter + " + 1)\n" + GenerateStatement(depth + 1, indent + 1);
+        } else if (kind == 1) {
+            loop_list_.push_back({counter, trip_count});
+            str = Indent(indent) + "{\n"
+                  + Indent(indent + 1) + counter + " = " + trip + ";\n"
+                  + Indent(indent + 1) + "while (" + counter + " > 0) {\n"
+                  + GenerateBlockBody(depth + 1, indent + 2)
+                  + Indent(indent + 2) + counter + " = " + counter + " - 1;\n"
+                  + Indent(indent + 1) + "}\n"
+                  + Indent(indent) + "}\n";
+        } else {
+            loop_list_.push_back({counter, trip_count - 1});
+            str = Indent(indent) + "{\n"
+                  + Indent(indent + 1) + counter + " = 0;\n"
+                  + Indent(indent + 1) + "do {\n"
+                  + GenerateBlockBody(depth + 1, indent + 2)
+                  + Indent(indent + 2) + counter + " = " + counter + " + 1;\n"
+                  + Indent(indent + 1) + "} while (" + counter + " < " + trip + ")\n"
+                  + Indent(indent) + "}\n";
+        }
+        loop_list_.pop_back();
+        multiplier_ = outer_multiplier;
+        return str;
+    }
+
+    string GenerateCallSentence(int indent) {
+        vector<int> candidate_list = FindFunction(ReturnType::VOID, false);
+        if (candidate_list.empty() || random_.Chance(30)) {
+            candidate_list = FindFunction(ReturnType::VOID, true);
+        }
+        if (candidate_list.empty()) {
+            return GeneratePrintf(indent);
+        }
+        Expression call = GenerateCall(candidate_list[random_.Next((int) candidate_list.size())],
+                                       option_.expression_size);
+        if (!IsAffordable(call)) {
+            return GeneratePrintf(indent);
+        }
+        Commit(call);
+        return Indent(indent) + call.text + ";\n";
+    }
+
+    string GeneratePrintf(int indent) {
+        int choice = random_.Next(3);
+        if (choice == 0) {
+            return Indent(indent) + "printf(" + StringLiteral() + ");\n";
+        }
+        Expression value = random_.Chance(20) ? GenerateCharExpression(option_.expression_size)
+                                              : GenerateIntExpression(option_.expression_size);
+        Commit(value);
+        if (choice == 1) {
+            return Indent(indent) + "printf(" + StringLiteral() + ", " + value.text + ");\n";
+        }
+        return Indent(indent) + "printf(" + value.text + ");\n";
+    }
+
+    string GenerateReturn(int indent) {
+        const Function &function = function_list_[current_];
+        if (function.type == ReturnType::VOID) {
+            return Indent(indent) + "return;\n";
+        }
+        Expression value = function.type == ReturnType::CHAR ? GenerateCharExpression(option_.expression_size)
+                                                             : Normalize(GenerateIntExpression(
+                        option_.expression_size));
+        Commit(value);
+        return Indent(indent) + "return (" + value.text + ");\n";
+    }
+
+    string GenerateScanf(int indent) {
+        vector<const Variable *> candidate_list;
+        for (const Variable &variable : variable_list_) {
+            if (variable.length == 0 && variable.is_writable) {
+                candidate_list.push_back(&variable);
+            }
+        }
+        if (candidate_list.empty()) {
+            return GeneratePrintf(indent);
+        }
+
+        string str = Indent(indent) + "scanf(";
+        int count = random_.Range(1, 3);
+        for (int i = 0; i < count; i++) {
+            const Variable *variable = candidate_list[random_.Next((int) candidate_list.size())];
+            str += (i == 0 ? "" : ", ") + variable->name;
+            input_list_.push_back(variable->is_char ? CharLiteral().substr(1, 1)
+                                                    : to_string(random_.Range(-VALUE_LIMIT + 1,
+                                                                              VALUE_LIMIT - 1)));
+        }
+        return str + ");\n";
+    }
+
+    string GenerateStatement(int depth, int indent) {
+        if (temp_count_ > FRAME_LIMIT || cost_ > cost_limit_) {
+            return Indent(indent) + ";\n";
+        }
+
+        bool is_nestable = depth < option_.depth;
+        int choice = random_.Next(100);
+        if (choice < 28) {
+            return GenerateAssign(indent);
+        } else if (choice < 38) {
+            return GenerateArrayAssign(indent);
+        } else if (choice < 50 && is_nestable) {
+            return GenerateIf(depth, indent);
+        } else if (choice < 62 && is_nestable && (int) loop_list_.size() < option_.depth) {
+            return GenerateLoop(depth, indent);
+        } else if (choice < 67 && is_nestable) {
+            return Indent(indent) + "{\n" + GenerateBlockBody(depth, indent + 1) + Indent(indent) + "}\n";
+        } else if (choice < 77) {
+            return GenerateCallSentence(indent);
+        } else if (choice < 92) {
+            return GeneratePrintf(indent);
+        } else if (choice < 95 && depth > 0 && !is_main_) {
+            return GenerateReturn(indent);
+        } else if (choice < 98 && depth == 0 && is_main_) {
+            return GenerateScanf(indent);
+        }
+        return Indent(indent) + ";\n";
+    }
+
+    string DeclareConst(int indent, bool is_global) {
+        string str;
+        int int_count = random_.Next(3);
+        int char_count = random_.Next(2);
+        string prefix = is_global ? "G" : "L";
+
+        for (int i = 0; i < int_count; i++) {
+            int value = random_.Range(-VALUE_LIMIT, VALUE_LIMIT);
+            Variable variable = {prefix + "C" + to_string(i), false, 0, true, value, false};
+            str += Indent(indent) + "const int " + variable.name + " = " + to_string(value) + ";\n";
+            variable_list_.push_back(variable);
+        }
+        for (int i = 0; i < char_count; i++) {
+            Variable variable = {prefix + "CC" + to_string(i), true, 0, true, 0, false};
+            str += Indent(indent) + "const char " + variable.name + " = " + CharLiteral() + ";\n";
+            variable_list_.push_back(variable);
+        }
+        return str;
+    }
+
+    // Declares variables and appends their initialization to init; returns the declaration.
+    string DeclareVariable(int indent, const string &prefix, int counter_count, string &init) {
+        string int_declare;
+        string char_declare;
+        int int_count = random_.Range(1, 4);
+        int char_count = random_.Next(3);
+        int array_count = option_.array_count > 0 ? random_.Range(0, option_.array_count) : 0;
+
+        for (int i = 0; i < int_count; i++) {
+            Variable variable = {prefix + "v" + to_string(i), false, 0, false, 0, true};
+            int_declare += (int_declare.empty() ? "" : ", ") + variable.name;
+            init += Indent(1) + variable.name + " = " + to_string(random_.Range(-99, 99)) + ";\n";
+            variable_list_.push_back(variable);
+            temp_count_++;
+        }
+        for (int i = 0; i < array_count; i++) {
+            Variable variable = {prefix + "a" + to_string(i), false, random_.Range(1, 16), false, 0, true};
+            int_declare += ", " + variable.name + "[" + to_string(variable.length) + "]";
+            init += Indent(1) + "for (k0 = 0; k0 < " + to_string(variable.length) + "; k0 = k0 + 1)\n"
+                    + Indent(2) + variable.name + "[k0] = k0 * " + to_string(random_.Range(1, 9))
+                    + " - " + to_string(random_.Next(10)) + ";\n";
+            variable_list_.push_back(variable);
+            temp_count_ += variable.length + 4;
+        }
+        for (int i = 0; i < counter_count; i++) {
+            // counters are read through loop_list_ only while their loop is running
+            int_declare += ", k" + to_string(i);
+            temp_count_++;
+        }
+        for (int i = 0; i < char_count; i++) {
+            Variable variable = {prefix + "c" + to_string(i), true, 0, false, 0, true};
+            char_declare += (char_declare.empty() ? "" : ", ") + variable.name;
+            init += Indent(1) + variable.name + " = " + CharLiteral() + ";\n";
+            variable_list_.push_back(variable);
+            temp_count_++;
+        }
+
+        string str = Indent(indent) + "int " + int_declare + ";\n";
+        if (!char_declare.empty()) {
+            str += Indent(indent) + "char " + char_declare + ";\n";
+        }
+        return str;
+    }
+
+    void ResetFunction(int index, long long cost_limit) {
+        variable_list_.resize(global_count_);
+        current_ = index;
+        is_main_ = index == (int) function_list_.size();
+        multiplier_ = 1;
+        cost_ = 0;
+        cost_limit_ = cost_limit;
+        temp_count_ = 0;
+        ra_need_ = 0;
+        para_need_ = 0;
+        loop_list_.clear();
+    }
+
+    string GenerateFunction(int index) {
+        Function function;
+        function.name = "f" + to_string(index - HELPER_COUNT);
+        int choice = random_.Next(100);
+        function.type = choice < 30 ? ReturnType::VOID : choice < 80 ? ReturnType::INT : ReturnType::CHAR;
+        function.depth_limit = 0;
+        if (option_.recursion_depth > 0 && function.type == ReturnType::INT && random_.Chance(30)) {
+            function.depth_limit = random_.Range(1, option_.recursion_depth);
+            function.parameter.push_back(false);
+        }
+        int parameter_count = random_.Next(4);
+        for (int i = 0; i < parameter_count; i++) {
+            function.parameter.push_back(function.depth_limit == 0 && random_.Chance(25));
+        }
+
+        function.cost = 0;
+        function.ra_depth = 0;
+        function.para_depth = 0;
+        function_list_.push_back(function);
+
+        ResetFunction(index, FUNCTION_COST_LIMIT);
+        const char *type_list[] = {"void", "int", "char"};
+        string str = string(type_list[(int) function.type]) + " " + function.name + "(";
+        for (size_t i = 0; i < function.parameter.size(); i++) {
+            bool is_depth = i == 0 && function.depth_limit > 0;
+            Variable variable = {is_depth ? "d" : "p" + to_string(i), function.parameter[i], 0, false, 0,
+                                 !is_depth};
+            str += string(i == 0 ? "" : ", ") + (variable.is_char ? "char " : "int ") + variable.name;
+            variable_list_.push_back(variable);
+            temp_count_++;
+        }
+        str += ") {\n" + DeclareConst(1, false);
+
+        string init;
+        str += DeclareVariable(1, "", max(1, option_.depth), init) + "\n" + init;
+        string recursive_call;
+        if (function.depth_limit > 0) {
+            Expression stop = Normalize(GenerateIntExpression(2));
+            Commit(stop);
+            str += Indent(1) + "if (d <= 0)\n" + Indent(2) + "return (" + stop.text + ");\n";
+            recursive_call = Indent(1) + "v0 = " + function.name + "(d - 1";
+            for (size_t i = 1; i < function.parameter.size(); i++) {
+                recursive_call += ", " + variable_list_[global_count_ + i].name;
+            }
+            recursive_call += ");\n";
+            temp_count_ += 2;
+        }
+
+        vector<string> statement_list;
+        for (int i = 0; i < option_.statement_count; i++) {
+            statement_list.push_back(GenerateStatement(0, 1));
+        }
+        if (!recursive_call.empty()) {
+            statement_list.insert(statement_list.begin() + random_.Next((int) statement_list.size() + 1),
+                                  recursive_call);
+        }
+        for (const string &statement : statement_list) {
+            str += statement;
+        }
+        if (function.type != ReturnType::VOID) {
+            str += GenerateReturn(1);
+        }
+        str += "}\n\n";
+
+        long long parameter_words = (long long) function.parameter.size();
+        if (function.depth_limit > 0) {
+            long long level = function.depth_limit + 1;
+            function.cost = level * (cost_ + 10);
+            function.ra_depth = (int) level + ra_need_;
+            function.para_depth = (int) (level * parameter_words) + para_need_;
+        } else {
+            function.cost = cost_ + 5;
+            function.ra_depth = 1 + ra_need_;
+            function.para_depth = (int) parameter_words + para_need_;
+        }
+        function_list_[index] = function;
+        return str;
+    }
+
+    string GenerateMain() {
+        ResetFunction((int) function_list_.size(), MAIN_COST_LIMIT);
+        string init = global_init_;
+        string str = "void main() {\n" + DeclareConst(1, false);
+        str += DeclareVariable(1, "", max(1, option_.depth), init) + "\n" + init;
+        for (int i = 0; i < option_.statement_count * 2; i++) {
+            str += GenerateStatement(0, 1);
+        }
+        for (size_t i = 0; i < global_count_; i++) {
+            const Variable &variable = variable_list_[i];
+            if (!variable.is_const && variable.length == 0) {
+                str += Indent(1) + "printf(\"" + variable.name + " = \", " + variable.name + ");\n";
+            }
+        }
+        return str + "}\n";
+    }
+
+    string GenerateHelper() {
+        function_list_.push_back({"norm", ReturnType::INT, {false}, 0, 6, 1, 1});
+        function_list_.push_back({"nz", ReturnType::INT, {false}, 0, 6, 1, 1});
+        function_list_.push_back({"ix", ReturnType::INT, {false, false}, 0, 8, 1, 2});
+        return "int norm(int x) {\n"
+               "    return (x - x / " + to_string(VALUE_LIMIT) + " * " + to_string(VALUE_LIMIT) + ");\n"
+               "}\n\n"
+               "int nz(int x) {\n"
+               "    if (x == 0)\n"
+               "        return (1);\n"
+               "    return (x);\n"
+               "}\n\n"
+               "int ix(int x, int n) {\n"
+               "    if (x < 0)\n"
+               "        x = -x;\n"
+               "    return (x - x / n * n);\n"
+               "}\n\n";
+    }
+
+public:
+    ProgramGenerator(const Option &option, long long seed) : option_(option), random_((uint64_t) seed) {
+        global_count_ = 0;
+        current_ = 0;
+        is_main_ = false;
+    }
+
+    string Generate() {
+        string str = DeclareConst(0, true);
+        temp_count_ = 0;
+        str += DeclareVariable(0, "g", 0, global_init_) + "\n";
+        // global arrays are initialized by main, which declares k0
+        global_count_ = variable_list_.size();
+
+        str += GenerateHelper();
+        for (int i = 0; i < option_.function_count; i++) {
+            str += GenerateFunction(HELPER_COUNT + i);
+        }
+        return str + GenerateMain();
+    }
+
+    string input() const {
+        string str;
+        for (const string &value : input_list_) {
+            str += value + "\n";
+        }
+        return str;
+    }
+};
+
+static void PrintUsage() {
+    cerr << "usage: mips_progen [options]" << endl
+         << "  --seed n          seed of the first program (default 1)" << endl
+         << "  --count n         number of programs, seeded seed..seed+n-1 (default 1)" << endl
+         << "  --out dir         output directory for testfile_<seed>.txt/.in (default .)" << endl
+         << "  --functions n     functions besides main (default 6)" << endl
+         << "  --statements n    top-level statements per function (default 8)" << endl
+         << "  --depth n         maximum statement nesting depth (default 3)" << endl
+         << "  --expression n    maximum factors per expression (default 6)" << endl
+         << "  --arrays n        maximum arrays per scope, 0 disables arrays (default 2)" << endl
+         << "  --recursion n     maximum recursion depth, 0 disables recursion (default 8)" << endl
+         << "  --loop n          maximum loop trip count (default 6)" << endl;
+}
+
+int main(int argc, char *argv[]) {
+    Option option = {1, 1, ".", 6, 8, 3, 6, 2, 8, 6};
+
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        if (i + 1 >= argc) {
+            PrintUsage();
+            return 2;
+        }
+        string value = argv[++i];
+        if (argument == "--seed") {
+            option.seed = atoll(value.c_str());
+        } else if (argument == "--count") {
+            option.count = max(1, atoi(value.c_str()));
+        } else if (argument == "--out") {
+            option.out_dir = value;
+        } else if (argument == "--functions") {
+            option.function_count = max(0, atoi(value.c_str()));
+        } else if (argument == "--statements") {
+            option.statement_count = max(1, atoi(value.c_str()));
+        } else if (argument == "--depth") {
+            option.depth = max(1, atoi(value.c_str()));
+        } else if (argument == "--expression") {
+            option.expression_size = max(1, atoi(value.c_str()));
+        } else if (argument == "--arrays") {
+            option.array_count = max(0, atoi(value.c_str()));
+        } else if (argument == "--recursion") {
+            option.recursion_depth = min(max(0, atoi(value.c_str())), 30);
+        } else if (argument == "--loop") {
+            option.loop_count = min(max(1, atoi(value.c_str())), 100);
+        } else {
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    mkdir(option.out_dir.c_str(), 0755);
+    for (int i = 0; i < option.count; i++) {
+        long long seed = option.seed + i;
+        ProgramGenerator generator = ProgramGenerator(option, seed);
+        string name = option.out_dir + "/testfile_" + to_string(seed);
+
+        ofstream program(name + ".txt");
+        program << generator.Generate();
+        ofstream input(name + ".in");
+        input << generator.input();
+        if (!program || !input) {
+            cerr << "mips_progen: cannot write " << name << ".txt" << endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file